@@ -0,0 +1,126 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "packer.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "packer.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/*
+	 * Samples are offset by adjust and truncated to 8 or 16 bits, exactly as
+	 * the scalar packers do, before they are interleaved.
+	 */
+
+	template<class D32, class D>
+	static HWY_INLINE VFromD<D> narrow(D32 d32, D d, const int32_t* src, Vec<D32> adj,
+									   Vec<D32> mask, bool swap)
+	{
+		auto v = And(Add(LoadU(d32, src), adj), mask);
+		if(swap)
+			v = Or(ShiftLeft<8>(And(v, Set(d32, 0xFF))), ShiftRight<8>(v));
+		return DemoteTo(d, v);
+	}
+	template<class D32, class D, typename T>
+	static HWY_INLINE uint32_t interleave(D32 d32, D d, const int32_t* const* src,
+										  uint32_t numPlanes, T* dest, uint32_t w,
+										  int32_t adjust, int32_t maxVal, bool swap)
+	{
+		const size_t N = Lanes(d32);
+		const auto adj = Set(d32, adjust);
+		const auto mask = Set(d32, maxVal);
+		uint32_t x = 0;
+		switch(numPlanes)
+		{
+			case 1:
+				for(; x + N <= w; x += (uint32_t)N)
+					StoreU(narrow(d32, d, src[0] + x, adj, mask, swap), d, dest + x);
+				break;
+			case 2:
+				for(; x + N <= w; x += (uint32_t)N)
+					StoreInterleaved2(narrow(d32, d, src[0] + x, adj, mask, swap),
+									  narrow(d32, d, src[1] + x, adj, mask, swap), d,
+									  dest + 2 * x);
+				break;
+			case 3:
+				for(; x + N <= w; x += (uint32_t)N)
+					StoreInterleaved3(narrow(d32, d, src[0] + x, adj, mask, swap),
+									  narrow(d32, d, src[1] + x, adj, mask, swap),
+									  narrow(d32, d, src[2] + x, adj, mask, swap), d,
+									  dest + 3 * x);
+				break;
+			case 4:
+				for(; x + N <= w; x += (uint32_t)N)
+					StoreInterleaved4(narrow(d32, d, src[0] + x, adj, mask, swap),
+									  narrow(d32, d, src[1] + x, adj, mask, swap),
+									  narrow(d32, d, src[2] + x, adj, mask, swap),
+									  narrow(d32, d, src[3] + x, adj, mask, swap), d,
+									  dest + 4 * x);
+				break;
+			default:
+				break;
+		}
+
+		return x;
+	}
+	uint32_t hwy_interleave_row8(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest,
+								 uint32_t w, int32_t adjust)
+	{
+		const HWY_FULL(int32_t) d32;
+		const Rebind<uint8_t, decltype(d32)> d8;
+
+		return interleave(d32, d8, src, numPlanes, dest, w, adjust, 0xFF, false);
+	}
+	uint32_t hwy_interleave_row16(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest,
+								  uint32_t w, int32_t adjust, bool bigEndian)
+	{
+		const HWY_FULL(int32_t) d32;
+		const Rebind<uint16_t, decltype(d32)> d16;
+
+		// the destination of 16 bit samples need not be 16 bit aligned
+		return interleave(d32, d16, src, numPlanes, (uint16_t*)dest, w, adjust, 0xFFFF,
+						  bigEndian);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_interleave_row8);
+HWY_EXPORT(hwy_interleave_row16);
+
+uint32_t interleaveRow8(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest, uint32_t w,
+						int32_t adjust)
+{
+	return HWY_DYNAMIC_DISPATCH(hwy_interleave_row8)(src, numPlanes, dest, w, adjust);
+}
+uint32_t interleaveRow16(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest, uint32_t w,
+						 int32_t adjust, bool bigEndian)
+{
+	return HWY_DYNAMIC_DISPATCH(hwy_interleave_row16)(src, numPlanes, dest, w, adjust, bigEndian);
+}
+} // namespace grk
+#endif
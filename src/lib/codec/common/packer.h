@@ -24,12 +24,33 @@
 #include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace grk {
 
 const uint32_t maxNumPackComponents = 10;
 const uint8_t packer16BitBE = 0xFF;
 
+/**
+ * Interleave the leading pixels of a row of 1 to 4 planes to 8 bit samples,
+ * with the widest SIMD instruction set available at run time
+ *
+ * @return number of pixels interleaved; the remaining pixels are left to the caller
+ */
+uint32_t interleaveRow8(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest, uint32_t w,
+						int32_t adjust);
+/**
+ * Interleave the leading pixels of a row of 1 to 4 planes to 16 bit samples,
+ * in native (little endian) or big endian byte order
+ *
+ * @return number of pixels interleaved; the remaining pixels are left to the caller
+ */
+uint32_t interleaveRow16(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest, uint32_t w,
+						 int32_t adjust, bool bigEndian);
+
 
 
 #define PUTBITS2(s, nb)   {                                         \
@@ -486,7 +507,14 @@ public:
 	{
 		for(size_t i = 0; i < h; i++) {
 			auto destPtr = dest;
-			for(size_t j = 0; j < srcWidth; j++)
+			size_t j = 0;
+			if constexpr(std::is_same<T, int32_t>::value) {
+				if (numPlanes <= 4) {
+					j = interleaveRow8(src, numPlanes, dest, srcWidth, adjust);
+					destPtr += j * numPlanes;
+				}
+			}
+			for(; j < srcWidth; j++)
 				for(size_t k = 0; k < numPlanes; ++k)
 					*destPtr++ = (uint8_t)(src[k][j] + adjust);
 			dest += destStride;
@@ -878,7 +906,14 @@ public:
 	{
 		for(size_t i = 0; i < h; i++) {
 			auto destPtr = dest;
-			for(size_t j = 0; j < srcWidth; j++)
+			size_t j = 0;
+			if constexpr(std::is_same<T, int32_t>::value) {
+				if (numPlanes <= 4) {
+					j = interleaveRow16(src, numPlanes, dest, srcWidth, adjust, false);
+					destPtr += j * numPlanes * 2;
+				}
+			}
+			for(; j < srcWidth; j++)
 				for(size_t k = 0; k < numPlanes; ++k) {
 					*(uint16_t*)destPtr = (uint16_t)(src[k][j] + adjust);
 					destPtr+=2;
@@ -903,7 +938,14 @@ public:
 	{
 		for(size_t i = 0; i < h; i++) {
 			auto destPtr = dest;
-			for(size_t j = 0; j < srcWidth; j++)
+			size_t j = 0;
+			if constexpr(std::is_same<T, int32_t>::value) {
+				if (numPlanes <= 4) {
+					j = interleaveRow16(src, numPlanes, dest, srcWidth, adjust, true);
+					destPtr += j * numPlanes * 2;
+				}
+			}
+			for(; j < srcWidth; j++)
 				for(size_t k = 0; k < numPlanes; ++k) {
 					uint32_t val = (uint32_t)(src[k][j] + adjust);
 					*(destPtr)++ = (uint8_t)(val >> 8);
@@ -960,4 +1002,45 @@ public:
 	}
 };
 
+/**
+ * Interleave rows in bands that are packed concurrently. Source plane pointers
+ * are advanced past the h rows, exactly as PlanarToInterleaved::interleave does.
+ *
+ * @param numThreads maximum number of threads; bands are at least minBandBytes
+ * of packed data, so that small strips are packed on the calling thread
+ */
+template <typename T> void interleaveStriped(PlanarToInterleaved<T>* iter,
+											T ** src,
+											const uint32_t numPlanes,
+											uint8_t* dest,
+											const uint32_t srcWidth,
+											const uint32_t srcStride,
+											const uint64_t destStride,
+											const uint32_t h,
+											const int32_t adjust,
+											uint32_t numThreads){
+	const uint64_t minBandBytes = 256 * 1024;
+	uint64_t numBands = std::min<uint64_t>(numThreads, destStride * h / minBandBytes);
+	if (numBands <= 1) {
+		iter->interleave(src, numPlanes, dest, srcWidth, srcStride, destStride, h, adjust);
+		return;
+	}
+	uint32_t rowsPerBand = (uint32_t)((h + numBands - 1) / numBands);
+	auto band = [=](uint32_t rowBegin, uint32_t rowEnd) {
+		T* planes[maxNumPackComponents];
+		for (uint32_t k = 0; k < numPlanes; ++k)
+			planes[k] = src[k] + (size_t)rowBegin * srcStride;
+		iter->interleave(planes, numPlanes, dest + rowBegin * destStride, srcWidth, srcStride,
+						 destStride, rowEnd - rowBegin, adjust);
+	};
+	std::vector<std::thread> threads;
+	for (uint32_t rowBegin = rowsPerBand; rowBegin < h; rowBegin += rowsPerBand)
+		threads.emplace_back(band, rowBegin, std::min(rowBegin + rowsPerBand, h));
+	band(0, std::min(rowsPerBand, h));
+	for (auto& t : threads)
+		t.join();
+	for (uint32_t k = 0; k < numPlanes; ++k)
+		src[k] += (size_t)h * srcStride;
+}
+
 }
@@ -79,6 +79,8 @@ class ImageFormat : public IImageFormat
 	FILE* fileStream_;
 	std::string fileName_;
 	uint32_t compressionLevel_;
+	// number of threads that may pack pixels
+	uint32_t concurrency_;
 
 	bool useStdIO_;
 	uint32_t encodeState;
@@ -212,9 +212,9 @@ bool PNMFormat::encodeRows([[maybe_unused]] uint32_t rows)
 		{
 			uint32_t stripRows = (std::min)(image_->rowsPerStrip, height - h);
 			packedBuf = pool.get(image_->packedRowBytes * stripRows);
-			iter->interleave((int32_t**)planes, decompressNumComps, packedBuf.data_,
-							 image_->decompressWidth, image_->comps[0].stride,
-							 image_->packedRowBytes, stripRows, adjust);
+			grk::interleaveStriped(iter, (int32_t**)planes, decompressNumComps, packedBuf.data_,
+								   image_->decompressWidth, image_->comps[0].stride,
+								   image_->packedRowBytes, stripRows, adjust, concurrency_);
 			packedBuf.pooled_ = true;
 			packedBuf.offset_ = serializer.getOffset();
 			packedBuf.len_ = image_->packedRowBytes * stripRows;
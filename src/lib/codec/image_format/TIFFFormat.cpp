@@ -551,8 +551,9 @@ bool TIFFFormat::encodePixels()
 		{
 			uint32_t stripRows = (std::min)(image_->rowsPerStrip, height - h);
 			packedBuf = pool.get(image_->packedRowBytes * stripRows);
-			iter->interleave((int32_t**)planes, numcomps, packedBuf.data_, image_->decompressWidth,
-							 image_->comps[0].stride, image_->packedRowBytes, stripRows, 0);
+			grk::interleaveStriped(iter, (int32_t**)planes, numcomps, packedBuf.data_,
+								   image_->decompressWidth, image_->comps[0].stride,
+								   image_->packedRowBytes, stripRows, 0, concurrency_);
 			packedBuf.pooled_ = true;
 			packedBuf.offset_ = serializer.getOffset();
 			packedBuf.len_ = image_->packedRowBytes * stripRows;
@@ -289,17 +289,29 @@ static void compress_help_display(void)
 	fprintf(stdout, "\n");
 	fprintf(stdout, "-F 512,512,3,8,u@1x1:2x2:2x2\n");
 	fprintf(stdout, "\n");
-	fprintf(stdout, " `-A, -rate_control_algorithm [0|1]`\n");
+	fprintf(stdout, " `-A, -rate_control_algorithm [0|1|2]`\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, "Select algorithm used for rate control.\n");
 	fprintf(stdout, "* 0: Bisection search for optimal threshold using all code passes in code\n");
 	fprintf(stdout, "blocks. Slightly higher PSNR than algorithm 1.\n");
 	fprintf(stdout, "* 1: Bisection search for optimal threshold using only feasible truncation\n");
 	fprintf(stdout, "points, on convex hull (default). Faster than algorithm 0.\n");
+	fprintf(stdout, "* 2: As algorithm 1, but with a single threshold shared by all tiles, so that\n");
+	fprintf(stdout, "bytes go to the tiles that need them most. Higher PSNR than algorithm 1 for\n");
+	fprintf(stdout, "tiled images, but all tiles are held in memory until T1 has completed.\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout, " `-B, -early_termination`\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout, "For compression ratios, predict the final rate-distortion slope threshold of\n");
+	fprintf(stdout, "each tile from a sample of its code blocks, and stop coding the other code\n");
+	fprintf(stdout, "blocks once their bit planes fall well below it. Faster for high compression\n");
+	fprintf(stdout, "ratios. A tile is coded again in full if the prediction proves too\n");
+	fprintf(stdout, "aggressive. Ignored for HTJ2K, quality layers and rate control algorithm 2.\n");
+	fprintf(stdout, "Default: off\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, " `-r, -compression_ratios [<compression ratio>,<compression ratio>,...]`\n");
 	fprintf(stdout, "\n");
-	fprintf(stdout, "Note: not supported for Part 15 (HTJ2K) compression\n");
+	fprintf(stdout, "Note: Part 15 (HTJ2K) compression only supports a single quality layer\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout,
 			"Compression ratio values (double precision, greater than or equal to one). Each\n");
@@ -314,7 +326,7 @@ static void compress_help_display(void)
 	fprintf(stdout, "\n");
 	fprintf(stdout, " `-q, -quality [quality in dB,quality in dB,...]`\n");
 	fprintf(stdout, "\n");
-	fprintf(stdout, "Note: not supported for Part 15 (HTJ2K) compression\n");
+	fprintf(stdout, "Note: Part 15 (HTJ2K) compression only supports a single quality layer\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout,
 			"Quality values (double precision, greater than or equal to zero). Each value is\n");
@@ -1022,6 +1034,8 @@ GrkRC GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* i
 		TCLAP::ValueArg<uint32_t> rateControlAlgoArg("A", "rate_control_algorithm",
 													 "Rate control algorithm", false, 0,
 													 "unsigned integer", cmd);
+		TCLAP::SwitchArg earlyTerminationArg("B", "early_termination",
+											 "Predictive early termination of code passes", cmd);
 		TCLAP::ValueArg<std::string> codeBlockDimArg(
 			"b", "code_block_dims", "Code block dimensions", false, "", "string", cmd);
 		TCLAP::ValueArg<std::string> precinctDimArg("c", "precinct_dims", "Precinct dimensions",
@@ -1156,12 +1170,14 @@ GrkRC GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* i
 		if(rateControlAlgoArg.isSet())
 		{
 			uint32_t algo = rateControlAlgoArg.getValue();
-			if(algo > GRK_RATE_CONTROL_PCRD_OPT)
+			if(algo > GRK_RATE_CONTROL_PCRD_OPT_GLOBAL)
 				spdlog::warn("Rate control algorithm %u is not valid. Using default");
 			else
 				parameters->rateControlAlgorithm =
 					(GRK_RATE_CONTROL_ALGORITHM)rateControlAlgoArg.getValue();
 		}
+		if(earlyTerminationArg.isSet())
+			parameters->earlyTermination = true;
 		if(numThreadsArg.isSet())
 			parameters->numThreads = numThreadsArg.getValue();
 		if(deviceIdArg.isSet())
@@ -1744,20 +1760,15 @@ GrkRC GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* i
 				{
 					isHT = true;
 					parameters->numgbits = 1;
-					if(compressionRatiosArg.isSet() || qualityArg.isSet())
-					{
-						spdlog::warn("HTJ2K compression using rate distortion or quality"
-									 " is not currently supported.");
-					}
 				}
 			}
 		}
-		if(!isHT && compressionRatiosArg.isSet() && qualityArg.isSet())
+		if(compressionRatiosArg.isSet() && qualityArg.isSet())
 		{
 			spdlog::error("compression by both rate distortion and quality is not allowed");
 			return GrkRCFail;
 		}
-		if(!isHT && compressionRatiosArg.isSet())
+		if(compressionRatiosArg.isSet())
 		{
 			char* s = (char*)compressionRatiosArg.getValue().c_str();
 			parameters->numlayers = 0;
@@ -1798,7 +1809,7 @@ GrkRC GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* i
 					parameters->layer_rate[i] = 0;
 			}
 		}
-		else if(!isHT && qualityArg.isSet())
+		else if(qualityArg.isSet())
 		{
 			char* s = (char*)qualityArg.getValue().c_str();
 			;
@@ -388,6 +388,12 @@ static void decompress_help_display(void)
 			"Number of threads used for T1 compression. Default is total number of logical\n");
 	fprintf(stdout, "cores.\n");
 	fprintf(stdout, "\n");
+	fprintf(stdout, " `-R, -reference_t1`\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout,
+			"Decompress Part 1 code blocks with the reference MQ decoder, rather than the\n");
+	fprintf(stdout, "default table-driven decoder. Output is identical; useful for benchmarking.\n");
+	fprintf(stdout, "\n");
 	fprintf(stdout, "  `-e, -repetitions [number of repetitions]`\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout,
@@ -657,6 +663,7 @@ GrkRC GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParam
 												  "string", cmd);
 		TCLAP::ValueArg<uint32_t> reduceArg("r", "reduce", "reduce resolutions", false, 0,
 											"unsigned integer", cmd);
+		TCLAP::SwitchArg referenceT1Arg("R", "reference_t1", "Reference Part 1 decoder", cmd);
 		TCLAP::SwitchArg splitPnmArg("s", "split_pnm", "Split PNM", cmd);
 		TCLAP::ValueArg<uint32_t> tileArg("t", "tile_info", "Input tile index", false, 0,
 										  "unsigned integer", cmd);
@@ -874,6 +881,8 @@ GrkRC GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParam
 			parameters->core.layers_to_decompress_ = layerArg.getValue();
 		if(randomAccessArg.isSet())
 			parameters->core.randomAccessFlags_ = randomAccessArg.getValue();
+		if(referenceT1Arg.isSet())
+			parameters->core.t1Decoder = GRK_T1_DECODER_REFERENCE;
 		parameters->singleTileDecompress = tileArg.isSet();
 		if(tileArg.isSet())
 			parameters->tileIndex = (uint16_t)tileArg.getValue();
@@ -212,8 +212,11 @@ bool CodeStreamInfo::seekFirstTilePart(uint16_t tileIndex)
 	if(!hasVeryFirstTilePartInfo)
 		return true;
 
+	// tile has not been parsed yet, so its tile parts will be found by
+	// parsing forward from the current position
 	auto tileInfoForTile = getTileInfo(tileIndex);
-	assert(tileInfoForTile && tileInfoForTile->numTileParts);
+	if(!tileInfoForTile || !tileInfoForTile->hasTilePartInfo() || !tileInfoForTile->numTileParts)
+		return true;
 	// move just past SOT marker of first tile part for this tile
 	if(!(stream->seek(tileInfoForTile->getTilePartInfo(0)->startPosition + MARKER_BYTES)))
 	{
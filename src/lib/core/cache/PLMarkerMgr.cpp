@@ -95,38 +95,34 @@ bool PLMarkerMgr::pushPL(uint32_t len)
 		newMarkerId = currMarkerIter_->first & 0xFF;
 		buf = marker->back();
 	}
+	// simulations also fill marker buffers, as they need
+	// to know when a marker is full
 	if(newMarker)
 	{
-		if(isFinal_)
-		{
-			buf = addNewMarker(nullptr, plWriteBufferLen);
-			buf->write(newMarkerId);
-		}
+		buf = addNewMarker(nullptr, plWriteBufferLen);
+		buf->write(newMarkerId);
 		// account for marker header
 		totalBytesWritten_ += 2 + 2 + 1;
 	}
 	assert(buf);
-	if(isFinal_)
+	// write period
+	// static int count = 0;
+	// Logger::logger_.info("Wrote PLT packet %u, length %u", count++,len);
+	uint8_t temp[5];
+	int32_t counter = (int32_t)(numBytes - 1);
+	temp[counter--] = (len & 0x7F);
+	len = (uint32_t)(len >> 7);
+
+	// write commas (backwards from LSB to MSB)
+	while(len)
 	{
-		// write period
-		// static int count = 0;
-		// Logger::logger_.info("Wrote PLT packet %u, length %u", count++,len);
-		uint8_t temp[5];
-		int32_t counter = (int32_t)(numBytes - 1);
-		temp[counter--] = (len & 0x7F);
+		uint8_t b = (uint8_t)((len & 0x7F) | 0x80);
+		temp[counter--] = b;
 		len = (uint32_t)(len >> 7);
-
-		// write commas (backwards from LSB to MSB)
-		while(len)
-		{
-			uint8_t b = (uint8_t)((len & 0x7F) | 0x80);
-			temp[counter--] = b;
-			len = (uint32_t)(len >> 7);
-		}
-		assert(counter == -1);
-		if(!buf->write(temp, numBytes))
-			return false;
 	}
+	assert(counter == -1);
+	if(!buf->write(temp, numBytes))
+		return false;
 	totalBytesWritten_ += numBytes;
 
 	return true;
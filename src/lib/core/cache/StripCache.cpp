@@ -1,4 +1,5 @@
 #include "grk_includes.h"
+#include "ICCTransformCache.h"
 
 const bool grokNewIO = false;
 
@@ -98,6 +99,8 @@ void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrip
 	imageY0_ = outputImage->y0;
 	nominalStripHeight_ = nominalStripHeight;
 	packedRowBytes_ = outputImage->packedRowBytes;
+	// the profile is detached before strip images copy the output image header
+	iccTransform_ = outputImage->detachICCTransform();
 	strips = new Strip*[numStrips];
 	for(uint16_t i = 0; i < numStrips_; ++i)
 		strips[i] = new Strip(outputImage, i, nominalStripHeight_, reduce);
@@ -119,6 +122,15 @@ bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint
 	uint64_t dataOffset = packedRowBytes_ * yBegin;
 	if(!strip->allocInterleaved(dataLen, pools_[threadId]))
 		return false;
+	if(iccTransform_)
+	{
+		int32_t* planes[grk::maxNumPackComponents];
+		for(uint16_t i = 0; i < src->numcomps_; ++i)
+			planes[i] = (src->comps + i)->getWindow()->getResWindowBufferHighestSimple().buf_;
+		applyICC(planes, src->numcomps_,
+				 src->comps->getWindow()->getResWindowBufferHighestStride(), src->comps->width(),
+				 yBegin, yEnd);
+	}
 	if(!dest->compositeInterleaved(src, yBegin, yEnd))
 		return false;
 
@@ -150,6 +162,13 @@ bool StripCache::ingestTile(uint32_t threadId, GrkImage* src)
 	uint64_t offset = packedRowBytes_ * dest->comps->y0;
 	if(!strip->allocInterleavedLocked(dataLen, pools_[threadId]))
 		return false;
+	if(iccTransform_)
+	{
+		int32_t* planes[grk::maxNumPackComponents];
+		for(uint16_t i = 0; i < src->numcomps; ++i)
+			planes[i] = (src->comps + i)->data;
+		applyICC(planes, src->numcomps, src->comps->stride, src->comps->w, 0, src->comps->h);
+	}
 	if(!dest->compositeInterleaved(src))
 		return false;
 
@@ -169,6 +188,15 @@ bool StripCache::ingestTile(uint32_t threadId, GrkImage* src)
 	return true;
 }
 
+void StripCache::applyICC(int32_t* const* planes, uint16_t numcomps, uint32_t stride, uint32_t w,
+						  uint32_t yBegin, uint32_t yEnd)
+{
+	// colour channels are transformed in place; any opacity channel is left as is
+	auto numColourChannels = iccTransform_->numInputChannels();
+	if(numcomps < numColourChannels)
+		return;
+	iccTransform_->transformRows(planes, (uint16_t)numColourChannels, stride, w, yBegin, yEnd);
+}
 bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 {
 	if(grokNewIO)
@@ -179,6 +207,12 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 		std::unique_lock<std::mutex> lk(heapMutex_);
 		// 1. push to heap
 		serializeHeap.push(buf);
+	}
+	// sequential buffers are popped while holding the serialize lock, so that
+	// buffers popped by different threads are serialized in order
+	std::unique_lock<std::mutex> serializeLock(serializeMutex_);
+	{
+		std::unique_lock<std::mutex> lk(heapMutex_);
 		// 2. get all sequential buffers in heap
 		while(serializeHeap.pop(buf))
 			buffersToSerialize.push(buf);
@@ -186,15 +220,12 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 	// 3. serialize buffers
 	if(!buffersToSerialize.empty())
 	{
+		while(!buffersToSerialize.empty())
 		{
-			std::unique_lock<std::mutex> lk(serializeMutex_);
-			while(!buffersToSerialize.empty())
-			{
-				auto b = buffersToSerialize.front();
-				if(!ioBufferCallback_(threadId, b, ioUserData_))
-					break;
-				buffersToSerialize.pop();
-			}
+			auto b = buffersToSerialize.front();
+			if(!ioBufferCallback_(threadId, b, ioUserData_))
+				break;
+			buffersToSerialize.pop();
 		}
 		// if non empty, then there has been a serialize failure
 		if(!buffersToSerialize.empty())
@@ -3,11 +3,13 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <memory>
 #include "grok.h"
 #include "MinHeap.h"
 
 namespace grk
 {
+class ICCTransform;
 
 struct GrkIOBuf : public grk_io_buf
 {
@@ -125,6 +127,8 @@ class StripCache
 
   private:
 	bool serialize(uint32_t threadId, GrkIOBuf buf);
+	void applyICC(int32_t* const* planes, uint16_t numcomps, uint32_t stride, uint32_t w,
+				  uint32_t yBegin, uint32_t yEnd);
 	std::vector<BufPool*> pools_;
 	Strip** strips;
 	uint16_t numTiles_;
@@ -139,6 +143,8 @@ class StripCache
 	mutable std::mutex heapMutex_;
 	bool initialized_;
 	bool multiTile_;
+	// ICC transform applied to pixels before they are interleaved
+	std::shared_ptr<ICCTransform> iccTransform_;
 };
 
 } // namespace grk
@@ -0,0 +1,96 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <grk_includes.h>
+
+namespace grk
+{
+StripSource::StripSource(GrkImage* headerImage, CodingParams* cp,
+						 grk_io_pull_callback pullCallback, void* pullUserData)
+	: headerImage_(headerImage), cp_(cp), pullCallback_(pullCallback), pullUserData_(pullUserData)
+{}
+StripSource::~StripSource()
+{
+	for(auto& s : strips_)
+		grk_object_unref(&s.second.stripImg->obj);
+}
+GrkImage* StripSource::acquire(uint16_t tileIndex)
+{
+	uint16_t tileRow = (uint16_t)(tileIndex / cp_->t_grid_width);
+	{
+		std::unique_lock<std::mutex> lk(stripMutex_);
+		auto iter = strips_.find(tileRow);
+		if(iter != strips_.end())
+			return iter->second.stripImg;
+	}
+	// client is called without holding the lock, so that workers
+	// can continue to release strips for earlier tile rows
+	auto stripImg = pull(tileRow);
+	if(!stripImg)
+		return nullptr;
+	std::unique_lock<std::mutex> lk(stripMutex_);
+	strips_[tileRow] = {stripImg, cp_->t_grid_width};
+
+	return stripImg;
+}
+void StripSource::release(uint16_t tileIndex)
+{
+	uint16_t tileRow = (uint16_t)(tileIndex / cp_->t_grid_width);
+	GrkImage* stripImg = nullptr;
+	{
+		std::unique_lock<std::mutex> lk(stripMutex_);
+		auto iter = strips_.find(tileRow);
+		if(iter == strips_.end())
+			return;
+		if(--iter->second.tilesRemaining == 0)
+		{
+			stripImg = iter->second.stripImg;
+			strips_.erase(iter);
+		}
+	}
+	if(stripImg)
+		grk_object_unref(&stripImg->obj);
+}
+GrkImage* StripSource::pull(uint16_t tileRow)
+{
+	auto stripImg = new GrkImage();
+	headerImage_->copyHeader(stripImg);
+	uint64_t tileY0 = (uint64_t)cp_->ty0 + (uint64_t)tileRow * cp_->t_height;
+	stripImg->y0 = (uint32_t)std::max<uint64_t>(tileY0, headerImage_->y0);
+	stripImg->y1 = (uint32_t)std::min<uint64_t>(tileY0 + cp_->t_height, headerImage_->y1);
+	for(uint16_t compno = 0; compno < stripImg->numcomps; ++compno)
+	{
+		auto comp = stripImg->comps + compno;
+		comp->y0 = ceildiv<uint32_t>(stripImg->y0, comp->dy);
+		comp->h = ceildiv<uint32_t>(stripImg->y1, comp->dy) - comp->y0;
+		if(!GrkImage::allocData(comp))
+		{
+			grk_object_unref(&stripImg->obj);
+			return nullptr;
+		}
+	}
+	if(!pullCallback_(stripImg, pullUserData_))
+	{
+		Logger::logger_.error("Failed to pull image rows [%u,%u) from client", stripImg->y0,
+							  stripImg->y1);
+		grk_object_unref(&stripImg->obj);
+		return nullptr;
+	}
+
+	return stripImg;
+}
+
+} // namespace grk
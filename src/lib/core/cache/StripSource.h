@@ -0,0 +1,73 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include "grok.h"
+
+namespace grk
+{
+
+/**
+ * Source of uncompressed image data for strip-based compression.
+ *
+ * Image data is pulled from the client one tile row at a time, as the first tile
+ * of each tile row is scheduled, and is released as soon as every tile in that row
+ * has been ingested. Peak source memory is therefore proportional to the number of
+ * tile rows in flight, rather than to the size of the image.
+ */
+class StripSource
+{
+  public:
+	StripSource(GrkImage* headerImage, CodingParams* cp, grk_io_pull_callback pullCallback,
+				void* pullUserData);
+	~StripSource();
+
+	/**
+	 * Get strip for tile row containing tile, pulling it from the client if it is
+	 * not already resident. Must be called in tile order, from a single thread.
+	 *
+	 * @param tileIndex tile index
+	 * @return strip image, or nullptr on failure
+	 */
+	GrkImage* acquire(uint16_t tileIndex);
+
+	/**
+	 * Signal that a tile has been ingested. The strip for the tile's row is freed
+	 * once all of the tiles in that row have been ingested.
+	 *
+	 * @param tileIndex tile index
+	 */
+	void release(uint16_t tileIndex);
+
+  private:
+	struct PulledStrip
+	{
+		GrkImage* stripImg;
+		uint16_t tilesRemaining; // tiles in row that have not yet been ingested
+	};
+	GrkImage* pull(uint16_t tileRow);
+	GrkImage* headerImage_;
+	CodingParams* cp_;
+	grk_io_pull_callback pullCallback_;
+	void* pullUserData_;
+	std::map<uint16_t, PulledStrip> strips_;
+	std::mutex stripMutex_;
+};
+
+} // namespace grk
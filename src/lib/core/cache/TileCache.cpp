@@ -18,13 +18,15 @@
 
 namespace grk
 {
-TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p) {}
+TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p), bytes(0), resident(false) {}
 TileCacheEntry::TileCacheEntry() : TileCacheEntry(nullptr) {}
 TileCacheEntry::~TileCacheEntry()
 {
 	delete processor;
 }
-TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy) : tileComposite(nullptr), strategy_(strategy)
+TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy)
+	: tileComposite(nullptr), strategy_(strategy), budget_(0), bytes_(0), hits_(0), misses_(0),
+	  evictions_(0)
 {
 	tileComposite = new GrkImage();
 }
@@ -38,10 +40,12 @@ TileCache::~TileCache()
 }
 bool TileCache::empty()
 {
+	std::unique_lock<std::mutex> lk(cacheMutex_);
 	return cache_.empty();
 }
 TileCacheEntry* TileCache::put(uint16_t tileIndex, TileProcessor* processor)
 {
+	std::unique_lock<std::mutex> lk(cacheMutex_);
 	TileCacheEntry* entry = nullptr;
 	if(cache_.find(tileIndex) != cache_.end())
 	{
@@ -58,11 +62,120 @@ TileCacheEntry* TileCache::put(uint16_t tileIndex, TileProcessor* processor)
 }
 TileCacheEntry* TileCache::get(uint16_t tileIndex)
 {
+	std::unique_lock<std::mutex> lk(cacheMutex_);
 	if(cache_.find(tileIndex) != cache_.end())
 		return cache_[tileIndex];
 
 	return nullptr;
 }
+bool TileCache::lookup(uint16_t tileIndex)
+{
+	std::unique_lock<std::mutex> lk(cacheMutex_);
+	auto iter = cache_.find(tileIndex);
+	if(iter == cache_.end() || !iter->second->processor || !iter->second->processor->getImage())
+	{
+		misses_++;
+		return false;
+	}
+	auto entry = iter->second;
+	if(entry->resident)
+		lru_.splice(lru_.begin(), lru_, entry->lruPosition);
+	hits_++;
+
+	return true;
+}
+void TileCache::cache(uint16_t tileIndex)
+{
+	std::unique_lock<std::mutex> lk(cacheMutex_);
+	auto iter = cache_.find(tileIndex);
+	if(iter == cache_.end() || !iter->second->processor)
+		return;
+	auto processor = iter->second->processor;
+	if(!processor->getImage() && !processor->hasRetainedPackets())
+		return;
+	auto entry = iter->second;
+	if(entry->resident)
+	{
+		bytes_ -= entry->bytes;
+		lru_.splice(lru_.begin(), lru_, entry->lruPosition);
+	}
+	else
+	{
+		lru_.push_front(tileIndex);
+		entry->lruPosition = lru_.begin();
+		entry->resident = true;
+	}
+	entry->bytes = footprint(entry->processor);
+	bytes_ += entry->bytes;
+	if(strategy_ != GRK_TILE_CACHE_LRU || !budget_)
+		return;
+	// most recently cached tile is never evicted
+	while(bytes_ > budget_ && lru_.size() > 1)
+	{
+		evict(lru_.back());
+		evictions_++;
+	}
+}
+void TileCache::trim(void)
+{
+	std::unique_lock<std::mutex> lk(cacheMutex_);
+	if(!budget_)
+		return;
+	// most recently cached tile is never evicted
+	while(bytes_ > budget_ && lru_.size() > 1)
+	{
+		evict(lru_.back());
+		evictions_++;
+	}
+}
+void TileCache::evictAll(void)
+{
+	std::unique_lock<std::mutex> lk(cacheMutex_);
+	while(!lru_.empty())
+		evict(lru_.back());
+}
+void TileCache::evict(uint16_t tileIndex)
+{
+	auto iter = cache_.find(tileIndex);
+	assert(iter != cache_.end());
+	auto entry = iter->second;
+	bytes_ -= entry->bytes;
+	lru_.erase(entry->lruPosition);
+	// compressed tile data will be re-read from the code stream
+	// if this tile is requested again
+	auto tcp = entry->processor->getTileCodingParams();
+	delete tcp->compressedTileData_;
+	tcp->compressedTileData_ = nullptr;
+	delete entry;
+	cache_.erase(iter);
+}
+uint64_t TileCache::footprint(TileProcessor* processor)
+{
+	uint64_t rc = 0;
+	auto image = processor->getImage();
+	for(uint16_t compno = 0; image && compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		if(comp->data)
+			rc += (uint64_t)comp->stride * comp->h * sizeof(int32_t);
+	}
+	auto tcp = processor->getTileCodingParams();
+	if(tcp->compressedTileData_)
+		rc += tcp->compressedTileData_->totalLength();
+	rc += processor->getRetainedBlockBytes();
+
+	return rc;
+}
+void TileCache::getStats(grk_tile_cache_stats* stats)
+{
+	std::unique_lock<std::mutex> lk(cacheMutex_);
+	stats->hits = hits_;
+	stats->misses = misses_;
+	stats->evictions = evictions_;
+	stats->numTiles = (uint32_t)lru_.size();
+	stats->bytes = bytes_;
+	stats->budget = budget_;
+}
 void TileCache::setStrategy(GRK_TILE_CACHE_STRATEGY strategy)
 {
 	strategy_ = strategy;
@@ -71,6 +184,10 @@ GRK_TILE_CACHE_STRATEGY TileCache::getStrategy(void)
 {
 	return strategy_;
 }
+void TileCache::setBudget(uint64_t budget)
+{
+	budget_ = budget;
+}
 GrkImage* TileCache::getComposite()
 {
 	return tileComposite;
@@ -84,6 +201,7 @@ std::vector<GrkImage*> TileCache::getAllImages(void)
 }
 std::vector<GrkImage*> TileCache::getTileImages(void)
 {
+	std::unique_lock<std::mutex> lk(cacheMutex_);
 	std::vector<GrkImage*> rc;
 	for(const auto& entry : cache_)
 	{
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <map>
+#include <list>
+#include <mutex>
 
 namespace grk
 {
@@ -32,6 +34,11 @@ struct TileCacheEntry
 	~TileCacheEntry();
 
 	TileProcessor* processor;
+	// memory held by this entry, once its image has been cached
+	uint64_t bytes;
+	// true if entry's image has been cached, and entry is in the LRU list
+	bool resident;
+	std::list<uint16_t>::iterator lruPosition;
 };
 
 class TileCache
@@ -44,17 +51,54 @@ class TileCache
 	bool empty(void);
 	void setStrategy(GRK_TILE_CACHE_STRATEGY strategy);
 	GRK_TILE_CACHE_STRATEGY getStrategy(void);
+	void setBudget(uint64_t budget);
 	TileCacheEntry* put(uint16_t tileIndex, TileProcessor* processor);
 	TileCacheEntry* get(uint16_t tileIndex);
+	/**
+	 * Look up cached image for tile, updating hit/miss statistics and,
+	 * on a hit, marking tile as most recently used
+	 *
+	 * @param tileIndex tile index
+	 * @return true if tile image is cached
+	 */
+	bool lookup(uint16_t tileIndex);
+	/**
+	 * Account for a newly cached tile image. For GRK_TILE_CACHE_LRU strategy,
+	 * least recently used tiles are then evicted until the cache fits in its budget.
+	 *
+	 * @param tileIndex tile index
+	 */
+	void cache(uint16_t tileIndex);
+	/**
+	 * Evict least recently used tiles until the cache fits in its budget.
+	 * Must only be called while no tile is being decompressed.
+	 */
+	void trim(void);
+	/**
+	 * Evict all cached tiles.
+	 * Must only be called while no tile is being decompressed.
+	 */
+	void evictAll(void);
+	void getStats(grk_tile_cache_stats* stats);
 	GrkImage* getComposite(void);
 	std::vector<GrkImage*> getAllImages(void);
 	std::vector<GrkImage*> getTileImages(void);
 
   private:
+	void evict(uint16_t tileIndex);
+	static uint64_t footprint(TileProcessor* processor);
 	// each component is sub-sampled and resolution-reduced
 	GrkImage* tileComposite;
 	std::map<uint32_t, TileCacheEntry*> cache_;
 	GRK_TILE_CACHE_STRATEGY strategy_;
+	// cached tiles, most recently used first
+	std::list<uint16_t> lru_;
+	uint64_t budget_;
+	uint64_t bytes_;
+	uint64_t hits_;
+	uint64_t misses_;
+	uint64_t evictions_;
+	std::mutex cacheMutex_;
 };
 
 } // namespace grk
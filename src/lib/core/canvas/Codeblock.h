@@ -44,12 +44,17 @@ struct Segment
 // compressing/decoding pass
 struct CodePass
 {
-	CodePass() : rate(0), distortiondec(0), len(0), term(0), slope(0) {}
+	CodePass() : rate(0), distortiondec(0), len(0), term(0), slope(0), offset(0), numbps(0) {}
 	uint32_t rate;
 	double distortiondec;
 	uint32_t len;
 	uint8_t term;
 	uint16_t slope; // ln(slope) in 8.8 fixed point
+	// HT : each pass is an alternative cleanup pass, rather than a refinement
+	// of the previous pass. Its rate bytes are stored at this offset in the
+	// compressed stream, and are signalled with numbps code block bit planes
+	uint32_t offset;
+	uint8_t numbps;
 };
 // quality layer
 struct Layer
@@ -150,6 +155,8 @@ struct CompressCodeblock : public Codeblock
 	bool allocData(size_t nominalBlockSize)
 	{
 		uint32_t desired_data_size = (uint32_t)(nominalBlockSize * sizeof(uint32_t));
+		// block may be compressed again
+		compressedStream.dealloc();
 		// we add two fake zero bytes at beginning of buffer, so that mq coder
 		// can be initialized to data[-1] == actualData[1], and still point
 		// to a valid memory location
@@ -247,6 +254,15 @@ struct DecompressCodeblock : public Codeblock
 		}
 		return true;
 	}
+	/**
+	 * Release uncompressed data, keeping compressed segments
+	 * so that code block can be decompressed again
+	 */
+	void releaseUncompressedData(void)
+	{
+		grk_buf2d::dealloc();
+		setCacheState(GRK_CACHE_STATE_CLOSED);
+	}
 	void release(void)
 	{
 		cleanUpSegBuffers();
@@ -122,7 +122,7 @@ struct ResWindow
 				genSplitWindowBuffers(resWindowBufferSplit_, resWindowBuffer_,
 									  bandWindowsBuffersPadded_[BAND_ORIENT_LL],
 									  bandWindowsBuffersPadded_[BAND_ORIENT_LH], true);
-				genSplitWindowBuffers(resWindowBufferSplitREL_, resWindowBuffer_,
+				genSplitWindowBuffers(resWindowBufferSplitREL_, resWindowBufferREL_,
 									  bandWindowsBuffersPadded_[BAND_ORIENT_LL],
 									  bandWindowsBuffersPadded_[BAND_ORIENT_LH], false);
 			}
@@ -29,7 +29,7 @@ namespace grk
 {
 TileComponent::TileComponent()
 	: resolutions_(nullptr), numresolutions(0), numResolutionsToDecompress(0),
-	  highestResolutionDecompressed(0),
+	  highestResolutionDecompressed(0), highestResolutionParsed(0),
 #ifdef DEBUG_LOSSLESS_T2
 	  round_trip_resolutions(nullptr),
 #endif
@@ -185,6 +185,20 @@ bool TileComponent::init(TileProcessor* tileProcessor, grk_rect32 unreducedTileC
 
 	return true;
 }
+/**
+ * Update number of resolutions to decompress, and tile component bounds,
+ * for current resolution reduction and decompress window, so that tile component
+ * with retained packets can be decompressed again
+ */
+void TileComponent::updateDecompressResolutions(const CodingParams* cp)
+{
+	wholeTileDecompress = cp->wholeTileDecompress_;
+	numResolutionsToDecompress = numresolutions < cp->coding_params_.dec_.reduce_
+									 ? 1
+									 : (uint8_t)(numresolutions - cp->coding_params_.dec_.reduce_);
+	setRect(resolutions_ + numResolutionsToDecompress - 1);
+	dealloc();
+}
 bool TileComponent::subbandIntersectsAOI(uint8_t resno, eBandOrientation orient,
 										 const grk_rect32* aoi) const
 {
@@ -394,17 +408,30 @@ void TileComponent::postDecompressImpl(int32_t* srcData, DecompressBlockExec* bl
 {
 	auto cblk = block->cblk;
 	bool empty = cblk->seg_buffers.empty();
-
 	window_->toRelativeCoordinates(block->resno, block->bandOrientation, block->x, block->y);
 	auto src =
 		grk_buf2d<int32_t, AllocatorAligned>(srcData, false, cblk->width(), stride, cblk->height());
 	auto blockBounds =
 		grk_rect32(block->x, block->y, block->x + cblk->width(), block->y + cblk->height());
+	// region window filters in place, unless the decompressed data is retained,
+	// in which case the filter writes to a copy, in the same pass over the samples
+	std::unique_ptr<int32_t[]> retained;
 	if(!empty)
 	{
 		if(regionWindow_)
 		{
-			src.copyFrom<F>(src, F(block));
+			if(block->retainDecompressed)
+			{
+				retained.reset(new int32_t[(size_t)stride * cblk->height()]);
+				srcData = retained.get();
+				auto dest = grk_buf2d<int32_t, AllocatorAligned>(srcData, false, cblk->width(),
+																  stride, cblk->height());
+				dest.copyFrom<F>(src, F(block));
+			}
+			else
+			{
+				src.copyFrom<F>(src, F(block));
+			}
 		}
 		else
 		{
@@ -34,6 +34,7 @@ struct TileComponent : public grk_rect32
 	void dealloc(void);
 	bool init(TileProcessor* tileProcessor, grk_rect32 unreducedTileComp, uint8_t prec,
 			  TileComponentCodingParams* tccp);
+	void updateDecompressResolutions(const CodingParams* cp);
 	bool subbandIntersectsAOI(uint8_t resno, eBandOrientation orient, const grk_rect32* aoi) const;
 
 	TileComponentWindow<int32_t>* getWindow() const;
@@ -46,6 +47,7 @@ struct TileComponent : public grk_rect32
 	uint8_t numresolutions;
 	uint8_t numResolutionsToDecompress; // desired number of resolutions to decompress
 	std::atomic<uint8_t> highestResolutionDecompressed; // highest resolution actually decompressed
+	uint8_t highestResolutionParsed; // highest resolution with retained packets
 #ifdef DEBUG_LOSSLESS_T2
 	Resolution* round_trip_resolutions; /* round trip resolution information */
 #endif
@@ -24,18 +24,23 @@ namespace grk
 {
 CodeStream::CodeStream(BufferedStream* stream)
 	: codeStreamInfo(nullptr), headerImage_(nullptr), currentTileProcessor_(nullptr),
-	  stream_(stream), current_plugin_tile(nullptr)
+	  stream_(stream), current_plugin_tile(nullptr), t1Pool_(new T1Pool())
 {}
 CodeStream::~CodeStream()
 {
 	if(headerImage_)
 		grk_object_unref(&headerImage_->obj);
 	delete codeStreamInfo;
+	delete t1Pool_;
 }
 CodingParams* CodeStream::getCodingParams(void)
 {
 	return &cp_;
 }
+T1Pool* CodeStream::getT1Pool(void)
+{
+	return t1Pool_;
+}
 GrkImage* CodeStream::getHeaderImage(void)
 {
 	return headerImage_;
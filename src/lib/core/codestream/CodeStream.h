@@ -120,14 +120,20 @@ struct ICodeStreamDecompress
 	virtual GrkImage* getImage(void) = 0;
 	virtual void init(grk_decompress_core_params* p_param) = 0;
 	virtual bool setDecompressRegion(grk_rect_single region) = 0;
+	virtual bool setDecompressRegion(uint8_t reduce, grk_rect32 region) = 0;
+	virtual bool setReduce(uint8_t reduce) = 0;
 	virtual bool decompress(grk_plugin_tile* tile) = 0;
+	virtual bool decompressWindows(const grk_decompress_window* windows, uint32_t numWindows,
+								   grk_decompress_window_callback callback, void* userData) = 0;
 	virtual bool decompressTile(uint16_t tileIndex) = 0;
 	virtual bool preProcess(void) = 0;
 	virtual bool postProcess(void) = 0;
 	virtual void dump(uint32_t flag, FILE* outputFileStream) = 0;
+	virtual void getTileCacheStats(grk_tile_cache_stats* stats) = 0;
 };
 
 class TileCache;
+class T1Pool;
 
 class CodeStream
 {
@@ -140,6 +146,7 @@ class CodeStream
 	GrkImage* getHeaderImage(void);
 	grk_plugin_tile* getCurrentPluginTile();
 	CodingParams* getCodingParams(void);
+	T1Pool* getT1Pool(void);
 	static std::string markerString(uint16_t marker);
 
   protected:
@@ -155,6 +162,7 @@ class CodeStream
 	BufferedStream* stream_;
 	std::map<uint32_t, TileProcessor*> processors_;
 	grk_plugin_tile* current_plugin_tile;
+	T1Pool* t1Pool_;
 };
 
 /** @name Exported functions */
@@ -171,11 +171,16 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 
 	if(isHT)
 	{
-		if(parameters->numlayers > 1 || parameters->layer_rate[0] != 0)
+		// rate control chooses one cleanup pass for each code block,
+		// so only the final layer can be honoured
+		if(parameters->numlayers > 1)
 		{
-			Logger::logger_.warn("Rate control not supported for HTJ2K compression.");
+			Logger::logger_.warn("Multiple quality layers not supported for HTJ2K compression.");
+			Logger::logger_.warn("Only the final layer will be compressed.");
+			parameters->layer_rate[0] = parameters->layer_rate[parameters->numlayers - 1];
+			parameters->layer_distortion[0] =
+				parameters->layer_distortion[parameters->numlayers - 1];
 			parameters->numlayers = 1;
-			parameters->layer_rate[0] = 0;
 		}
 		parameters->allocationByRateDistoration = true;
 	}
@@ -310,6 +315,11 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 	cp_.coding_params_.enc_.writePLT = parameters->writePLT;
 	cp_.coding_params_.enc_.writeTLM = parameters->writeTLM;
 	cp_.coding_params_.enc_.rateControlAlgorithm = parameters->rateControlAlgorithm;
+	cp_.coding_params_.enc_.earlyTermination_ = parameters->earlyTermination;
+	cp_.coding_params_.enc_.numThreads_ = parameters->numThreads;
+	cp_.coding_params_.enc_.maxTilesInFlight_ = parameters->maxTilesInFlight;
+	cp_.coding_params_.enc_.ioPullCallback_ = parameters->io_pull_callback;
+	cp_.coding_params_.enc_.ioPullUserData_ = parameters->io_pull_user_data;
 
 	/* tiles */
 	cp_.t_width = parameters->t_width;
@@ -624,40 +634,102 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 							  numTiles, maxNumTilesJ2K);
 		return 0;
 	}
-	auto numRequiredThreads =
-		std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(), numTiles);
+	auto numRequiredThreads = std::min<uint32_t>(
+		ExecSingleton::maxConcurrency(cp_.coding_params_.enc_.numThreads_), numTiles);
 	std::atomic<bool> success(true);
-	if(numRequiredThreads > 1)
-	{
-		tf::Executor exec(numRequiredThreads);
-		tf::Taskflow taskflow;
-		auto node = new tf::Task[numTiles];
-		for(uint64_t i = 0; i < numTiles; i++)
-			node[i] = taskflow.placeholder();
+	// image data is either resident in the header image, or pulled from the client
+	// one tile row at a time
+	StripSource* stripSource = nullptr;
+	if(cp_.coding_params_.enc_.ioPullCallback_ && !tile)
+		stripSource = new StripSource(headerImage_, &cp_, cp_.coding_params_.enc_.ioPullCallback_,
+									  cp_.coding_params_.enc_.ioPullUserData_);
+	if(cp_.coding_params_.enc_.rateControlAlgorithm == GRK_RATE_CONTROL_PCRD_OPT_GLOBAL &&
+	   numTiles > 1)
+	{
+		success = compressGlobal(tile, stripSource, numRequiredThreads);
+	}
+	else if(numRequiredThreads > 1)
+	{
+		// A tile is in flight from the moment it is submitted until its tile parts
+		// have been written and its processor freed. Bounding the number of tiles
+		// in flight bounds peak memory, and applies back pressure to the scheduler
+		// when an early tile is slow to finish.
+		uint32_t maxTilesInFlight = cp_.coding_params_.enc_.maxTilesInFlight_;
+		if(!maxTilesInFlight)
+			maxTilesInFlight = numRequiredThreads * maxInFlightTilesPerThreadGRK;
+		maxTilesInFlight = std::min<uint32_t>(maxTilesInFlight, numTiles);
+		std::mutex writeMutex;
+		std::condition_variable writeCondition;
+		uint32_t numTilesWritten = 0;
+		// tiles are compressed on the shared executor, and written to the code stream,
+		// in tile order, by whichever worker completes the next tile in sequence
+		auto writeCompletedTiles = [this, &heap, &success, &writeMutex, &writeCondition,
+									&numTilesWritten]() {
+			std::unique_lock<std::mutex> lk(writeMutex);
+			auto completeTileProcessor = heap.pop();
+			while(completeTileProcessor)
+			{
+				if(success && !writeTileParts(completeTileProcessor))
+					success = false;
+				delete completeTileProcessor;
+				numTilesWritten++;
+				completeTileProcessor = heap.pop();
+			}
+			writeCondition.notify_all();
+		};
+		BoundedExecutor exec(std::min<uint32_t>(numRequiredThreads, maxTilesInFlight),
+							 maxTilesInFlight);
 		for(uint16_t j = 0; j < numTiles; ++j)
 		{
+			{
+				std::unique_lock<std::mutex> lk(writeMutex);
+				writeCondition.wait(lk, [j, maxTilesInFlight, &numTilesWritten, &success] {
+					return !success || (uint32_t)(j - numTilesWritten) < maxTilesInFlight;
+				});
+			}
+			if(!success)
+				break;
+			auto srcImage = stripSource ? stripSource->acquire(j) : headerImage_;
+			if(!srcImage)
+			{
+				success = false;
+				break;
+			}
 			uint16_t tileIndex = j;
-			node[j].work([this, tile, tileIndex, &heap, &success] {
+			exec.submit([this, tile, tileIndex, srcImage, stripSource, &heap, &success,
+						 writeCompletedTiles] {
 				if(success)
 				{
 					auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
 					tileProcessor->current_plugin_tile = tile;
-					if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
+					bool ingested = tileProcessor->preCompressTile(srcImage);
+					if(stripSource)
+						stripSource->release(tileIndex);
+					if(!ingested || !tileProcessor->doCompress())
 						success = false;
 					heap.push(tileProcessor);
 				}
+				writeCompletedTiles();
 			});
 		}
-		exec.run(taskflow).wait();
-		delete[] node;
+		exec.wait();
 	}
 	else
 	{
 		for(uint16_t i = 0; i < numTiles; ++i)
 		{
+			auto srcImage = stripSource ? stripSource->acquire(i) : headerImage_;
+			if(!srcImage)
+			{
+				success = false;
+				goto cleanup;
+			}
 			auto tileProcessor = new TileProcessor(i, this, stream_, true, nullptr);
 			tileProcessor->current_plugin_tile = tile;
-			if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
+			bool ingested = tileProcessor->preCompressTile(srcImage);
+			if(stripSource)
+				stripSource->release(i);
+			if(!ingested || !tileProcessor->doCompress())
 			{
 				delete tileProcessor;
 				success = false;
@@ -673,22 +745,198 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 		}
 	}
 cleanup:
-	auto completeTileProcessor = heap.pop();
-	while(completeTileProcessor)
+	delete stripSource;
+	// after a failure, tiles following a missing tile can never be written
+	auto strandedTileProcessor = heap.popAny();
+	while(strandedTileProcessor)
 	{
-		if(success)
-		{
-			if(!writeTileParts(completeTileProcessor))
-				success = false;
-		}
-		delete completeTileProcessor;
-		completeTileProcessor = heap.pop();
+		delete strandedTileProcessor;
+		strandedTileProcessor = heap.popAny();
 	}
 	if(success)
 		success = end();
 
 	return success ? stream_->tell() : 0;
 }
+/*
+ Run job for each tile, on at most numThreads threads of the shared executor.
+ If set, submit is called from the calling thread, in tile order, before each job is queued
+ */
+static bool forEachTile(uint32_t numTiles, uint32_t numThreads,
+						const std::function<bool(uint16_t)>& job,
+						const std::function<bool(uint16_t)>& submit = nullptr)
+{
+	if(numThreads <= 1)
+	{
+		for(uint32_t i = 0; i < numTiles; ++i)
+		{
+			if((submit && !submit((uint16_t)i)) || !job((uint16_t)i))
+				return false;
+		}
+		return true;
+	}
+	std::atomic<bool> success(true);
+	BoundedExecutor exec(numThreads, numThreads);
+	for(uint32_t i = 0; i < numTiles && success; ++i)
+	{
+		uint16_t tileIndex = (uint16_t)i;
+		if(submit && !submit(tileIndex))
+		{
+			success = false;
+			break;
+		}
+		exec.submit([&job, &success, tileIndex] {
+			if(success && !job(tileIndex))
+				success = false;
+		});
+	}
+	exec.wait();
+
+	return success;
+}
+/*
+ Compress with a single rate distortion slope threshold per layer, shared by all tiles.
+ T1 runs on all tiles first, and all tiles are held in memory until their
+ layers have been formed
+ */
+bool CodeStreamCompress::compressGlobal(grk_plugin_tile* tile, StripSource* stripSource,
+										uint32_t numThreads)
+{
+	uint32_t numTiles = (uint32_t)cp_.t_grid_height * cp_.t_grid_width;
+	std::vector<TileProcessor*> tileProcessors(numTiles, nullptr);
+	std::vector<GrkImage*> srcImages(numTiles, nullptr);
+	// 1. T1
+	bool success = forEachTile(
+		numTiles, numThreads,
+		[this, tile, stripSource, &tileProcessors, &srcImages](uint16_t tileIndex) {
+			auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
+			tileProcessors[tileIndex] = tileProcessor;
+			tileProcessor->current_plugin_tile = tile;
+			bool ingested = tileProcessor->preCompressTile(srcImages[tileIndex]);
+			if(stripSource)
+				stripSource->release(tileIndex);
+			if(!ingested || !tileProcessor->compressT1())
+				return false;
+			// tile samples are no longer needed
+			tileProcessor->deallocBuffers();
+
+			return true;
+		},
+		[this, stripSource, &srcImages](uint16_t tileIndex) {
+			srcImages[tileIndex] = stripSource ? stripSource->acquire(tileIndex) : headerImage_;
+			return srcImages[tileIndex] != nullptr;
+		});
+	// 2. rate allocation
+	if(success)
+		success = allocateRateGlobal(tileProcessors, numThreads);
+	// 3. T2
+	for(auto& tileProcessor : tileProcessors)
+	{
+		if(success && !writeTileParts(tileProcessor))
+			success = false;
+		delete tileProcessor;
+		tileProcessor = nullptr;
+	}
+
+	return success;
+}
+bool CodeStreamCompress::allocateRateGlobal(std::vector<TileProcessor*>& tileProcessors,
+											uint32_t numThreads)
+{
+	auto numTiles = (uint32_t)tileProcessors.size();
+	auto enc = &cp_.coding_params_.enc_;
+	// all tiles share the layer configuration of the first tile
+	auto tcp = cp_.tcps;
+	const double K = 1;
+	std::vector<uint16_t> minimumThresh(numTiles);
+	std::vector<double> maxSE(numTiles);
+	if(!forEachTile(numTiles, numThreads, [&tileProcessors, &minimumThresh, &maxSE](uint16_t i) {
+		   return tileProcessors[i]->prepareGlobalRateAllocation(&minimumThresh[i], &maxSE[i]);
+	   }))
+		return false;
+	uint32_t minSlope = *std::min_element(minimumThresh.begin(), minimumThresh.end());
+	double totalMaxSE = std::accumulate(maxSE.begin(), maxSE.end(), 0.0);
+	double totalDistortion = 0;
+	for(auto tileProcessor : tileProcessors)
+		totalDistortion += tileProcessor->getTile()->distortion;
+	auto layerDistortion = [&tileProcessors](uint16_t layno) {
+		double distortion = 0;
+		for(auto tileProcessor : tileProcessors)
+			distortion += tileProcessor->getTile()->layerDistoration[layno];
+		return distortion;
+	};
+	std::vector<uint64_t> allPacketBytes(numTiles);
+	double cumulativeDistortion = 0;
+	uint32_t upperBound = USHRT_MAX;
+	for(uint16_t layno = 0; layno < tcp->max_layers_; ++layno)
+	{
+		bool byQuality = enc->allocationByFixedQuality_;
+		bool needsRateControl = (enc->allocationByRateDistortion_ && tcp->rates[layno] > 0.0) ||
+								(byQuality && tcp->distortion[layno] > 0.0);
+		uint32_t lowerBound = minSlope;
+		if(needsRateControl)
+		{
+			// image budget is the sum of the tile budgets
+			uint64_t maxBytes = 0;
+			for(uint32_t i = 0; i < numTiles; ++i)
+				maxBytes += (uint64_t)ceil(cp_.tcps[i].rates[layno]);
+			double distortionTarget =
+				totalDistortion - ((K * totalMaxSE) / pow(10.0, tcp->distortion[layno] / 10.0));
+			uint32_t prevthresh = 0;
+			for(uint32_t i = 0; i < 128; ++i)
+			{
+				uint32_t thresh = (lowerBound + upperBound) >> 1;
+				if(prevthresh != 0 && prevthresh == thresh)
+					break;
+				prevthresh = thresh;
+				if(!forEachTile(numTiles, numThreads,
+								[&tileProcessors, &allPacketBytes, layno, thresh,
+								 byQuality](uint16_t tileIndex) {
+									return tileProcessors[tileIndex]->makeGlobalLayer(
+										layno, (uint16_t)thresh, false,
+										byQuality ? nullptr : &allPacketBytes[tileIndex]);
+								}))
+					return false;
+				if(byQuality)
+				{
+					if(cumulativeDistortion + layerDistortion(layno) < distortionTarget)
+					{
+						upperBound = thresh;
+						continue;
+					}
+					lowerBound = thresh;
+				}
+				else
+				{
+					uint64_t bytes =
+						std::accumulate(allPacketBytes.begin(), allPacketBytes.end(), (uint64_t)0);
+					if(bytes > maxBytes)
+					{
+						lowerBound = thresh;
+						continue;
+					}
+					upperBound = thresh;
+				}
+			}
+		}
+		// choose conservative value for threshold
+		uint32_t goodthresh = upperBound;
+		if(!forEachTile(numTiles, numThreads,
+						[&tileProcessors, layno, goodthresh](uint16_t tileIndex) {
+							return tileProcessors[tileIndex]->makeGlobalLayer(
+								layno, (uint16_t)goodthresh, true, nullptr);
+						}))
+			return false;
+		cumulativeDistortion += layerDistortion(layno);
+		// upper bound for next layer is initialized to lowerBound for current layer, minus one
+		if(needsRateControl)
+			upperBound = lowerBound - 1;
+	}
+
+	return forEachTile(numTiles, numThreads, [&tileProcessors](uint16_t tileIndex) {
+		return tileProcessors[tileIndex]->finishGlobalRateAllocation();
+	});
+}
 bool CodeStreamCompress::end(void)
 {
 	/* customization of the compressing */
@@ -44,6 +44,8 @@ class CodeStreamCompress : public CodeStream, public ICodeStreamCompress
 	bool end(void);
 	bool writeTilePart(TileProcessor* tileProcessor);
 	bool writeTileParts(TileProcessor* tileProcessor);
+	bool compressGlobal(grk_plugin_tile* tile, StripSource* stripSource, uint32_t numThreads);
+	bool allocateRateGlobal(std::vector<TileProcessor*>& tileProcessors, uint32_t numThreads);
 	bool updateRates(void);
 	bool compressValidation(void);
 	bool mct_validation(void);
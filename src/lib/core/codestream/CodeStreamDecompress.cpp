@@ -26,7 +26,7 @@ namespace grk
 CodeStreamDecompress::CodeStreamDecompress(BufferedStream* stream)
 	: CodeStream(stream), expectSOD_(false), curr_marker_(0), headerError_(false),
 	  headerRead_(false), marker_scratch_(nullptr), marker_scratch_size_(0), outputImage_(nullptr),
-	  tileCache_(new TileCache()), ioBufferCallback(nullptr), ioUserData(nullptr),
+	  compositeHeader_(nullptr), decompressed_(false), tileCache_(new TileCache()), ioBufferCallback(nullptr), ioUserData(nullptr),
 	  grkRegisterReclaimCallback_(nullptr)
 {
 	decompressorState_.default_tcp_ = new TileCodingParams();
@@ -106,6 +106,8 @@ CodeStreamDecompress::~CodeStreamDecompress()
 	delete[] marker_scratch_;
 	if(outputImage_)
 		grk_object_unref(&outputImage_->obj);
+	if(compositeHeader_)
+		grk_object_unref(&compositeHeader_->obj);
 	delete tileCache_;
 }
 bool CodeStreamDecompress::needsHeaderRead(void)
@@ -124,9 +126,20 @@ TileProcessor* CodeStreamDecompress::allocateProcessor(uint16_t tileIndex)
 {
 	auto tileCache = tileCache_->get(tileIndex);
 	auto tileProcessor = tileCache ? tileCache->processor : nullptr;
+	// tile of a processor from a previous decompression may have been released,
+	// in which case the tile parts must be parsed by a new processor
+	if(tileProcessor && !tileProcessor->getTile())
+	{
+		delete tileProcessor;
+		tileProcessor = nullptr;
+	}
 	if(!tileProcessor)
 	{
 		tileProcessor = new TileProcessor(tileIndex, this, stream_, false, &stripCache_);
+		auto strategy = tileCache_->getStrategy();
+		tileProcessor->setRetainPackets(strategy == GRK_TILE_CACHE_PACKETS ||
+										strategy == GRK_TILE_CACHE_BLOCKS);
+		tileProcessor->setRetainBlocks(strategy == GRK_TILE_CACHE_BLOCKS);
 		tileCache_->put(tileIndex, tileProcessor);
 	}
 	currentTileProcessor_ = tileProcessor;
@@ -159,6 +172,10 @@ std::vector<GrkImage*> CodeStreamDecompress::getAllImages(void)
 {
 	return tileCache_->getAllImages();
 }
+void CodeStreamDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	tileCache_->getStats(stats);
+}
 GrkImage* CodeStreamDecompress::getImage()
 {
 	return getCompositeImage();
@@ -242,26 +259,71 @@ bool CodeStreamDecompress::readHeader(grk_header_info* header_info)
 	return true;
 }
 bool CodeStreamDecompress::setDecompressRegion(grk_rect_single region)
+{
+	return setDecompressRegion(grk_rect32((uint32_t)region.x0, (uint32_t)region.y0,
+										  (uint32_t)region.x1, (uint32_t)region.y1));
+}
+bool CodeStreamDecompress::setDecompressRegion(uint8_t reduce, grk_rect32 region)
+{
+	if(region.empty())
+	{
+		Logger::logger_.error("Decompress region (%u,%u,%u,%u) is empty", region.x0, region.y0,
+							  region.x1, region.y1);
+		return false;
+	}
+	if(!setReduce(reduce))
+		return false;
+	// map region from reduced image canvas to full resolution image canvas
+	auto image = headerImage_;
+	uint64_t reducedX0 = ceildivpow2<uint32_t>(image->x0, reduce);
+	uint64_t reducedY0 = ceildivpow2<uint32_t>(image->y0, reduce);
+	uint64_t x0 = ((reducedX0 + region.x0) << reduce) - image->x0;
+	uint64_t y0 = ((reducedY0 + region.y0) << reduce) - image->y0;
+	uint64_t x1 = std::min<uint64_t>(((reducedX0 + region.x1) << reduce) - image->x0,
+									 image->width());
+	uint64_t y1 = std::min<uint64_t>(((reducedY0 + region.y1) << reduce) - image->y0,
+									 image->height());
+	if(x0 >= x1 || y0 >= y1)
+	{
+		Logger::logger_.error("Decompress region (%u,%u,%u,%u) at reduction %u"
+							  " is outside of the image area",
+							  region.x0, region.y0, region.x1, region.y1, reduce);
+		return false;
+	}
+
+	return setDecompressRegion(grk_rect32((uint32_t)x0, (uint32_t)y0, (uint32_t)x1, (uint32_t)y1));
+}
+bool CodeStreamDecompress::setDecompressRegion(grk_rect32 region)
 {
 	auto image = headerImage_;
 	auto compositeImage = getCompositeImage();
 	auto decompressor = &decompressorState_;
 
 	/* Check if we have read the main header */
-	if(decompressor->getState() != DECOMPRESS_STATE_TPH_SOT)
+	if(decompressor->getState() != DECOMPRESS_STATE_TPH_SOT && !decompressed_)
 	{
 		Logger::logger_.error("Need to read the main header before setting decompress region");
 		return false;
 	}
+	saveCompositeHeader();
+	if(decompressed_)
+	{
+		// discard window from previous decompression
+		if(!restoreCompositeHeader(grk_rect32(image->x0, image->y0, image->x1, image->y1)))
+			return false;
+		decompressor->tilesToDecompress_.schedule(
+			grk_rect16(0, 0, (uint16_t)cp_.t_grid_width, (uint16_t)cp_.t_grid_height));
+		cp_.wholeTileDecompress_ = true;
+	}
 
-	if(region != grk_rect_single(0, 0, 0, 0))
+	if(!(region == grk_rect32(0, 0, 0, 0)))
 	{
 		grk_rect16 tilesToDecompress;
 		/* Check if the region provided by the user is correct */
-		uint32_t start_x = (uint32_t)region.x0 + image->x0;
-		uint32_t start_y = (uint32_t)region.y0 + image->y0;
-		uint32_t end_x = (uint32_t)region.x1 + image->x0;
-		uint32_t end_y = (uint32_t)region.y1 + image->y0;
+		uint32_t start_x = region.x0 + image->x0;
+		uint32_t start_y = region.y0 + image->y0;
+		uint32_t end_x = region.x1 + image->x0;
+		uint32_t end_y = region.y1 + image->y0;
 		/* Left */
 		if(start_x > image->x1)
 		{
@@ -351,6 +413,94 @@ bool CodeStreamDecompress::setDecompressRegion(grk_rect_single region)
 
 	return true;
 }
+bool CodeStreamDecompress::setReduce(uint8_t reduce)
+{
+	if(!headerRead_)
+	{
+		Logger::logger_.error("Need to read the main header before setting resolution reduction");
+		return false;
+	}
+	uint16_t numTiles = (uint16_t)(cp_.t_grid_width * cp_.t_grid_height);
+	for(uint16_t tileIndex = 0; tileIndex < numTiles; ++tileIndex)
+	{
+		auto tcp = cp_.tcps + tileIndex;
+		for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
+		{
+			auto tccp = tcp->tccps + compno;
+			if(reduce >= tccp->numresolutions)
+			{
+				Logger::logger_.error("The number of resolutions to remove (%u) must be strictly "
+									  "less than the number of resolutions (%u) of "
+									  "tile %u component %u.",
+									  reduce, tccp->numresolutions, tileIndex, compno);
+				return false;
+			}
+		}
+	}
+	saveCompositeHeader();
+	cp_.coding_params_.dec_.reduce_ = reduce;
+	// reduce header image components, as for SIZ marker
+	auto imageBounds = grk_rect32(headerImage_->x0, headerImage_->y0, headerImage_->x1,
+								  headerImage_->y1);
+	for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
+	{
+		auto comp = headerImage_->comps + compno;
+		auto compBounds = imageBounds.scaleDownCeil(comp->dx, comp->dy);
+		comp->w = ceildivpow2<uint32_t>(compBounds.width(), reduce);
+		comp->h = ceildivpow2<uint32_t>(compBounds.height(), reduce);
+		comp->x0 = ceildivpow2<uint32_t>(compBounds.x0, reduce);
+		comp->y0 = ceildivpow2<uint32_t>(compBounds.y0, reduce);
+	}
+	auto compositeImage = getCompositeImage();
+
+	return restoreCompositeHeader(grk_rect32(compositeImage->x0, compositeImage->y0,
+											 compositeImage->x1, compositeImage->y1));
+}
+/**
+ * Keep a copy of the composite image header as it was after the main header was read,
+ * so that it can be restored for later decompressions of the same code stream
+ */
+void CodeStreamDecompress::saveCompositeHeader(void)
+{
+	if(compositeHeader_)
+		return;
+	compositeHeader_ = new GrkImage();
+	getCompositeImage()->copyHeader(compositeHeader_);
+}
+/**
+ * Restore composite image header and discard composite image data, then apply
+ * canvas bounds and current resolution reduction
+ *
+ * @param bounds composite image canvas bounds
+ */
+bool CodeStreamDecompress::restoreCompositeHeader(grk_rect32 bounds)
+{
+	auto compositeImage = getCompositeImage();
+	compositeHeader_->copyHeader(compositeImage);
+	compositeImage->x0 = bounds.x0;
+	compositeImage->y0 = bounds.y0;
+	compositeImage->x1 = bounds.x1;
+	compositeImage->y1 = bounds.y1;
+	if(bounds == grk_rect32(headerImage_->x0, headerImage_->y0, headerImage_->x1, headerImage_->y1))
+	{
+		for(uint16_t compno = 0; compno < compositeImage->numcomps; ++compno)
+		{
+			auto comp = compositeImage->comps + compno;
+			auto headerComp = headerImage_->comps + compno;
+			comp->x0 = headerComp->x0;
+			comp->y0 = headerComp->y0;
+			comp->w = headerComp->w;
+			comp->h = headerComp->h;
+		}
+	}
+	else if(!compositeImage->subsampleAndReduce(cp_.coding_params_.dec_.reduce_))
+	{
+		return false;
+	}
+	compositeImage->postReadHeader(&cp_);
+
+	return true;
+}
 void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 {
 	assert(parameters);
@@ -358,7 +508,10 @@ void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 	cp_.coding_params_.dec_.layers_to_decompress_ = parameters->layers_to_decompress_;
 	cp_.coding_params_.dec_.reduce_ = parameters->reduce;
 	cp_.coding_params_.dec_.randomAccessFlags_ = parameters->randomAccessFlags_;
+	cp_.coding_params_.dec_.numThreads_ = parameters->numThreads;
 	tileCache_->setStrategy(parameters->tileCacheStrategy);
+	tileCache_->setBudget(parameters->tileCacheBudget);
+	t1Pool_->setT1Decoder(parameters->t1Decoder);
 
 	ioBufferCallback = parameters->io_buffer_callback;
 	ioUserData = parameters->io_user_data;
@@ -366,19 +519,85 @@ void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 }
 bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
 {
+	saveCompositeHeader();
+	if(decompressed_)
+	{
+		// undo post processing of previous decompression
+		auto compositeImage = getCompositeImage();
+		if(!restoreCompositeHeader(grk_rect32(compositeImage->x0, compositeImage->y0,
+											  compositeImage->x1, compositeImage->y1)))
+			return false;
+	}
 	procedure_list_.push_back(std::bind(&CodeStreamDecompress::decompressTiles, this));
 	current_plugin_tile = tile;
 
 	return decompressExec();
 }
+bool CodeStreamDecompress::decompressWindows(const grk_decompress_window* windows,
+											 uint32_t numWindows,
+											 grk_decompress_window_callback callback,
+											 void* userData)
+{
+	return decompressWindows(this, windows, numWindows, callback, userData);
+}
+bool CodeStreamDecompress::decompressWindows(ICodeStreamDecompress* decompressor,
+											 const grk_decompress_window* windows,
+											 uint32_t numWindows,
+											 grk_decompress_window_callback callback,
+											 void* userData)
+{
+	if(!windows || !callback)
+	{
+		Logger::logger_.error("Missing windows or window callback for batch decompression");
+		return false;
+	}
+	// visit windows in tile order, so that windows sharing tiles
+	// are decompressed one after the other
+	auto tileOf = [this](const grk_decompress_window& w) {
+		uint64_t row = ((uint64_t)w.y0 << w.reduce) / cp_.t_height;
+		uint64_t col = ((uint64_t)w.x0 << w.reduce) / cp_.t_width;
+		return row * cp_.t_grid_width + col;
+	};
+	std::vector<uint32_t> order(numWindows);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [windows, &tileOf](uint32_t a, uint32_t b) {
+		return tileOf(windows[a]) < tileOf(windows[b]);
+	});
+
+	// retain decompressed code blocks for the duration of the batch
+	auto strategy = tileCache_->getStrategy();
+	tileCache_->setStrategy(GRK_TILE_CACHE_BLOCKS);
+	bool rc = true;
+	for(auto windowIndex : order)
+	{
+		auto w = windows + windowIndex;
+		if(!decompressor->setDecompressRegion(w->reduce, grk_rect32(w->x0, w->y0, w->x1, w->y1)) ||
+		   !decompressor->decompress(nullptr) || !decompressor->postProcess())
+		{
+			Logger::logger_.error("Failed to decompress window %u", windowIndex);
+			rc = false;
+			break;
+		}
+		if(!callback(windowIndex, getCompositeImage(), userData))
+		{
+			rc = false;
+			break;
+		}
+	}
+	tileCache_->setStrategy(strategy);
+	if(strategy != GRK_TILE_CACHE_BLOCKS)
+		tileCache_->evictAll();
+
+	return rc;
+}
 bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 {
 	// 1. check if tile has already been decompressed
-	auto entry = tileCache_->get(tileIndex);
-	if(entry && entry->processor && entry->processor->getImage())
+	if(tileCache_->lookup(tileIndex))
 		return true;
 
 	// 2. otherwise, decompress tile
+	saveCompositeHeader();
 	if(outputImage_)
 	{
 		/* Copy code stream image information to composite image */
@@ -464,8 +683,8 @@ bool CodeStreamDecompress::decompressTiles(void)
 	if(!createOutputImage())
 		return false;
 
-	auto numRequiredThreads =
-		std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(), numTilesToDecompress);
+	auto numRequiredThreads = std::min<uint32_t>(
+		ExecSingleton::maxConcurrency(cp_.coding_params_.dec_.numThreads_), numTilesToDecompress);
 	if(outputImage_->supportsStripCache(&cp_))
 	{
 		uint32_t numStrips = cp_.t_grid_height;
@@ -483,21 +702,93 @@ bool CodeStreamDecompress::decompressTiles(void)
 	std::atomic<bool> success(true);
 	std::atomic<uint32_t> numTilesDecompressed(0);
 
-	tf::Executor* executor = nullptr;
-	tf::Task* node = nullptr;
-	tf::Taskflow taskflow;
+	// tiles are handed to the shared executor as soon as they have been parsed,
+	// so that T2/T1 for earlier tiles overlaps with parsing of later tiles.
+	// The number of parsed tiles that have not yet finished decompressing
+	// is bounded, to keep memory flat for code streams with many tiles
+	BoundedExecutor* executor = nullptr;
 	if(numRequiredThreads > 1)
-	{
-		executor = new tf::Executor(numRequiredThreads);
-		node = new tf::Task[numTilesToDecompress];
-		for(uint64_t i = 0; i < numTilesToDecompress; i++)
-			node[i] = taskflow.placeholder();
-	}
+		executor =
+			new BoundedExecutor(numRequiredThreads, numRequiredThreads * maxInFlightTilesPerThreadGRK);
 	bool breakAfterT1 = false;
 	bool canDecompress = true;
-	uint16_t tileCount = 0;
-	while(!endOfCodeStream() && !breakAfterT1)
+	// T2 + T1 decompress
+	// once we schedule a processor for T1 compression, we will destroy it
+	// regardless of success or not
+	auto exec = [this, executor, numTilesToDecompress, &numTilesDecompressed,
+				 &success](TileProcessor* processor) {
+		if(!success)
+			return;
+		if(!processor->decompressT2T1(outputImage_))
+		{
+			Logger::logger_.error("Failed to decompress tile %u/%u", processor->getIndex(),
+								  numTilesToDecompress);
+			success = false;
+			return;
+		}
+		numTilesDecompressed++;
+		auto img = processor->getImage();
+		if(outputImage_->hasMultipleTiles && img)
+		{
+			if(outputImage_->supportsStripCache(&cp_))
+			{
+				if(executor)
+				{
+					if(!stripCache_.ingestTile(ExecSingleton::threadId(), img))
+						success = false;
+				}
+				else
+				{
+					if(!stripCache_.ingestTile(img))
+						success = false;
+				}
+			}
+			else
+			{
+				if(!outputImage_->composite(img))
+					success = false;
+			}
+		}
+		processor->release(success ? tileCache_->getStrategy() : GRK_TILE_CACHE_NONE);
+		if(success)
+			tileCache_->cache(processor->getIndex());
+	};
+	auto submit = [executor, &exec](TileProcessor* processor) {
+		if(executor)
+			executor->submit([&exec, processor] { exec(processor); });
+		else
+			exec(processor);
+	};
+
+	// tiles whose packets were retained by a previous decompression
+	// are decompressed without re-reading their tile parts
+	auto& tilesToDecompress = decompressorState_.tilesToDecompress_;
+	tilesToDecompress.clearComplete();
+	auto scheduledTiles = tilesToDecompress;
+	std::vector<TileProcessor*> retainedTiles;
+	for(uint16_t tileIndex = 0; tileIndex < numTilesToDecompress; ++tileIndex)
+	{
+		if(!tilesToDecompress.isScheduled(tileIndex))
+			continue;
+		auto tileCache = tileCache_->get(tileIndex);
+		if(tileCache && tileCache->processor && tileCache->processor->hasRetainedPackets())
+		{
+			retainedTiles.push_back(tileCache->processor);
+			tilesToDecompress.unschedule(tileIndex);
+		}
+	}
+	for(auto processor : retainedTiles)
+		submit(processor);
+	if(tilesToDecompress.numScheduled() && decompressed_ && !rewindTileParts())
+	{
+		success = false;
+		goto cleanup;
+	}
+	while(tilesToDecompress.numScheduled() && !endOfCodeStream() && !breakAfterT1)
 	{
+		// stop parsing as soon as a scheduled tile has failed
+		if(!success)
+			goto cleanup;
 		// 1. parse tile
 		try
 		{
@@ -539,60 +830,10 @@ bool CodeStreamDecompress::decompressTiles(void)
 			breakAfterT1 = true;
 		}
 		// 3. T2 + T1 decompress
-		// once we schedule a processor for T1 compression, we will destroy it
-		// regardless of success or not
-		auto exec = [this, executor, processor, numTilesToDecompress, &numTilesDecompressed,
-					 &success] {
-			if(success)
-			{
-				if(!processor->decompressT2T1(outputImage_))
-				{
-					Logger::logger_.error("Failed to decompress tile %u/%u", processor->getIndex(),
-										  numTilesToDecompress);
-					success = false;
-				}
-				else
-				{
-					numTilesDecompressed++;
-					auto img = processor->getImage();
-					if(outputImage_->hasMultipleTiles && img)
-					{
-						if(outputImage_->supportsStripCache(&cp_))
-						{
-							if(executor)
-							{
-								uint32_t threadId = executor->num_workers() > 1
-														? (uint32_t)executor->this_worker_id()
-														: 0;
-								if(!stripCache_.ingestTile(threadId, img))
-									success = false;
-							}
-							else
-							{
-								if(!stripCache_.ingestTile(img))
-									success = false;
-							}
-						}
-						else
-						{
-							if(!outputImage_->composite(img))
-								success = false;
-						}
-					}
-					processor->release(success ? tileCache_->getStrategy() : GRK_TILE_CACHE_NONE);
-				}
-			}
-			return 0;
-		};
-		if(node)
-			node[tileCount++].work(exec);
-		else
-		{
-			exec();
-			if(!success)
-				goto cleanup;
-		}
-		if(decompressorState_.tilesToDecompress_.allComplete())
+		submit(processor);
+		if(!executor && !success)
+			goto cleanup;
+		if(tilesToDecompress.allComplete())
 		{
 			// check for corrupt Adobe files where 5 tile parts per tile are signaled
 			// but there are actually 6
@@ -609,11 +850,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 	}
 	if(executor)
 	{
-		executor->run(taskflow).wait();
+		executor->wait();
 		delete executor;
 		executor = nullptr;
-		delete[] node;
-		node = nullptr;
 	}
 
 	if(!success)
@@ -634,10 +873,12 @@ bool CodeStreamDecompress::decompressTiles(void)
 cleanup:
 	if(executor)
 	{
-		executor->run(taskflow).wait();
+		executor->wait();
 		delete executor;
-		delete[] node;
 	}
+	tilesToDecompress = scheduledTiles;
+	tileCache_->trim();
+
 	return success;
 }
 bool CodeStreamDecompress::copy_default_tcp(void)
@@ -789,7 +1030,9 @@ bool CodeStreamDecompress::readHeaderProcedureImpl(void)
 }
 bool CodeStreamDecompress::decompressExec(void)
 {
-	if(!exec(procedure_list_))
+	bool rc = exec(procedure_list_);
+	decompressed_ = true;
+	if(!rc)
 		return false;
 
 	// transfer output image to composite image
@@ -800,17 +1043,11 @@ bool CodeStreamDecompress::decompressExec(void)
 
 bool CodeStreamDecompress::createOutputImage(void)
 {
-	if(!headerImage_->hasMultipleTiles)
-	{
-		if(outputImage_)
-			grk_object_unref(&outputImage_->obj);
-		outputImage_ = nullptr;
-	}
-	if(!outputImage_)
-	{
-		outputImage_ = new GrkImage();
-		getCompositeImage()->copyHeader(outputImage_);
-	}
+	// output image from a previous decompression may have different bounds
+	if(outputImage_)
+		grk_object_unref(&outputImage_->obj);
+	outputImage_ = new GrkImage();
+	getCompositeImage()->copyHeader(outputImage_);
 
 	return outputImage_->supportsStripCache(&cp_) || outputImage_->allocCompositeData();
 }
@@ -818,6 +1055,10 @@ bool CodeStreamDecompress::hasTLM(void)
 {
 	return cp_.tlm_markers && cp_.tlm_markers->valid();
 }
+bool CodeStreamDecompress::deferTilePartReads(void)
+{
+	return hasTLM() && stream_->supportsPositionalRead();
+}
 /***
  * Skip past non-scheduled tiles
  */
@@ -848,8 +1089,18 @@ bool CodeStreamDecompress::decompressTile(void)
 	uint16_t tileIndex = decompressorState_.tilesToDecompress_.getSingle();
 	auto tileCache = tileCache_->get(tileIndex);
 	auto tileProcessor = tileCache ? tileCache->processor : nullptr;
-	if(!tileCache || !tileCache->processor->getImage())
+	if(tileProcessor && tileProcessor->getImage())
+		return true;
+	// packets retained by a previous decompression are decompressed
+	// without re-reading tile parts
+	bool retained = tileProcessor && tileProcessor->hasRetainedPackets();
+	if(!retained)
 	{
+		// a previous tile decompress on this codec may have left the stream
+		// anywhere past the first tile part, so restart from the first tile part
+		if(!rewindTileParts())
+			return false;
+
 		// find first tile part
 		try
 		{
@@ -867,10 +1118,6 @@ bool CodeStreamDecompress::decompressTile(void)
 		{
 			return false;
 		}
-		/* Special case if we have previously read the EOC marker
-		 * (if the previous tile decompressed is the last ) */
-		if(decompressorState_.getState() == DECOMPRESS_STATE_EOC)
-			decompressorState_.setState(DECOMPRESS_STATE_TPH_SOT);
 
 		bool canDecompress = true;
 		try
@@ -884,21 +1131,23 @@ bool CodeStreamDecompress::decompressTile(void)
 			return false;
 		}
 		tileProcessor = currentTileProcessor_;
-		if(outputImage_->supportsStripCache(&cp_))
-		{
-			uint32_t numStrips = (outputImage_->height() + outputImage_->rowsPerStrip - 1) /
-								 outputImage_->rowsPerStrip;
-			stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), 1, numStrips,
-							 outputImage_->rowsPerStrip, cp_.coding_params_.dec_.reduce_,
-							 outputImage_, ioBufferCallback, ioUserData,
-							 grkRegisterReclaimCallback_);
-		}
+	}
+	if(outputImage_->supportsStripCache(&cp_))
+	{
+		uint32_t numStrips =
+			(outputImage_->height() + outputImage_->rowsPerStrip - 1) / outputImage_->rowsPerStrip;
+		stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), 1, numStrips,
+						 outputImage_->rowsPerStrip, cp_.coding_params_.dec_.reduce_, outputImage_,
+						 ioBufferCallback, ioUserData, grkRegisterReclaimCallback_);
+	}
 
-		if(!tileProcessor->decompressT2T1(outputImage_))
-			return false;
+	if(!tileProcessor->decompressT2T1(outputImage_))
+		return false;
 
-		// check for corrupt Adobe images where a final tile part is not parsed
-		// due to incorrectly-signalled number of tile parts
+	// check for corrupt Adobe images where a final tile part is not parsed
+	// due to incorrectly-signalled number of tile parts
+	if(!retained)
+	{
 		try
 		{
 			if(readSOTorEOC() && curr_marker_ == J2K_MS_SOT)
@@ -913,6 +1162,52 @@ bool CodeStreamDecompress::decompressTile(void)
 			return false;
 		}
 	}
+	switch(tileCache_->getStrategy())
+	{
+		case GRK_TILE_CACHE_NONE:
+			break;
+		case GRK_TILE_CACHE_PACKETS:
+		case GRK_TILE_CACHE_BLOCKS:
+			// retain parsed packets, and release all other tile state
+			tileProcessor->release(tileCache_->getStrategy());
+			tileCache_->cache(tileIndex);
+			tileCache_->trim();
+			break;
+		default:
+			// retain a copy of the tile image, and release all other tile state
+			if(!tileProcessor->retainImage(outputImage_))
+				return false;
+			tileProcessor->release(tileCache_->getStrategy());
+			tileCache_->cache(tileIndex);
+			break;
+	}
+
+	return true;
+}
+/**
+ * Restart tile part parsing from the first tile part in the code stream, discarding
+ * compressed data already read for scheduled tiles
+ */
+bool CodeStreamDecompress::rewindTileParts(void)
+{
+	if(!stream_->seek(codeStreamInfo->getMainHeaderEnd() + MARKER_BYTES))
+		return false;
+	curr_marker_ = J2K_MS_SOT;
+	currentTileProcessor_ = nullptr;
+	if(cp_.tlm_markers)
+		cp_.tlm_markers->rewind();
+	decompressorState_.setState(DECOMPRESS_STATE_TPH_SOT);
+	uint16_t numTiles = (uint16_t)(cp_.t_grid_width * cp_.t_grid_height);
+	for(uint16_t tileIndex = 0; tileIndex < numTiles; ++tileIndex)
+	{
+		auto tcp = cp_.tcps + tileIndex;
+		tcp->tilePartCounter_ = 0;
+		if(decompressorState_.tilesToDecompress_.isScheduled(tileIndex))
+		{
+			delete tcp->compressedTileData_;
+			tcp->compressedTileData_ = nullptr;
+		}
+	}
 
 	return true;
 }
@@ -49,7 +49,26 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	std::vector<GrkImage*> getAllImages(void);
 	void init(grk_decompress_core_params* p_param);
 	bool setDecompressRegion(grk_rect_single region);
+	bool setDecompressRegion(uint8_t reduce, grk_rect32 region);
+	bool setReduce(uint8_t reduce);
 	bool decompress(grk_plugin_tile* tile);
+	bool decompressWindows(const grk_decompress_window* windows, uint32_t numWindows,
+						   grk_decompress_window_callback callback, void* userData);
+	/**
+	 * Decompress batch of windows
+	 *
+	 * @param decompressor decompressor used for each window, so that
+	 * file format post processing is applied to each window
+	 * @param windows array of windows
+	 * @param numWindows number of windows
+	 * @param callback window callback
+	 * @param userData user data for callback
+	 *
+	 * @return true if successful
+	 */
+	bool decompressWindows(ICodeStreamDecompress* decompressor,
+						   const grk_decompress_window* windows, uint32_t numWindows,
+						   grk_decompress_window_callback callback, void* userData);
 	bool decompressTile(uint16_t tileIndex);
 	bool preProcess(void);
 	bool postProcess(void);
@@ -60,8 +79,14 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	GrkImage* getHeaderImage(void);
 	uint16_t getCurrentMarker(void);
 	void dump(uint32_t flag, FILE* outputFileStream);
+	void getTileCacheStats(grk_tile_cache_stats* stats);
 	bool needsHeaderRead(void);
 	void setExpectSOD();
+	/**
+	 * Check if tile part data can be read by the threads decompressing the tiles,
+	 * using the tile part lengths from the TLM markers and positional stream reads
+	 */
+	bool deferTilePartReads(void);
 
   protected:
 	void dump_MH_info(FILE* outputFileStream);
@@ -86,6 +111,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	void dump_image_comp_header(grk_image_comp* comp, bool dev_dump_flag, FILE* outputFileStream);
 
   private:
+	bool setDecompressRegion(grk_rect32 region);
 	bool readCurrentMarkerBody(uint16_t* markerSize);
 	bool endOfCodeStream(void);
 	bool read_short(uint16_t* val);
@@ -316,6 +342,9 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 
 	bool createOutputImage(void);
 	bool checkForIllegalTilePart(void);
+	bool rewindTileParts(void);
+	void saveCompositeHeader(void);
+	bool restoreCompositeHeader(grk_rect32 bounds);
 
 	std::map<uint16_t, marker_handler*> marker_map;
 	DecompressorState decompressorState_;
@@ -326,6 +355,12 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	uint8_t* marker_scratch_;
 	uint16_t marker_scratch_size_;
 	GrkImage* outputImage_;
+	// composite image header, before any decompress window, reduction
+	// or post processing has been applied
+	GrkImage* compositeHeader_;
+	// true once tile data has been decompressed: the code stream may then be
+	// decompressed again, with a different window or reduction
+	bool decompressed_;
 	TileCache* tileCache_;
 	StripCache stripCache_;
 	grk_io_pixels_callback ioBufferCallback;
@@ -41,5 +41,8 @@ const uint16_t maxNumLayersJ2K = 65535;
 const uint32_t maxBitPlanesGRK = 31 - T1_NMSEDEC_FRACBITS;
 // const uint32_t max_bit_planes_bibo = maxSupportedPrecisionGRK + GRK_J2K_MAXRLVLS * 5;
 const uint16_t maxCompressLayersGRK = 100;
+// number of parsed tiles, per worker thread, that may be queued for T2/T1
+// while the code stream parser reads ahead
+const uint32_t maxInFlightTilesPerThreadGRK = 2;
 
 } // namespace grk
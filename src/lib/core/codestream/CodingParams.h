@@ -224,6 +224,15 @@ struct EncodingParams
 	bool writeTLM;
 	/* rate control algorithm */
 	uint32_t rateControlAlgorithm;
+	/* stop T1 coding passes below a predicted rate-distortion slope threshold */
+	bool earlyTermination_;
+	/* maximum number of shared pool threads used for tile compression (0 => all) */
+	uint32_t numThreads_;
+	/* maximum number of tiles compressed but not yet written (0 => default) */
+	uint32_t maxTilesInFlight_;
+	/* if set, image data is pulled from the client one tile row at a time */
+	grk_io_pull_callback ioPullCallback_;
+	void* ioPullUserData_;
 };
 
 struct DecodingParams
@@ -236,6 +245,8 @@ struct DecodingParams
 	uint16_t layers_to_decompress_;
 
 	uint32_t randomAccessFlags_;
+	/* maximum number of shared pool threads used for tile decompression (0 => all) */
+	uint32_t numThreads_;
 };
 
 /**
@@ -266,6 +266,21 @@ bool FileFormatDecompress::setDecompressRegion(grk_rect_single region)
 {
 	return codeStream->setDecompressRegion(region);
 }
+bool FileFormatDecompress::setDecompressRegion(uint8_t reduce, grk_rect32 region)
+{
+	return codeStream->setDecompressRegion(reduce, region);
+}
+bool FileFormatDecompress::decompressWindows(const grk_decompress_window* windows,
+											 uint32_t numWindows,
+											 grk_decompress_window_callback callback,
+											 void* userData)
+{
+	return codeStream->decompressWindows(this, windows, numWindows, callback, userData);
+}
+bool FileFormatDecompress::setReduce(uint8_t reduce)
+{
+	return codeStream->setReduce(reduce);
+}
 /** Set up decompressor function handler */
 void FileFormatDecompress::init(grk_decompress_core_params* parameters)
 {
@@ -400,6 +415,10 @@ void FileFormatDecompress::dump(uint32_t flag, FILE* outputFileStream)
 {
 	codeStream->dump(flag, outputFileStream);
 }
+void FileFormatDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	codeStream->getTileCacheStats(stats);
+}
 bool FileFormatDecompress::readHeaderProcedureImpl(void)
 {
 	FileFormatBox box;
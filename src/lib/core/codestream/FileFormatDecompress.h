@@ -35,12 +35,17 @@ class FileFormatDecompress : public FileFormat, public ICodeStreamDecompress
 	GrkImage* getImage(void);
 	void init(grk_decompress_core_params* p_param);
 	bool setDecompressRegion(grk_rect_single region);
+	bool setDecompressRegion(uint8_t reduce, grk_rect32 region);
+	bool decompressWindows(const grk_decompress_window* windows, uint32_t numWindows,
+						   grk_decompress_window_callback callback, void* userData);
+	bool setReduce(uint8_t reduce);
 	bool decompress(grk_plugin_tile* tile);
 	bool decompressTile(uint16_t tileIndex);
 	bool end(void);
 	bool postProcess(void);
 	bool preProcess(void);
 	void dump(uint32_t flag, FILE* outputFileStream);
+	void getTileCacheStats(grk_tile_cache_stats* stats);
 
   private:
 	grk_color* getColour(void);
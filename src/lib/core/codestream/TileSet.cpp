@@ -18,6 +18,7 @@ void TileSet::init(grk_rect16 allTiles)
 void TileSet::schedule(grk_rect16 tiles)
 {
 	tilesToDecompress_.clear();
+	tilesDecompressed_.clear();
 	assert(!tiles.empty());
 	for(uint16_t j = tiles.y0; j < tiles.y1; ++j)
 	{
@@ -33,9 +34,19 @@ void TileSet::schedule(grk_pt16 tile)
 void TileSet::schedule(uint16_t tileIndex)
 {
 	tilesToDecompress_.clear();
+	tilesDecompressed_.clear();
 	tilesToDecompress_.insert(tileIndex);
 	lastTileToDecompress_ = tileIndex;
 }
+void TileSet::unschedule(uint16_t tileIndex)
+{
+	tilesToDecompress_.erase(tileIndex);
+	tilesDecompressed_.erase(tileIndex);
+}
+void TileSet::clearComplete(void)
+{
+	tilesDecompressed_.clear();
+}
 bool TileSet::isScheduled(uint16_t tileIndex)
 {
 	return tilesToDecompress_.contains(tileIndex);
@@ -15,6 +15,8 @@ class TileSet
 	void schedule(grk_rect16 tiles);
 	void schedule(grk_pt16 tile);
 	void schedule(uint16_t tileIndex);
+	void unschedule(uint16_t tileIndex);
+	void clearComplete(void);
 	bool isScheduled(uint16_t tileIndex);
 	bool isScheduled(grk_pt16 tile);
 	void setComplete(uint16_t tileIndex);
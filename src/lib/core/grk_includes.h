@@ -104,6 +104,7 @@
 #include "GrkMatrix.h"
 #include "GrkImage.h"
 #include "StripCache.h"
+#include "StripSource.h"
 #include "grk_exceptions.h"
 #include "SparseBuffer.h"
 #include "BitIO.h"
@@ -126,6 +127,7 @@
 #include "TagTree.h"
 #include "t1_common.h"
 #include "T1Interface.h"
+#include "T1Pool.h"
 #include "Codeblock.h"
 #include "PacketParser.h"
 #include "ResSimple.h"
@@ -135,6 +137,7 @@
 #include "BlockExec.h"
 #include "ImageComponentFlow.h"
 #include "Scheduler.h"
+#include "BoundedExecutor.h"
 #include "SparseCanvas.h"
 #include "TileComponentWindow.h"
 #include "WaveletCommon.h"
@@ -153,6 +156,7 @@
 #include "plugin_bridge.h"
 #include "RateControl.h"
 #include "RateInfo.h"
+#include "PacketSizeEstimator.h"
 #include "T1Factory.h"
 #include "DecompressScheduler.h"
 #include "CompressScheduler.h"
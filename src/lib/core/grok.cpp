@@ -399,6 +399,43 @@ bool GRK_CALLCONV grk_decompress_set_window(grk_codec* codecWrapper, float start
 	}
 	return false;
 }
+bool GRK_CALLCONV grk_decompress_set_reduce(grk_codec* codecWrapper, uint8_t reduce)
+{
+	if(codecWrapper)
+	{
+		auto codec = GrkCodec::getImpl(codecWrapper);
+		return codec->decompressor_ ? codec->decompressor_->setReduce(reduce) : false;
+	}
+	return false;
+}
+grk_image* GRK_CALLCONV grk_decompress_region(grk_codec* codecWrapper, uint8_t reduce,
+											  uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+	if(!codecWrapper)
+		return nullptr;
+	auto codec = GrkCodec::getImpl(codecWrapper);
+	auto decompressor = codec->decompressor_;
+	if(!decompressor || !decompressor->setDecompressRegion(reduce, grk_rect32(x0, y0, x1, y1)))
+		return nullptr;
+	if(!decompressor->decompress(nullptr) || !decompressor->postProcess())
+		return nullptr;
+
+	return grk_decompress_get_composited_image(codecWrapper);
+}
+bool GRK_CALLCONV grk_decompress_windows(grk_codec* codecWrapper,
+										 const grk_decompress_window* windows, uint32_t numWindows,
+										 grk_decompress_window_callback callback, void* user_data)
+{
+	if(codecWrapper)
+	{
+		auto codec = GrkCodec::getImpl(codecWrapper);
+		return codec->decompressor_
+				   ? codec->decompressor_->decompressWindows(windows, numWindows, callback,
+															 user_data)
+				   : false;
+	}
+	return false;
+}
 bool GRK_CALLCONV grk_decompress(grk_codec* codecWrapper, grk_plugin_tile* tile)
 {
 	if(codecWrapper)
@@ -472,6 +509,21 @@ grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_codec* codecWrapper, u
 	return nullptr;
 }
 
+bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codecWrapper,
+													  grk_tile_cache_stats* stats)
+{
+	if(codecWrapper && stats)
+	{
+		auto codec = GrkCodec::getImpl(codecWrapper);
+		if(codec->decompressor_)
+		{
+			codec->decompressor_->getTileCacheStats(stats);
+			return true;
+		}
+	}
+	return false;
+}
+
 grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* codecWrapper)
 {
 	if(codecWrapper)
@@ -648,6 +700,7 @@ static grk_stream* grk_stream_create_stream(grk_stream_params* stream_params)
 	grk_stream_set_read_function(stream, stream_params->read_fn);
 	grk_stream_set_write_function(stream, stream_params->write_fn);
 	grk_stream_set_seek_function(stream, stream_params->seek_fn);
+	grk_stream_set_pread_function(stream, stream_params->pread_fn);
 
 	return stream;
 }
@@ -977,6 +1030,13 @@ void grk_stream_set_seek_function(grk_stream* stream, grk_stream_seek_fn func)
 	if(streamImpl)
 		streamImpl->setSeekFunction(func);
 }
+void grk_stream_set_pread_function(grk_stream* stream, grk_stream_pread_fn func)
+{
+	auto streamImpl = BufferedStream::getImpl(stream);
+	if((!streamImpl) || (!(streamImpl->getStatus() & GROK_STREAM_STATUS_INPUT)))
+		return;
+	streamImpl->setPositionalReadFunction(func);
+}
 void grk_stream_set_write_function(grk_stream* stream, grk_stream_write_fn func)
 {
 	auto streamImpl = BufferedStream::getImpl(stream);
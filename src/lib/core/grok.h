@@ -212,11 +212,15 @@ typedef struct _grk_raw_cparameters
  * Rate control algorithms
 	GRK_RATE_CONTROL_BISECT: bisect with all truncation points
 	GRK_RATE_CONTROL_PCRD_OPT: bisect with only feasible truncation points
+	GRK_RATE_CONTROL_PCRD_OPT_GLOBAL: as above, with a single slope threshold per layer
+	shared by all tiles, so that bytes go to the tiles that benefit most. All tiles are held
+	in memory until their T1 has completed.
  */
 typedef enum _GRK_RATE_CONTROL_ALGORITHM
 {
 	GRK_RATE_CONTROL_BISECT,
-	GRK_RATE_CONTROL_PCRD_OPT
+	GRK_RATE_CONTROL_PCRD_OPT,
+	GRK_RATE_CONTROL_PCRD_OPT_GLOBAL
 } GRK_RATE_CONTROL_ALGORITHM;
 
 /**
@@ -511,6 +515,20 @@ typedef size_t (*grk_stream_write_fn)(const uint8_t* buffer, size_t numBytes, vo
  */
 typedef bool (*grk_stream_seek_fn)(uint64_t offset, void* user_data);
 
+/**
+ * positional read callback : read from an absolute stream offset, without
+ * changing the position used by the read and seek callbacks. It may be called
+ * concurrently from several threads.
+ *
+ * @buffer buffer to read into
+ * @numBytes number of bytes to read
+ * @offset absolute stream offset
+ * @user_data user data
+ *
+ */
+typedef size_t (*grk_stream_pread_fn)(uint8_t* buffer, size_t numBytes, uint64_t offset,
+									  void* user_data);
+
 /**
  * free user data callback
  *
@@ -540,6 +558,10 @@ typedef struct _grk_stream_params
 	grk_stream_read_fn read_fn;
 	grk_stream_write_fn write_fn;
 	grk_stream_seek_fn seek_fn;
+	/* optional : when the code stream has TLM markers, tile part data that
+	 * is not already buffered (see double_buffer_len) is read with this function
+	 * by the threads that decompress the tiles */
+	grk_stream_pread_fn pread_fn;
 	grk_stream_free_user_data_fn free_user_data_fn; // optional
 	void* user_data;
 	size_t stream_len; // must be set for read stream
@@ -549,9 +571,41 @@ typedef struct _grk_stream_params
 typedef enum _GRK_TILE_CACHE_STRATEGY
 {
 	GRK_TILE_CACHE_NONE, /* no tile caching */
-	GRK_TILE_CACHE_IMAGE /* cache final tile image */
+	GRK_TILE_CACHE_IMAGE, /* cache final tile image */
+	GRK_TILE_CACHE_LRU, /* cache final tile image, evicting least recently used
+						  tiles once the cache exceeds its memory budget */
+	GRK_TILE_CACHE_PACKETS, /* cache parsed packets (code block segments and compressed tile data),
+							  so that later decompressions of a tile with a different window
+							  or resolution reduction skip packet parsing */
+	GRK_TILE_CACHE_BLOCKS /* cache parsed packets and decompressed code blocks, so that
+							 progressively decompressing a tile at higher resolutions only
+							 decompresses code blocks of the newly added resolutions */
 } GRK_TILE_CACHE_STRATEGY;
 
+/**
+ * Part 1 code block decoder engine
+ */
+typedef enum _GRK_T1_DECODER
+{
+	GRK_T1_DECODER_LUT, /* table-driven MQ decoder (default) */
+	GRK_T1_DECODER_REFERENCE /* symbol-at-a-time reference MQ decoder : output is identical
+								to GRK_T1_DECODER_LUT, so it is only useful for benchmarking */
+} GRK_T1_DECODER;
+
+/**
+ * Tile cache statistics
+ */
+typedef struct _grk_tile_cache_stats
+{
+	uint64_t hits; /* tile requests served from the cache */
+	uint64_t misses; /* tile requests that needed decompression */
+	uint64_t evictions; /* tiles evicted to stay within budget */
+	uint32_t numTiles; /* number of tiles currently cached */
+	uint64_t bytes; /* bytes held by cached tiles: image data, compressed tile data
+					   and decompressed code blocks */
+	uint64_t budget; /* memory budget in bytes (0 => unbounded) */
+} grk_tile_cache_stats;
+
 /**
  * Core decompression parameters
  * */
@@ -573,8 +627,19 @@ typedef struct _grk_decompress_core_params
 	 */
 	uint16_t layers_to_decompress_;
 	GRK_TILE_CACHE_STRATEGY tileCacheStrategy;
+	/* memory budget in bytes for GRK_TILE_CACHE_LRU, GRK_TILE_CACHE_PACKETS
+	   and GRK_TILE_CACHE_BLOCKS strategies (0 => unbounded) */
+	uint64_t tileCacheBudget;
 
 	uint32_t randomAccessFlags_;
+	/**
+	 Maximum number of threads from the library's shared thread pool
+	 (see grk_initialize) that may decompress tiles concurrently for this codec.
+	 No new threads are created. If zero, the entire pool may be used.
+	 */
+	uint32_t numThreads;
+	/* Part 1 code block decoder engine */
+	GRK_T1_DECODER t1Decoder;
 
 	grk_io_pixels_callback io_buffer_callback;
 	void* io_user_data;
@@ -721,6 +786,18 @@ typedef struct _grk_image
 	grk_image_comp* comps;
 } grk_image;
 
+/**
+ * Pull callback for strip-based compression (see grk_cparameters::io_pull_callback)
+ *
+ * @param strip 		strip to fill. Strip bounds, component dimensions and component
+ * 						offsets are set, and component data is allocated, by the library.
+ * 						Component rows are in the range [comp->y0, comp->y0 + comp->h)
+ * @param user_data 	user data
+ *
+ * @return true if the strip was successfully filled
+ */
+typedef bool (*grk_io_pull_callback)(grk_image* strip, void* user_data);
+
 /*************************************************
 Structs to pass data between grok and plugin
 ************************************************/
@@ -923,6 +1000,20 @@ GRK_API bool GRK_CALLCONV grk_decompress_read_header(grk_codec* codec,
  */
 GRK_API grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_codec* codec, uint16_t tileIndex);
 
+/**
+ * Get tile cache statistics
+ *
+ * Note: with GRK_TILE_CACHE_LRU strategy, a tile image returned by
+ * grk_decompress_get_tile_image may be evicted by the next call to grk_decompress_tile
+ *
+ * @param	codec				decompression codec
+ * @param	stats				tile cache statistics
+ *
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codec,
+															  grk_tile_cache_stats* stats);
+
 /**
  * Get decompressed composite image
  *
@@ -935,6 +1026,9 @@ GRK_API grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* c
 /**
  * Set the given area to be decompressed. This function should be called
  * right after grk_decompress_read_header is called, and before any tile header is read.
+ * It may also be called after grk_decompress, to decompress a different area of the
+ * same code stream; with GRK_TILE_CACHE_PACKETS strategy, packets of previously
+ * decompressed tiles are not parsed again.
  *
  * @param	codec			decompression codec
  * @param	start_x		    left position of the rectangle to decompress (in image coordinates).
@@ -948,6 +1042,94 @@ GRK_API grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* c
 GRK_API bool GRK_CALLCONV grk_decompress_set_window(grk_codec* codec, float start_x, float start_y,
 													float end_x, float end_y);
 
+/**
+ * Set resolution reduction for subsequent decompression. This function may be called
+ * after grk_decompress_read_header, and also between calls to grk_decompress, in which case
+ * the code stream is decompressed again at the new reduction.
+ *
+ * Note: a decompress window set by grk_decompress_set_window is expressed in full
+ * resolution image coordinates, and is not affected by the reduction.
+ *
+ * @param	codec			decompression codec
+ * @param	reduce			number of highest resolution levels to discard
+ *
+ * @return	true			if reduction is valid for all tile components
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_set_reduce(grk_codec* codec, uint8_t reduce);
+
+/**
+ * Decompress a region of the image at a given resolution reduction.
+ *
+ * The codec can be used as a virtual image, from which arbitrary regions are
+ * requested in any order: with GRK_TILE_CACHE_BLOCKS strategy, code blocks decompressed
+ * for earlier regions are kept, so overlapping requests only decompress code blocks
+ * that have not already been decompressed. Cached tiles are evicted, least recently used
+ * first, once the cache exceeds its memory budget.
+ *
+ * @param	codec			decompression codec
+ * @param	reduce			number of highest resolution levels to discard
+ * @param	x0				left edge of region, in reduced image coordinates,
+ * 							relative to reduced image origin
+ * @param	y0				top edge of region
+ * @param	x1				right edge of region (exclusive)
+ * @param	y1				bottom edge of region (exclusive)
+ *
+ * @return	decompressed region, valid until the next decompression on this codec,
+ * 			or NULL on failure
+ */
+GRK_API grk_image* GRK_CALLCONV grk_decompress_region(grk_codec* codec, uint8_t reduce,
+													  uint32_t x0, uint32_t y0, uint32_t x1,
+													  uint32_t y1);
+
+/**
+ * Window for batch decompression (see grk_decompress_windows)
+ */
+typedef struct _grk_decompress_window
+{
+	uint8_t reduce; /* number of highest resolution levels to discard */
+	/* window bounds in reduced image coordinates, relative to reduced image origin */
+	uint32_t x0;
+	uint32_t y0;
+	uint32_t x1;
+	uint32_t y1;
+} grk_decompress_window;
+
+/**
+ * Callback for batch decompression (see grk_decompress_windows)
+ *
+ * @param windowIndex 	index of window in window array
+ * @param image 		decompressed window, valid until the callback returns
+ * @param user_data 	user data
+ *
+ * @return true if the window was successfully consumed
+ */
+typedef bool (*grk_decompress_window_callback)(uint32_t windowIndex, grk_image* image,
+											   void* user_data);
+
+/**
+ * Decompress a batch of windows in a single pass over the code stream.
+ *
+ * Windows are decompressed in tile order, rather than in array order, and code blocks
+ * are retained for the duration of the batch, so a code block shared by several
+ * windows is only decompressed once. If the cache exceeds its memory budget, code blocks
+ * of least recently used tiles are discarded and may be decompressed again by a later window.
+ * Once the batch completes, retained code blocks are released,
+ * unless codec uses GRK_TILE_CACHE_BLOCKS strategy.
+ *
+ * @param	codec			decompression codec
+ * @param	windows			array of windows
+ * @param	numWindows		number of windows
+ * @param	callback		called with each decompressed window
+ * @param	user_data		user data passed to callback
+ *
+ * @return	true if all windows were decompressed and consumed by callback
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_windows(grk_codec* codec,
+												 const grk_decompress_window* windows,
+												 uint32_t numWindows,
+												 grk_decompress_window_callback callback,
+												 void* user_data);
+
 /**
  * Decompress image from a JPEG 2000 code stream
  *
@@ -1088,7 +1270,27 @@ typedef struct _grk_cparameters
 	bool apply_icc_;
 
 	GRK_RATE_CONTROL_ALGORITHM rateControlAlgorithm;
+	/* for lossy compression to target rates, estimate the final rate-distortion slope
+	 * threshold of each tile from a sample of its code blocks, and stop coding the
+	 * remaining code blocks once their bit planes fall well below this threshold.
+	 * A tile is coded again in full if the estimate proves too aggressive.
+	 * Ignored for HTJ2K, fixed quality and global rate control */
+	bool earlyTermination;
+	/* maximum number of threads from the library's shared thread pool
+	 * that may compress tiles concurrently (0 => entire pool) */
 	uint32_t numThreads;
+	/* maximum number of tiles held in memory between the start of their compression
+	 * and the writing of their tile parts. Tile parts are written in tile order as
+	 * soon as all preceding tiles have been written, so this bounds peak memory
+	 * for images with many tiles (0 => two tiles per thread) */
+	uint32_t maxTilesInFlight;
+	/* if set, the image passed to grk_compress_init need not contain pixel data:
+	 * instead, pixels are pulled from the client, one tile row at a time, through this
+	 * callback, and each strip is released once all tiles in its row have been ingested.
+	 * Combined with maxTilesInFlight, this bounds source memory to a few tile rows.
+	 * Note: ICC profile is not applied to pulled strips */
+	grk_io_pull_callback io_pull_callback;
+	void* io_pull_user_data;
 	int32_t deviceId;
 	uint32_t duration; /* seconds */
 	uint32_t kernelBuildOptions;
@@ -46,6 +46,14 @@ void grk_stream_set_write_function(grk_stream* stream, grk_stream_write_fn func)
  */
 void grk_stream_set_seek_function(grk_stream* stream, grk_stream_seek_fn func);
 
+/**
+ * Set positional read function (optional)
+ *
+ * @param       stream      JPEG 2000 stream
+ * @param       func        positional read function : must be thread safe
+ */
+void grk_stream_set_pread_function(grk_stream* stream, grk_stream_pread_fn func);
+
 /**
  * Set user data for JPEG 2000 stream
  *
@@ -332,7 +332,7 @@ namespace HWY_NAMESPACE
 			}
 			if(tasks)
 			{
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] tasks;
 			}
 		}
@@ -427,9 +427,10 @@ void mct::decompress_dc_shift_rev(FlowComponent* flow, uint16_t compno)
 void mct::decompress_irrev(FlowComponent* flow)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
-	hwy::DisableTargets(uint32_t(~HWY_SCALAR));
 	genShift(1, info.shiftInfo);
-	HWY_DYNAMIC_DISPATCH(hwy_decompress_irrev)
+	// static dispatch, rather than disabling targets, which would also
+	// disable vector routines for every other dynamically dispatched stage
+	HWY_STATIC_DISPATCH(hwy_decompress_irrev)
 	(info);
 }
 
@@ -0,0 +1,106 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+namespace grk
+{
+BoundedExecutor::BoundedExecutor(uint32_t maxConcurrency, uint32_t maxInFlight)
+	: executor_(ExecSingleton::get()), maxConcurrency_(maxConcurrency ? maxConcurrency : 1),
+	  maxInFlight_(std::max<uint32_t>(maxInFlight, maxConcurrency_)), inFlight_(0), running_(0)
+{}
+BoundedExecutor::~BoundedExecutor()
+{
+	wait();
+}
+uint32_t BoundedExecutor::getMaxConcurrency(void) const
+{
+	return maxConcurrency_;
+}
+uint32_t BoundedExecutor::getMaxInFlight(void) const
+{
+	return maxInFlight_;
+}
+void BoundedExecutor::submit(std::function<void(void)> job)
+{
+	bool launch = false;
+	// a pool worker must not block on the condition variable,
+	// so it helps execute pending work instead
+	if(isWorker())
+		executor_->corun_until([this] {
+			std::unique_lock<std::mutex> lk(mutex_);
+			return inFlight_ < maxInFlight_;
+		});
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		cv_.wait(lk, [this] { return inFlight_ < maxInFlight_; });
+		inFlight_++;
+		jobs_.push(std::move(job));
+		if(running_ < maxConcurrency_)
+		{
+			running_++;
+			launch = true;
+		}
+	}
+	if(launch)
+		spawn();
+}
+bool BoundedExecutor::isWorker(void)
+{
+	return executor_->this_worker_id() >= 0;
+}
+void BoundedExecutor::wait(void)
+{
+	if(isWorker())
+		executor_->corun_until([this] {
+			std::unique_lock<std::mutex> lk(mutex_);
+			return inFlight_ == 0 && running_ == 0;
+		});
+	std::unique_lock<std::mutex> lk(mutex_);
+	cv_.wait(lk, [this] { return inFlight_ == 0 && running_ == 0; });
+}
+void BoundedExecutor::spawn(void)
+{
+	executor_->silent_async([this] { next(); });
+}
+void BoundedExecutor::next(void)
+{
+	std::function<void(void)> job;
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		if(jobs_.empty())
+		{
+			running_--;
+			// notify while holding the lock: once wait() returns,
+			// this object may be destroyed
+			cv_.notify_all();
+			return;
+		}
+		job = std::move(jobs_.front());
+		jobs_.pop();
+	}
+	job();
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		inFlight_--;
+		cv_.notify_all();
+	}
+	// re-submit rather than loop, so that a worker which picked up this job
+	// while co-running a nested task graph returns to that graph promptly
+	spawn();
+}
+
+} // namespace grk
@@ -0,0 +1,70 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <functional>
+
+namespace grk
+{
+/**
+ * Submits tile-level jobs to the shared executor (see ExecSingleton)
+ * on behalf of a single compress or decompress call.
+ *
+ * No threads are created: at most maxConcurrency jobs run at the same time
+ * on the shared pool, and the producer blocks in submit() while maxInFlight
+ * jobs have been submitted but have not yet completed.
+ */
+class BoundedExecutor
+{
+  public:
+	BoundedExecutor(uint32_t maxConcurrency, uint32_t maxInFlight);
+	~BoundedExecutor();
+	/**
+	 * Queue a job for execution, blocking while the in-flight window is full
+	 *
+	 * @param job job to execute
+	 */
+	void submit(std::function<void(void)> job);
+	/**
+	 * Block until all submitted jobs have completed
+	 */
+	void wait(void);
+	uint32_t getMaxConcurrency(void) const;
+	uint32_t getMaxInFlight(void) const;
+
+  private:
+	bool isWorker(void);
+	void spawn(void);
+	void next(void);
+
+	tf::Executor* executor_;
+	uint32_t maxConcurrency_;
+	uint32_t maxInFlight_;
+	// jobs that have been submitted but not yet completed
+	uint32_t inFlight_;
+	// jobs currently executing on the pool
+	uint32_t running_;
+	std::queue<std::function<void(void)>> jobs_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+};
+
+} // namespace grk
@@ -19,10 +19,12 @@
 
 namespace grk
 {
-CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-									 const double* mct_norms, uint16_t mct_numcomps)
-	: Scheduler(tile), tile(tile), needsRateControl(needsRateControl), encodeBlocks(nullptr),
-	  blockCount(-1), tcp_(tcp), mct_norms_(mct_norms), mct_numcomps_(mct_numcomps)
+CompressScheduler::CompressScheduler(Tile* tile, T1Pool* t1Pool, bool needsRateControl,
+									 TileCodingParams* tcp, const double* mct_norms,
+									 uint16_t mct_numcomps, uint64_t truncationBudget)
+	: Scheduler(tile, t1Pool), tile(tile), needsRateControl(needsRateControl),
+	  encodeBlocks(nullptr), blockCount(-1), tcp_(tcp), t1Coders_(nullptr), mct_norms_(mct_norms),
+	  mct_numcomps_(mct_numcomps), truncationBudget_(truncationBudget), truncationThresh_(0)
 {
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
 	{
@@ -30,6 +32,10 @@ CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodi
 		imageComponentFlows_[compno] = new ImageComponentFlow(numResolutions);
 	}
 }
+uint16_t CompressScheduler::getTruncationThresh(void)
+{
+	return truncationThresh_;
+}
 bool CompressScheduler::schedule(uint16_t compno)
 {
 	return scheduleBlocks(compno);
@@ -76,6 +82,7 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 						maxCblkH = std::max<uint32_t>(maxCblkH, (uint32_t)(1 << tccp->cblkh));
 						block->compno = compno;
 						block->bandOrientation = band->orientation;
+						block->bandNumbps = band->numbps;
 						block->cblk = cblk;
 						block->cblk_sty = tccp->cblk_sty;
 						block->qmfbid = tccp->qmfbid;
@@ -91,13 +98,103 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 			}
 		}
 	}
-	for(auto i = 0U; i < ExecSingleton::get()->num_workers(); ++i)
-		t1Implementations.push_back(T1Factory::makeT1(true, tcp_, maxCblkW, maxCblkH));
+	if(!blocks.empty())
+		t1Coders_ = t1Pool_->get(true, tcp_, maxCblkW, maxCblkH);
+	if(truncationBudget_ && !blocks.empty())
+		predictTruncation(&blocks);
 	compress(&blocks);
 
 	return true;
 }
 
+void CompressScheduler::predictTruncation(std::vector<CompressBlockExec*>* blocks)
+{
+	// one in every sampleStride blocks of a band is sampled
+	const size_t sampleStride = 4;
+	// safety margin below predicted threshold : 256 halves the slope
+	const uint16_t slopeMargin = 512;
+
+	std::vector<CompressBlockExec*> samples;
+	std::vector<CompressBlockExec*> others;
+	// sampled blocks, weighted by band area over sampled band area
+	std::vector<std::pair<CompressCodeblock*, double>> weightedSamples;
+	auto sameBand = [](CompressBlockExec* a, CompressBlockExec* b) {
+		return a->compno == b->compno && a->resno == b->resno &&
+			   a->bandOrientation == b->bandOrientation;
+	};
+	size_t bandBegin = 0;
+	for(size_t i = 1; i <= blocks->size(); ++i)
+	{
+		if(i < blocks->size() && sameBand((*blocks)[bandBegin], (*blocks)[i]))
+			continue;
+		uint64_t area = 0;
+		uint64_t sampledArea = 0;
+		for(size_t j = bandBegin; j < i; ++j)
+		{
+			uint64_t blockArea = (*blocks)[j]->cblk->area();
+			area += blockArea;
+			if((j - bandBegin) % sampleStride == 0)
+				sampledArea += blockArea;
+		}
+		double weight = (double)area / (double)sampledArea;
+		for(size_t j = bandBegin; j < i; ++j)
+		{
+			auto block = (*blocks)[j];
+			if((j - bandBegin) % sampleStride == 0)
+			{
+				samples.push_back(block);
+				weightedSamples.push_back(std::make_pair(block->cblk, weight));
+			}
+			else
+			{
+				others.push_back(block);
+			}
+		}
+		bandBegin = i;
+	}
+	compress(&samples);
+
+	// weighted rate increments at feasible truncation points of sampled blocks
+	std::vector<std::pair<uint16_t, double>> increments;
+	for(auto& sample : weightedSamples)
+	{
+		auto cblk = sample.first;
+		RateControl::convexHull(cblk->passes, cblk->numPassesTotal);
+		uint32_t rate = 0;
+		for(uint32_t passno = 0; passno < cblk->numPassesTotal; ++passno)
+		{
+			auto pass = cblk->passes + passno;
+			if(!pass->slope)
+				continue;
+			increments.push_back(std::make_pair(pass->slope, sample.second * (pass->rate - rate)));
+			rate = pass->rate;
+		}
+	}
+	std::sort(increments.begin(), increments.end(),
+			  [](const std::pair<uint16_t, double>& a, const std::pair<uint16_t, double>& b) {
+				  return a.first > b.first;
+			  });
+	// predicted threshold is the slope of the first increment that exceeds the budget
+	double bytes = 0;
+	uint16_t thresh = 0;
+	for(auto& inc : increments)
+	{
+		bytes += inc.second;
+		if(bytes > (double)truncationBudget_)
+		{
+			thresh = inc.first;
+			break;
+		}
+	}
+	if(thresh > slopeMargin)
+	{
+		truncationThresh_ = (uint16_t)(thresh - slopeMargin);
+		double truncationSlope = RateControl::slopeFromLog(truncationThresh_);
+		for(auto block : others)
+			block->truncationSlope = truncationSlope;
+	}
+	*blocks = others;
+}
 void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 {
 	if(!blocks || blocks->size() == 0)
@@ -106,7 +203,7 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 	size_t num_threads = ExecSingleton::get()->num_workers();
 	if(num_threads == 1)
 	{
-		auto impl = t1Implementations[0];
+		auto impl = (*t1Coders_)[0];
 		for(auto iter = blocks->begin(); iter != blocks->end(); ++iter)
 		{
 			compress(impl, *iter);
@@ -115,6 +212,7 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 		return;
 	}
 	const size_t maxBlocks = blocks->size();
+	blockCount = -1;
 	encodeBlocks = new CompressBlockExec*[maxBlocks];
 	for(uint64_t i = 0; i < maxBlocks; ++i)
 		encodeBlocks[i] = blocks->operator[](i);
@@ -134,14 +232,14 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 			}
 		});
 	}
-	ExecSingleton::get()->run(taskflow).wait();
+	ExecSingleton::run(taskflow);
 
 	delete[] node;
 	delete[] encodeBlocks;
 }
 bool CompressScheduler::compress(size_t threadId, uint64_t maxBlocks)
 {
-	auto impl = t1Implementations[threadId];
+	auto impl = (*t1Coders_)[threadId];
 	uint64_t index = (uint64_t)++blockCount;
 	if(index >= maxBlocks)
 		return false;
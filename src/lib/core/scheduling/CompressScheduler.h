@@ -21,14 +21,28 @@ namespace grk
 class CompressScheduler : public Scheduler
 {
   public:
-	CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-					  const double* mct_norms, uint16_t mct_numcomps);
+	CompressScheduler(Tile* tile, T1Pool* t1Pool, bool needsRateControl, TileCodingParams* tcp,
+					  const double* mct_norms, uint16_t mct_numcomps, uint64_t truncationBudget);
 	~CompressScheduler() = default;
 	bool schedule(uint16_t compno) override;
+	/**
+	 * Get slope threshold below which code blocks were truncated
+	 *
+	 * @return threshold, or 0 if no code blocks were truncated
+	 */
+	uint16_t getTruncationThresh(void);
 
   private:
 	bool scheduleBlocks(uint16_t compno);
 	void compress(std::vector<CompressBlockExec*>* blocks);
+	/**
+	 * Compress a sample of blocks from each band, and use them to predict the slope
+	 * threshold at which the tile meets its budget. The other blocks are truncated
+	 * well below this threshold.
+	 *
+	 * @param blocks all blocks : on return, the blocks that remain to be compressed
+	 */
+	void predictTruncation(std::vector<CompressBlockExec*>* blocks);
 	bool compress(size_t threadId, uint64_t maxBlocks);
 	void compress(T1Interface* impl, CompressBlockExec* block);
 
@@ -38,8 +52,13 @@ class CompressScheduler : public Scheduler
 	CompressBlockExec** encodeBlocks;
 	std::atomic<int64_t> blockCount;
 	TileCodingParams* tcp_;
+	// one coder per worker
+	std::vector<T1Interface*>* t1Coders_;
 	const double* mct_norms_;
 	uint16_t mct_numcomps_;
+	// if non-zero, byte budget of tile, used to predict truncation of code passes
+	uint64_t truncationBudget_;
+	uint16_t truncationThresh_;
 };
 
 } // namespace grk
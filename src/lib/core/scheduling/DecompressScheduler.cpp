@@ -37,7 +37,7 @@ void ResDecompressBlocks::release(void)
 
 DecompressScheduler::DecompressScheduler(TileProcessor* tileProcessor, Tile* tile,
 										 TileCodingParams* tcp, uint8_t prec)
-	: Scheduler(tile), tileProcessor_(tileProcessor), tcp_(tcp), prec_(prec),
+	: Scheduler(tile, tileProcessor->getT1Pool()), tileProcessor_(tileProcessor), tcp_(tcp), prec_(prec),
 	  numcomps_(tile->numcomps_), tileBlocks_(TileDecompressBlocks(numcomps_)),
 	  waveletReverse_(nullptr)
 {
@@ -125,6 +125,8 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 						block->qmfbid = tccp->qmfbid;
 						block->resno = resno;
 						block->roishift = tccp->roishift;
+						block->retainSegments = tileProcessor_->retainsPackets();
+						block->retainDecompressed = tileProcessor_->retainsBlocks();
 						block->stepsize = band->stepsize;
 						block->k_msbs = (uint8_t)(band->numbps - cblk->numbps);
 						block->R_b = prec_ + gain_b[band->orientation];
@@ -159,9 +161,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 	// nominal code block dimensions
 	uint16_t codeblock_width = (uint16_t)(tccp->cblkw ? (uint32_t)1 << tccp->cblkw : 0);
 	uint16_t codeblock_height = (uint16_t)(tccp->cblkh ? (uint32_t)1 << tccp->cblkh : 0);
-	for(auto i = 0U; i < ExecSingleton::get()->num_workers(); ++i)
-		t1Implementations.push_back(
-			T1Factory::makeT1(false, tcp_, codeblock_width, codeblock_height));
+	auto t1Coders = t1Pool_->get(false, tcp_, codeblock_width, codeblock_height);
 
 	size_t num_threads = ExecSingleton::get()->num_workers();
 	success = true;
@@ -177,8 +177,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 				}
 				else
 				{
-					auto impl = t1Implementations[(size_t)0];
-					if(!decompressBlock(impl, block))
+					if(!decompressBlock((*t1Coders)[0], block))
 						success = false;
 				}
 			}
@@ -192,7 +191,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 		auto resFlow = imageComponentFlows_[compno]->resFlows_ + resFlowNum;
 		for(auto& block : rb.blocks_)
 		{
-			resFlow->blocks_->nextTask().work([this, block] {
+			resFlow->blocks_->nextTask().work([this, t1Coders, block] {
 				if(!success)
 				{
 					delete block;
@@ -200,8 +199,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 				else
 				{
 					auto threadnum = ExecSingleton::get()->this_worker_id();
-					auto impl = t1Implementations[(size_t)threadnum];
-					if(!decompressBlock(impl, block))
+					if(!decompressBlock((*t1Coders)[(size_t)threadnum], block))
 						success = false;
 				}
 			});
@@ -61,8 +61,12 @@ ResFlow* ResFlow::addTo(tf::Taskflow& composition)
 ResFlow* ResFlow::precede(ResFlow* successor)
 {
 	assert(successor);
+	// successor's code blocks lie outside of this resolution, so they can be
+	// decompressed while this resolution's wavelet transform is in progress:
+	// only the successor's wavelet transform needs to wait
 	if(doWavelet_)
-		waveletVert_->precede(successor->blocks_);
+		waveletVert_->precede(successor->doWavelet_ ? successor->waveletHoriz_
+													: successor->blocks_);
 
 	return this;
 }
@@ -18,8 +18,8 @@
 
 namespace grk
 {
-Scheduler::Scheduler(Tile* tile)
-	: success(true), tile_(tile), numcomps_(tile->numcomps_), prePostProc_(nullptr)
+Scheduler::Scheduler(Tile* tile, T1Pool* t1Pool)
+	: success(true), t1Pool_(t1Pool), tile_(tile), numcomps_(tile->numcomps_), prePostProc_(nullptr)
 {
 	imageComponentFlows_ = new ImageComponentFlow*[numcomps_];
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
@@ -30,13 +30,11 @@ Scheduler::~Scheduler()
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
 		delete imageComponentFlows_[compno];
 	delete[] imageComponentFlows_;
-	for(const auto& t : t1Implementations)
-		delete t;
 	delete prePostProc_;
 }
 bool Scheduler::run(void)
 {
-	ExecSingleton::get()->run(codecFlow_).wait();
+	ExecSingleton::run(codecFlow_);
 
 	return success;
 }
@@ -21,7 +21,7 @@ namespace grk
 class Scheduler
 {
   public:
-	Scheduler(Tile* tile);
+	Scheduler(Tile* tile, T1Pool* t1Pool);
 	virtual ~Scheduler();
 
 	virtual bool schedule(uint16_t compno) = 0;
@@ -33,7 +33,7 @@ class Scheduler
 
   protected:
 	std::atomic_bool success;
-	std::vector<T1Interface*> t1Implementations;
+	T1Pool* t1Pool_;
 	ImageComponentFlow** imageComponentFlows_;
 	tf::Taskflow codecFlow_;
 	Tile* tile_;
@@ -44,10 +44,35 @@ class ExecSingleton
 	{
 		return instance(0);
 	}
+	/**
+	 * Run a task graph on the shared executor and wait for it to complete.
+	 *
+	 * When called from one of the executor's own workers (for example
+	 * from a tile-level task), the calling worker co-runs the graph
+	 * rather than blocking, so that nested graphs cannot starve the pool.
+	 */
+	static void run(tf::Taskflow& flow)
+	{
+		auto exec = get();
+		if(exec->this_worker_id() >= 0)
+			exec->corun(flow);
+		else
+			exec->run(flow).wait();
+	}
 	static void release()
 	{
 		get()->shutdown();
 	}
+	/**
+	 * Number of pool threads that a single compress or decompress call may occupy
+	 *
+	 * @param maxThreads per-call cap; zero means the entire pool
+	 */
+	static uint32_t maxConcurrency(uint32_t maxThreads)
+	{
+		auto numWorkers = (uint32_t)get()->num_workers();
+		return maxThreads ? std::min<uint32_t>(maxThreads, numWorkers) : numWorkers;
+	}
 	static uint32_t threadId(void)
 	{
 		return get()->num_workers() > 1 ? (uint32_t)ExecSingleton::get()->this_worker_id() : 0;
@@ -43,7 +43,9 @@ struct BlockExec
 };
 struct DecompressBlockExec : public BlockExec
 {
-	DecompressBlockExec() : cblk(nullptr), resno(0), roishift(0) {}
+	DecompressBlockExec()
+		: cblk(nullptr), resno(0), roishift(0), retainSegments(false), retainDecompressed(false)
+	{}
 	bool open(T1Interface* t1)
 	{
 		return t1->decompress(this);
@@ -52,12 +54,17 @@ struct DecompressBlockExec : public BlockExec
 	DecompressCodeblock* cblk;
 	uint8_t resno;
 	uint8_t roishift;
+	// keep compressed segments after decompression, for later decompressions
+	bool retainSegments;
+	// keep decompressed data, so that later decompressions skip block decoding
+	bool retainDecompressed;
 };
 struct CompressBlockExec : public BlockExec
 {
 	CompressBlockExec()
-		: cblk(nullptr), tile(nullptr), doRateControl(false), distortion(0), tiledp(nullptr),
-		  compno(0), resno(0), precinctIndex(0), cblkno(0), inv_step_ht(0), mct_norms(nullptr),
+		: cblk(nullptr), tile(nullptr), doRateControl(false), truncationSlope(0), distortion(0),
+		  tiledp(nullptr), compno(0), resno(0), precinctIndex(0), cblkno(0), inv_step_ht(0),
+		  mct_norms(nullptr),
 #ifdef DEBUG_LOSSLESS_T1
 		  unencodedData(nullptr),
 #endif
@@ -71,6 +78,9 @@ struct CompressBlockExec : public BlockExec
 	CompressCodeblock* cblk;
 	Tile* tile;
 	bool doRateControl;
+	// if non-zero, coding stops after the first bit plane with a lower
+	// rate-distortion slope
+	double truncationSlope;
 	double distortion;
 	int32_t* tiledp;
 	uint16_t compno;
@@ -0,0 +1,176 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+#include "PostT1DecompressFiltersOJPH.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/OJPH/PostT1DecompressFiltersOJPH.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace ojph
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+	using VecI32 = Vec<HWY_FULL(int32_t)>;
+
+	/**
+	 * Apply vector filter to a row of sign-magnitude code block samples.
+	 * The partial vector at the end of the row is filtered through a scratch
+	 * buffer, so that neither source nor destination is touched beyond the row.
+	 */
+	template<typename F, typename D>
+	void filterRow(F filter, D* dest, const int32_t* src, uint32_t len)
+	{
+		const HWY_FULL(int32_t) di;
+		const HWY_FULL(D) dd;
+		const size_t N = Lanes(di);
+		size_t i = 0;
+		for(; i + N <= len; i += N)
+			StoreU(filter(LoadU(di, src + i)), dd, dest + i);
+		if(i < len)
+		{
+			HWY_ALIGN int32_t in[MaxLanes(di)] = {};
+			HWY_ALIGN D out[MaxLanes(dd)];
+			memcpy(in, src + i, (len - i) * sizeof(int32_t));
+			Store(filter(Load(di, in)), dd, out);
+			memcpy(dest + i, out, (len - i) * sizeof(D));
+		}
+	}
+
+	static HWY_INLINE VecI32 signBit(VecI32 val)
+	{
+		const HWY_FULL(int32_t) di;
+		return And(val, Set(di, (int32_t)0x80000000));
+	}
+	static HWY_INLINE VecI32 magnitude(VecI32 val)
+	{
+		const HWY_FULL(int32_t) di;
+		return And(val, Set(di, 0x7FFFFFFF));
+	}
+
+	// region of interest adjustment, matching the scalar filters
+	static HWY_INLINE VecI32 roiUnshift(VecI32 val, int roiShift)
+	{
+		const HWY_FULL(int32_t) di;
+		auto mag = magnitude(val);
+		auto shifted = And(ShiftRightSame(mag, roiShift), signBit(val));
+		return IfThenElse(mag >= Set(di, 1 << roiShift), shifted, val);
+	}
+
+	// sign-magnitude to two's complement, dropping the shift fractional bits
+	static HWY_INLINE VecI32 toTwosComplement(VecI32 val, int shift)
+	{
+		auto sign = BroadcastSignBit(val);
+		return Sub(Xor(ShiftRightSame(magnitude(val), shift), sign), sign);
+	}
+
+	// sign-magnitude to scaled float
+	static HWY_INLINE Vec<HWY_FULL(float)> toScaledFloat(VecI32 val, float scale)
+	{
+		const HWY_FULL(float) df;
+		auto scaled = Mul(ConvertTo(df, magnitude(val)), Set(df, scale));
+		return Xor(scaled, BitCast(df, signBit(val)));
+	}
+
+	struct Shift
+	{
+		int shift;
+		VecI32 operator()(VecI32 val) const
+		{
+			return toTwosComplement(val, shift);
+		}
+	};
+	struct RoiShift
+	{
+		int roiShift;
+		int shift;
+		VecI32 operator()(VecI32 val) const
+		{
+			return toTwosComplement(roiUnshift(val, roiShift), shift);
+		}
+	};
+	struct Scale
+	{
+		float scale;
+		Vec<HWY_FULL(float)> operator()(VecI32 val) const
+		{
+			return toScaledFloat(val, scale);
+		}
+	};
+	struct RoiScale
+	{
+		int roiShift;
+		float scale;
+		Vec<HWY_FULL(float)> operator()(VecI32 val) const
+		{
+			return toScaledFloat(roiUnshift(val, roiShift), scale);
+		}
+	};
+
+	void hwy_shift_filter(int32_t* dest, const int32_t* src, uint32_t len, uint32_t shift)
+	{
+		filterRow(Shift{(int)shift}, dest, src, len);
+	}
+	void hwy_roi_shift_filter(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+							  uint32_t shift)
+	{
+		filterRow(RoiShift{(int)roiShift, (int)shift}, dest, src, len);
+	}
+	void hwy_scale_filter(float* dest, const int32_t* src, uint32_t len, float scale)
+	{
+		filterRow(Scale{scale}, dest, src, len);
+	}
+	void hwy_roi_scale_filter(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+							  float scale)
+	{
+		filterRow(RoiScale{(int)roiShift, scale}, dest, src, len);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace ojph
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace ojph
+{
+HWY_EXPORT(hwy_shift_filter);
+HWY_EXPORT(hwy_roi_shift_filter);
+HWY_EXPORT(hwy_scale_filter);
+HWY_EXPORT(hwy_roi_scale_filter);
+
+void postT1ShiftOJPH(int32_t* dest, const int32_t* src, uint32_t len, uint32_t shift)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_shift_filter)(dest, src, len, shift);
+}
+void postT1RoiShiftOJPH(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						uint32_t shift)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_roi_shift_filter)(dest, src, len, roiShift, shift);
+}
+void postT1ScaleOJPH(float* dest, const int32_t* src, uint32_t len, float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_scale_filter)(dest, src, len, scale);
+}
+void postT1RoiScaleOJPH(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_roi_scale_filter)(dest, src, len, roiShift, scale);
+}
+
+} // namespace ojph
+#endif
@@ -4,25 +4,27 @@
 
 namespace ojph
 {
+/**
+ * Vectorized row filters for sign-magnitude samples, dispatched to the best
+ * available SIMD target. dest and src may be the same buffer.
+ */
+void postT1ShiftOJPH(int32_t* dest, const int32_t* src, uint32_t len, uint32_t shift);
+void postT1RoiShiftOJPH(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						uint32_t shift);
+void postT1ScaleOJPH(float* dest, const int32_t* src, uint32_t len, float scale);
+void postT1RoiScaleOJPH(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+						float scale);
+
 template<typename T>
 class RoiShiftOJPHFilter
 {
   public:
 	explicit RoiShiftOJPHFilter(grk::DecompressBlockExec* block)
-		: roiShift(block->roishift), shift(31U - (block->k_msbs + 1U))
+		: roiShift(block->roishift), shift(31U - block->bandNumbps)
 	{}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = (val & 0x7FFFFFFF);
-			if(mag >= thresh)
-				val = (T)(((uint32_t)mag >> roiShift) & ((uint32_t)val & 0x80000000));
-			int32_t val_shifted = (val & 0x7FFFFFFF) >> shift;
-			dest[i] = (int32_t)(((uint32_t)val & 0x80000000) ? -val_shifted : val_shifted);
-		}
+		postT1RoiShiftOJPH(dest, src, len, roiShift, shift);
 	}
 
   private:
@@ -33,15 +35,12 @@ template<typename T>
 class ShiftOJPHFilter
 {
   public:
-	explicit ShiftOJPHFilter(grk::DecompressBlockExec* block) : shift(31U - (block->k_msbs + 1U)) {}
+	// the band's most significant bit plane is bit 30 of the decoded sample, whatever
+	// the code block's bit planes, which only locate its least significant bit plane
+	explicit ShiftOJPHFilter(grk::DecompressBlockExec* block) : shift(31U - block->bandNumbps) {}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T val_shifted = (val & 0x7FFFFFFF) >> shift;
-			dest[i] = (T)(((uint32_t)val & 0x80000000) ? -val_shifted : val_shifted);
-		}
+		postT1ShiftOJPH(dest, src, len, shift);
 	}
 
   private:
@@ -60,16 +59,7 @@ class RoiScaleOJPHFilter
 	}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = (T)(val & 0x7FFFFFFF);
-			if(mag >= thresh)
-				val = (T)(((uint32_t)mag >> roiShift) & ((uint32_t)val & 0x80000000));
-			float val_scaled = (float)(val & 0x7FFFFFFF) * scale;
-			((float*)dest)[i] = ((uint32_t)val & 0x80000000) ? -val_scaled : val_scaled;
-		}
+		postT1RoiScaleOJPH((float*)dest, src, len, roiShift, scale);
 	}
 
   private:
@@ -88,12 +78,7 @@ class ScaleOJPHFilter
 	}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			int32_t val = src[i];
-			float val_scaled = (float)(val & 0x7FFFFFFF) * scale;
-			((float*)dest)[i] = ((uint32_t)val & 0x80000000) ? -val_scaled : val_scaled;
-		}
+		postT1ScaleOJPH((float*)dest, src, len, scale);
 	}
 
   private:
@@ -19,11 +19,13 @@
 #include "coding/ojph_block_decoder.h"
 #include "coding/ojph_block_encoder.h"
 #include "ojph_mem.h"
+#include "ojph_arch.h"
 #include "T1OJPH.h"
 
 #include "grk_includes.h"
 
-const uint8_t grk_cblk_dec_compressed_data_pad_ht = 8;
+// SIMD block decoders read up to 16 bytes past the end of a segment
+const uint8_t grk_cblk_dec_compressed_data_pad_ht = 16;
 
 namespace ojph
 {
@@ -31,16 +33,45 @@ T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, u
 			   uint32_t maxCblkH)
 	: coded_data_size(isCompressor ? 0 : (uint32_t)(maxCblkW * maxCblkH * sizeof(int32_t))),
 	  coded_data(isCompressor ? nullptr : new uint8_t[coded_data_size]),
-	  unencoded_data_size(maxCblkW * maxCblkH), unencoded_data(new int32_t[unencoded_data_size]),
-	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576))
+	  unencoded_data_size(maxCblkW * maxCblkH),
+	  unencoded_data((int32_t*)grk::grk_aligned_malloc(unencoded_data_size * sizeof(int32_t))),
+	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576)),
+	  decode_codeblock(ojph::local::ojph_decode_codeblock), decode_needs_aligned_stride(false),
+	  encode_codeblock(ojph::local::ojph_encode_codeblock)
 {
-	if(!isCompressor)
+	if(isCompressor)
+	{
+#ifdef OJPH_ENABLE_X86_BLOCK_CODERS
+		int level = get_cpu_ext_level();
+		if(level >= X86_CPU_EXT_LEVEL_AVX512)
+			encode_codeblock = ojph::local::ojph_encode_codeblock_avx512;
+		else if(level >= X86_CPU_EXT_LEVEL_AVX2)
+			encode_codeblock = ojph::local::ojph_encode_codeblock_avx2;
+		else if(level >= X86_CPU_EXT_LEVEL_SSE41)
+			encode_codeblock = ojph::local::ojph_encode_codeblock_sse41;
+#endif
+	}
+	else
+	{
 		memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
+#ifdef OJPH_ENABLE_X86_BLOCK_CODERS
+		int level = get_cpu_ext_level();
+		if(level >= X86_CPU_EXT_LEVEL_AVX512_VBMI2)
+			decode_codeblock = ojph::local::ojph_decode_codeblock_avx512_vbmi2;
+		else if(level >= X86_CPU_EXT_LEVEL_AVX512)
+			decode_codeblock = ojph::local::ojph_decode_codeblock_avx512;
+		else if(level >= X86_CPU_EXT_LEVEL_AVX2)
+			decode_codeblock = ojph::local::ojph_decode_codeblock_avx2;
+		else if(level >= X86_CPU_EXT_LEVEL_SSSE3)
+			decode_codeblock = ojph::local::ojph_decode_codeblock_ssse3;
+		decode_needs_aligned_stride = level >= X86_CPU_EXT_LEVEL_SSSE3;
+#endif
+	}
 }
 T1OJPH::~T1OJPH()
 {
 	delete[] coded_data;
-	delete[] unencoded_data;
+	grk::grk_aligned_free(unencoded_data);
 	delete allocator;
 	delete elastic_alloc;
 }
@@ -104,25 +135,146 @@ bool T1OJPH::compress(grk::CompressBlockExec* block)
 	uint16_t w = (uint16_t)cblk->width();
 	uint16_t h = (uint16_t)cblk->height();
 
+	// buffers from the previous code block are no longer needed
+	elastic_alloc->restart();
+	if(block->doRateControl)
+		return compressCandidates(block);
+
 	uint32_t pass_length[2] = {0, 0};
-	ojph::local::ojph_encode_codeblock((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w,
-									   pass_length, elastic_alloc, next_coded);
+	encode_codeblock((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w, pass_length,
+					 elastic_alloc, next_coded);
 
 	cblk->numPassesTotal = 1;
 	cblk->passes[0].len = (uint16_t)pass_length[0];
 	cblk->passes[0].rate = (uint16_t)pass_length[0];
+	cblk->passes[0].offset = 0;
+	cblk->passes[0].numbps = 1;
 	cblk->numbps = 1;
 	assert(cblk->paddedCompressedStream);
 	memcpy(cblk->paddedCompressedStream, next_coded->buf, (size_t)pass_length[0]);
 
 	return true;
 }
+/*
+ HT has a single cleanup pass, so there is nothing to truncate. Instead, the code block
+ is coded several times, with 0, 1, 2 ... least significant bit planes dropped from
+ the cleanup pass, and the coarser codings become the truncation points
+ for rate control. Rate control then signals the chosen coding with its number of bit planes.
+ */
+bool T1OJPH::compressCandidates(grk::CompressBlockExec* block)
+{
+	auto cblk = block->cblk;
+	uint16_t w = (uint16_t)cblk->width();
+	uint16_t h = (uint16_t)cblk->height();
+	uint32_t numSamples = (uint32_t)w * h;
+	// the cleanup pass codes sample bits from this bit plane up
+	uint32_t p = 30U - block->k_msbs;
+	uint32_t maxMag = 0;
+	for(uint32_t i = 0; i < numSamples; ++i)
+		maxMag = std::max<uint32_t>(maxMag, (uint32_t)unencoded_data[i] & 0x7FFFFFFF);
+
+	// a candidate dropping d bit planes is signalled with 1 + d code block bit planes,
+	// and it must code at least one non-zero sample
+	uint32_t numCandidates = 0;
+	while(numCandidates < std::min<uint32_t>(block->bandNumbps, maxCandidates) &&
+		  numCandidates <= block->k_msbs && (maxMag >> (p + numCandidates)))
+		numCandidates++;
+
+	// squared error for each candidate, in units of the quantization step,
+	// using the decompressor's mid-point reconstruction
+	double error[maxCandidates + 1] = {};
+	bool reversible = block->qmfbid == 1;
+	double scale = 1.0 / (double)(1U << p);
+	for(uint32_t i = 0; i < numSamples; ++i)
+	{
+		uint32_t mag = (uint32_t)unencoded_data[i] & 0x7FFFFFFF;
+		if(!mag)
+			continue;
+		double x = mag * scale;
+		error[numCandidates] += x * x;
+		for(uint32_t d = 0; d < numCandidates; ++d)
+		{
+			uint32_t m = mag >> (p + d);
+			double rec = 0;
+			if(m)
+				rec = (reversible && d == 0) ? m : (m + 0.5) * (double)(1U << d);
+			error[d] += (x - rec) * (x - rec);
+		}
+	}
+	double norm = grk::T1::getnorm(
+		(uint32_t)((block->tile->comps + block->compno)->numresolutions - 1 - block->resno),
+		block->bandOrientation, reversible);
+	if(block->mct_norms && block->compno < block->mct_numcomps)
+		norm *= block->mct_norms[block->compno];
+	// reversible HT exponents only bound the number of bit planes : the step is one
+	double weight = reversible ? norm : norm * block->stepsize;
+	weight *= weight;
+
+	// code candidates from finest to coarsest, keeping only those candidates
+	// that are smaller, and more distorted, than all finer candidates
+	struct Candidate
+	{
+		coded_lists* coded;
+		uint32_t len;
+		double distortiondec;
+		uint8_t numbps;
+	};
+	Candidate candidates[maxCandidates];
+	uint32_t numKept = 0;
+	uint32_t totalLen = 0;
+	for(uint32_t d = 0; d < numCandidates; ++d)
+	{
+		coded_lists* coded = nullptr;
+		uint32_t pass_length[2] = {0, 0};
+		encode_codeblock((uint32_t*)unencoded_data, block->k_msbs - d, 1, w, h, w, pass_length,
+						 elastic_alloc, coded);
+		double distortiondec = weight * (error[numCandidates] - error[d]);
+		if(numKept)
+		{
+			auto finer = candidates + numKept - 1;
+			if(pass_length[0] >= finer->len || distortiondec >= finer->distortiondec)
+				continue;
+		}
+		if(totalLen + pass_length[0] > cblk->compressedStream.len)
+			break;
+		candidates[numKept++] = {coded, pass_length[0], distortiondec, (uint8_t)(1 + d)};
+		totalLen += pass_length[0];
+	}
+
+	// store candidates coarsest first, as increasing truncation points
+	uint32_t offset = 0;
+	for(uint32_t i = 0; i < numKept; ++i)
+	{
+		auto candidate = candidates + numKept - 1 - i;
+		auto pass = cblk->passes + i;
+		pass->rate = candidate->len;
+		pass->len = candidate->len - (i ? cblk->passes[i - 1].rate : 0);
+		pass->distortiondec = candidate->distortiondec;
+		pass->term = 1;
+		pass->offset = offset;
+		pass->numbps = candidate->numbps;
+		memcpy(cblk->paddedCompressedStream + offset, candidate->coded->buf, candidate->len);
+		offset += candidate->len;
+	}
+	cblk->numPassesTotal = numKept;
+	cblk->numbps = numKept ? candidates[0].numbps : 0;
+	block->distortion = numKept ? candidates[0].distortiondec : 0;
+
+	return true;
+}
 bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 {
 	auto cblk = block->cblk;
 	if(!cblk->area())
 		return true;
 	uint16_t stride = (uint16_t)cblk->width();
+	// decompressed data retained from previous decompression
+	if(block->retainDecompressed && cblk->isOpen())
+	{
+		block->tilec->postProcessHT(cblk->getBuffer(), block, stride);
+
+		return true;
+	}
 	if(!cblk->seg_buffers.empty())
 	{
 		size_t total_seg_len = 2 * grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen();
@@ -153,9 +305,19 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 		bool rc = false;
 		if(num_passes && offset)
 		{
-			rc = ojph::local::ojph_decode_codeblock(
-				actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs, (uint32_t)num_passes,
-				(uint32_t)offset, 0, cblk->width(), cblk->height(), stride, false);
+			// SIMD decoders store whole quad pairs, so rows are padded
+			// to a multiple of 4 samples and then packed to the block width
+			uint32_t decode_stride = decode_needs_aligned_stride ? (stride + 3U) & ~3U : stride;
+			rc = decode_codeblock(actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs,
+								  (uint32_t)num_passes, (uint32_t)offset, 0, cblk->width(),
+								  cblk->height(), decode_stride, false);
+			if(rc && decode_stride != stride)
+			{
+				for(uint32_t y = 1; y < cblk->height(); ++y)
+					memmove(unencoded_data + (size_t)y * stride,
+							unencoded_data + (size_t)y * decode_stride,
+							stride * sizeof(int32_t));
+			}
 		}
 		else
 		{
@@ -166,6 +328,14 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 			grk::Logger::logger_.error("Error in HT block coder");
 			return false;
 		}
+		if(block->retainDecompressed)
+		{
+			if(!cblk->alloc2d(false))
+				return false;
+			memcpy(cblk->getBuffer(), unencoded_data,
+				   (size_t)stride * cblk->height() * sizeof(int32_t));
+			cblk->setCacheState(grk::GRK_CACHE_STATE_OPEN);
+		}
 	}
 
 	block->tilec->postProcessHT(unencoded_data, block, stride);
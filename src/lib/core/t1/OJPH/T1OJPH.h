@@ -23,6 +23,7 @@ namespace ojph
 {
 class mem_fixed_allocator;
 class mem_elastic_allocator;
+struct coded_lists;
 
 struct TileCodingParams;
 
@@ -37,6 +38,9 @@ class T1OJPH : public grk::T1Interface
 
   private:
 	void preCompress(grk::CompressBlockExec* block, grk::Tile* tile);
+	bool compressCandidates(grk::CompressBlockExec* block);
+	// maximum number of cleanup pass candidates coded for rate control
+	static const uint32_t maxCandidates = 16;
 	bool postProcess(grk::DecompressBlockExec* block);
 
 	uint32_t coded_data_size;
@@ -46,5 +50,21 @@ class T1OJPH : public grk::T1Interface
 
 	mem_fixed_allocator* allocator;
 	mem_elastic_allocator* elastic_alloc;
+
+	typedef bool (*decode_codeblock_fn)(uint8_t* coded_data, uint32_t* decoded_data,
+										uint32_t missing_msbs, uint32_t num_passes,
+										uint32_t lengths1, uint32_t lengths2, uint32_t width,
+										uint32_t height, uint32_t stride, bool stripe_causal);
+	// block decoder for this CPU's extension level
+	decode_codeblock_fn decode_codeblock;
+	// true if decode_codeblock requires a row stride that is a multiple of 4
+	bool decode_needs_aligned_stride;
+
+	typedef void (*encode_codeblock_fn)(uint32_t* buf, uint32_t missing_msbs,
+										uint32_t num_passes, uint32_t width, uint32_t height,
+										uint32_t stride, uint32_t* lengths,
+										mem_elastic_allocator* elastic, coded_lists*& coded);
+	// block encoder for this CPU's extension level
+	encode_codeblock_fn encode_codeblock;
 };
 } // namespace ojph
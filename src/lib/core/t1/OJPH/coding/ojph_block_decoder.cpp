@@ -44,6 +44,8 @@
 #include <iostream>
 
 #include <cassert>
+#include <cstdarg>
+#include <cstdio>
 #include <cstring>
 #include "grok.h"
 #include "Logger.h"
@@ -1625,6 +1627,25 @@ namespace ojph {
       }
       return true;
     }
+
+    //************************************************************************/
+    /** @brief Logs a warning on behalf of the SIMD block decoders
+     *
+     *  The SIMD decoders are built with wider instruction sets than the
+     *  rest of the library, so they log through this function rather than
+     *  instantiating the logger's inline members themselves.
+     *
+     *  @param [in]  fmt is a printf-style format string
+     */
+    void ojph_decoder_warn(const char* fmt, ...)
+    {
+      char msg[512];
+      va_list args;
+      va_start(args, fmt);
+      vsnprintf(msg, sizeof(msg), fmt, args);
+      va_end(args);
+      grk::Logger::logger_.warn("%s", msg);
+    }
   }
 }
 
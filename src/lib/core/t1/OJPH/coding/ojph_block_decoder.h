@@ -48,6 +48,9 @@ namespace ojph {
     //decodes the cleanup pass, significance propagation pass,
     // and magnitude refinement pass
 
+    // logs a warning on behalf of the SIMD decoders
+    void ojph_decoder_warn(const char* fmt, ...);
+
     // generic decoder
     bool
       ojph_decode_codeblock(ui8* coded_data, ui32* decoded_data,
@@ -60,6 +63,24 @@ namespace ojph {
         ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
         ui32 width, ui32 height, ui32 stride, bool stripe_causal);
 
+    // AVX2-accelerated decoder
+    bool
+      ojph_decode_codeblock_avx2(ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
+    // AVX-512-accelerated decoder
+    bool
+      ojph_decode_codeblock_avx512(ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
+    // AVX-512-accelerated decoder, using VBMI2 funnel shifts
+    bool
+      ojph_decode_codeblock_avx512_vbmi2(ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
     // WASM SIMD-accelerated decoder
     bool
       ojph_decode_codeblock_wasm(ui8* coded_data, ui32* decoded_data,
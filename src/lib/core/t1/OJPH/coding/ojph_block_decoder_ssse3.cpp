@@ -45,8 +45,17 @@
 
 #include <cassert>
 #include <cstring>
-#include "grok.h"
-#include "Logger.h"
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#endif
+
 #include "ojph_block_common.h"
 #include "ojph_block_decoder.h"
 #include "ojph_arch.h"
@@ -569,7 +578,7 @@ namespace ojph {
      *  @param [in]  mrp is a pointer to rev_struct structure
      *  @param [in]  num_bits is the number of bits to be removed
      */
-    inline ui32 rev_advance_mrp(rev_struct *mrp, ui32 num_bits)
+    static inline ui32 rev_advance_mrp(rev_struct *mrp, ui32 num_bits)
     {
       assert(num_bits <= mrp->bits); // we must not consume more than mrp->bits
       mrp->tmp >>= num_bits;  // discard the lowest num_bits bits
@@ -1033,17 +1042,17 @@ namespace ojph {
 
       if (num_passes > 1 && lengths2 == 0)
       {
-        grk::Logger::logger_.warn("A malformed codeblock that has more than "
-                              "one coding pass, but zero length for "
-                              "2nd and potential 3rd pass.\n");
+        ojph_decoder_warn("A malformed codeblock that has more than "
+                          "one coding pass, but zero length for "
+                          "2nd and potential 3rd pass.\n");
         num_passes = 1;
       }
 
       if (num_passes > 3)
       {
-        grk::Logger::logger_.warn("We do not support more than 3 coding passes; "
-                              "This codeblocks has %d passes.\n",
-                              num_passes);
+        ojph_decoder_warn("We do not support more than 3 coding passes; "
+                          "This codeblocks has %d passes.\n",
+                          num_passes);
         return false;
       }
 
@@ -1052,9 +1061,9 @@ namespace ojph {
         if (insufficient_precision == false) 
         {
           insufficient_precision = true;
-          grk::Logger::logger_.warn("32 bits are not enough to decode this "
-                                "codeblock. This message will not be "
-                                "displayed again.\n");
+          ojph_decoder_warn("32 bits are not enough to decode this "
+                            "codeblock. This message will not be "
+                            "displayed again.\n");
         }
         return false;
       }       
@@ -1062,10 +1071,10 @@ namespace ojph {
       { // not enough precision to decode and set the bin center to 1
         if (modify_code == false) {
           modify_code = true;
-          grk::Logger::logger_.warn("Not enough precision to decode the cleanup "
-                                "pass. The code can be modified to support "
-                                "this case. This message will not be "
-                                "displayed again.\n");
+          ojph_decoder_warn("Not enough precision to decode the cleanup "
+                            "pass. The code can be modified to support "
+                            "this case. This message will not be "
+                            "displayed again.\n");
         }
          return false;         // 32 bits are not enough to decode this
        }
@@ -1075,10 +1084,10 @@ namespace ojph {
           num_passes = 1;
           if (truncate_spp_mrp == false) {
             truncate_spp_mrp = true;
-            grk::Logger::logger_.warn("Not enough precision to decode the SgnProp "
-                                  "nor MagRef passes; both will be skipped. "
-                                  "This message will not be displayed "
-                                  "again.\n");
+            ojph_decoder_warn("Not enough precision to decode the SgnProp "
+                              "nor MagRef passes; both will be skipped. "
+                              "This message will not be displayed "
+                              "again.\n");
           }
         }
       }
@@ -1088,7 +1097,7 @@ namespace ojph {
 
       if (lengths1 < 2)
       {
-        grk::Logger::logger_.warn("Wrong codeblock length.\n");
+        ojph_decoder_warn("Wrong codeblock length.\n");
         return false;
       }
 
@@ -2066,3 +2075,7 @@ namespace ojph {
     }
   }
 }
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic pop
+#endif
@@ -62,8 +62,9 @@ namespace ojph {
     // index is (c_q << 8) + (rho << 4) + eps
     // data is  (cwd << 8) + (cwd_len << 4) + eps
     // table 0 is for the initial line of quads
-    static ui16 vlc_tbl0[2048] = { 0 };
-    static ui16 vlc_tbl1[2048] = { 0 };
+    // two extra entries let the SIMD encoders gather 32 bits at a time
+    static ui16 vlc_tbl0[2048 + 2] = { 0 };
+    static ui16 vlc_tbl1[2048 + 2] = { 0 };
 
     //UVLC encoding
     static int ulvc_cwd_pre[33];
@@ -461,6 +462,36 @@ namespace ojph {
         msp->pos--;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    // terminates the three bitstreams and copies them to the elastic
+    // allocator, followed by the interface locator word
+    //////////////////////////////////////////////////////////////////////////
+    static void
+    terminate_and_copy(mel_struct* melp, vlc_struct* vlcp, ms_struct* msp,
+                       ui32* lengths, ojph::mem_elastic_allocator *elastic,
+                       ojph::coded_lists *& coded)
+    {
+      terminate_mel_vlc(melp, vlcp);
+      ms_terminate(msp);
+
+      //copy to elastic
+      lengths[0] = melp->pos + vlcp->pos + msp->pos;
+      elastic->get_buffer(melp->pos + vlcp->pos + msp->pos, coded);
+      memcpy(coded->buf, msp->buf, msp->pos);
+      memcpy(coded->buf + msp->pos, melp->buf, melp->pos);
+      memcpy(coded->buf + msp->pos + melp->pos, vlcp->buf - vlcp->pos + 1,
+             vlcp->pos);
+
+      // put in the interface locator word
+      ui32 num_bytes = melp->pos + vlcp->pos;
+      coded->buf[lengths[0]-1] = (ui8)(num_bytes >> 4);
+      coded->buf[lengths[0]-2] = coded->buf[lengths[0]-2] & 0xF0;
+      coded->buf[lengths[0]-2] = 
+        (ui8)(coded->buf[lengths[0]-2] | (num_bytes & 0xF));
+
+      coded->avail_size -= lengths[0];
+    }
+
     //////////////////////////////////////////////////////////////////////////
     //
     //
@@ -502,8 +533,9 @@ namespace ojph {
       // and the bottom right of the earlier quad. The same is true for cx.
       //For a 1024 pixels, we need 512 bytes, the 2 extra,
       // one for the non-existing earlier quad, and one for beyond the
-      // the end
-      ui8 e_val[513];
+      // the end; e_val needs one more, since the last quad of a row
+      // reads the entry after it
+      ui8 e_val[514];
       ui8 cx_val[513];
       ui8* lep = e_val;     lep[0] = 0;
       ui8* lcxp = cx_val;   lcxp[0] = 0;
@@ -925,24 +957,161 @@ namespace ojph {
       }
 
 
-      terminate_mel_vlc(&mel, &vlc);
-      ms_terminate(&ms);
+      terminate_and_copy(&mel, &vlc, &ms, lengths, elastic, coded);
+    }
 
-      //copy to elastic
-      lengths[0] = mel.pos + vlc.pos + ms.pos;
-      elastic->get_buffer(mel.pos + vlc.pos + ms.pos, coded);
-      memcpy(coded->buf, ms.buf, ms.pos);
-      memcpy(coded->buf + ms.pos, mel.buf, mel.pos);
-      memcpy(coded->buf + ms.pos + mel.pos, vlc.buf - vlc.pos + 1, vlc.pos);
+    //////////////////////////////////////////////////////////////////////////
+    // same as ms_encode, but a byte at a time rather than a bit field at a
+    // time; cwd_len can be up to 57 bits, since at most 7 bits are pending
+    static inline void
+    ms_encode64(ms_struct* msp, ui64 cwd, int cwd_len)
+    {
+      if (msp->pos + 8 >= msp->buf_size)
+        grk::Logger::logger_.error( "magnitude sign encoder's buffer is full");
+      ui64 tmp = msp->tmp | (cwd << msp->used_bits);
+      int used_bits = msp->used_bits + cwd_len;
+      while (used_bits >= msp->max_bits)
+      {
+        ui32 t = (ui32)tmp & ((1U << msp->max_bits) - 1);
+        msp->buf[msp->pos++] = (ui8)t;
+        tmp >>= msp->max_bits;
+        used_bits -= msp->max_bits;
+        msp->max_bits = (t == 0xFF) ? 7 : 8;
+      }
+      msp->tmp = (ui32)tmp;
+      msp->used_bits = used_bits;
+    }
 
-      // put in the interface locator word
-      ui32 num_bytes = mel.pos + vlc.pos;
-      coded->buf[lengths[0]-1] = (ui8)(num_bytes >> 4);
-      coded->buf[lengths[0]-2] = coded->buf[lengths[0]-2] & 0xF0;
-      coded->buf[lengths[0]-2] = 
-        (ui8)(coded->buf[lengths[0]-2] | (num_bytes & 0xF));
+    //////////////////////////////////////////////////////////////////////////
+    // the MagSgn bits of one quad, packed into as few writes as possible
+    static inline void
+    ms_encode_quad(ms_struct* msp, const ui32* s, ui32 ms_len)
+    {
+      ui64 cwd = 0;
+      int cwd_len = 0;
+      for (int n = 0; n < 4; ++n, ms_len >>= 8)
+      {
+        int m = (int)(ms_len & 0xFF);
+        if (cwd_len + m > 56)
+        {
+          ms_encode64(msp, cwd, cwd_len);
+          cwd = 0;
+          cwd_len = 0;
+        }
+        cwd |= (ui64)(s[n] & (ui32)(((ui64)1 << m) - 1)) << cwd_len;
+        cwd_len += m;
+      }
+      if (cwd_len)
+        ms_encode64(msp, cwd, cwd_len);
+    }
 
-      coded->avail_size -= lengths[0];
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    emit_quad(const enc_quad_row* qr, ui32 q, mel_struct* melp,
+              vlc_struct* vlcp, ms_struct* msp)
+    {
+      ui32 tuple = qr->tuple[q];
+      vlc_encode(vlcp, (int)(tuple >> 8), (int)((tuple >> 4) & 7));
+      if (qr->c_q[q] == 0)
+        mel_encode(melp, qr->rho_store[q + 1] != 0);
+      ms_encode_quad(msp, qr->s + 4 * q, qr->ms_len[q]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void
+    emit_quad_row(const enc_quad_row* qr, ui32 num_quads, mel_struct* melp,
+                  vlc_struct* vlcp, ms_struct* msp)
+    {
+      for (ui32 q = 0; q < num_quads; q += 2)
+      {
+        emit_quad(qr, q, melp, vlcp, msp);
+        int u_q0 = (int)qr->u_q[q], u_q1 = 0;
+        if (q + 1 < num_quads)
+        {
+          emit_quad(qr, q + 1, melp, vlcp, msp);
+          u_q1 = (int)qr->u_q[q + 1];
+        }
+
+        if (qr->initial)
+        {
+          if (u_q0 > 0 && u_q1 > 0)
+            mel_encode(melp, ojph_min(u_q0, u_q1) > 2);
+
+          if (u_q0 > 2 && u_q1 > 2)
+          {
+            vlc_encode(vlcp, ulvc_cwd_pre[u_q0-2], ulvc_cwd_pre_len[u_q0-2]);
+            vlc_encode(vlcp, ulvc_cwd_pre[u_q1-2], ulvc_cwd_pre_len[u_q1-2]);
+            vlc_encode(vlcp, ulvc_cwd_suf[u_q0-2], ulvc_cwd_suf_len[u_q0-2]);
+            vlc_encode(vlcp, ulvc_cwd_suf[u_q1-2], ulvc_cwd_suf_len[u_q1-2]);
+            continue;
+          }
+          else if (u_q0 > 2 && u_q1 > 0)
+          {
+            vlc_encode(vlcp, ulvc_cwd_pre[u_q0], ulvc_cwd_pre_len[u_q0]);
+            vlc_encode(vlcp, u_q1 - 1, 1);
+            vlc_encode(vlcp, ulvc_cwd_suf[u_q0], ulvc_cwd_suf_len[u_q0]);
+            continue;
+          }
+        }
+        vlc_encode(vlcp, ulvc_cwd_pre[u_q0], ulvc_cwd_pre_len[u_q0]);
+        vlc_encode(vlcp, ulvc_cwd_pre[u_q1], ulvc_cwd_pre_len[u_q1]);
+        vlc_encode(vlcp, ulvc_cwd_suf[u_q0], ulvc_cwd_suf_len[u_q0]);
+        vlc_encode(vlcp, ulvc_cwd_suf[u_q1], ulvc_cwd_suf_len[u_q1]);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ojph_encode_codeblock_vec(enc_analyse_fn analyse,
+                                   ui32* buf, ui32 missing_msbs,
+                                   ui32 num_passes, ui32 width, ui32 height,
+                                   ui32 stride, ui32* lengths,
+                                   ojph::mem_elastic_allocator *elastic,
+                                   ojph::coded_lists *& coded)
+    {
+      assert(num_passes == 1);
+      (void)num_passes;                      //currently not used
+      const int ms_size = (16384*16+14)/15;  //more than enough
+      ui8 ms_buf[ms_size];
+      const int mel_vlc_size = 3072;         //more than enough
+      ui8 mel_vlc_buf[mel_vlc_size];
+      const int mel_size = 192;
+      ui8 *mel_buf = mel_vlc_buf;
+      const int vlc_size = mel_vlc_size - mel_size;
+      ui8 *vlc_buf = mel_vlc_buf + mel_size;
+
+      mel_struct mel;
+      mel_init(&mel, mel_size, mel_buf);
+      vlc_struct vlc;
+      vlc_init(&vlc, vlc_size, vlc_buf);
+      ms_struct ms;
+      ms_init(&ms, ms_size, ms_buf);
+
+      enc_quad_row qr;
+      qr.width = width;
+      qr.stride = stride;
+      qr.p = 30 - missing_msbs;
+      qr.cur = 0;
+      // the kernels write whole vectors of quads; everything they may read
+      // beyond that, including the guard entries, must start out as zero
+      ui32 num_quads = (width + 1) >> 1;
+      size_t span = (ojph_min(num_quads + 16, enc_quad_row::max_quads) + 1)
+                  * sizeof(ui32);
+      qr.rho_store[0] = 0;
+      memset(qr.e_bl[0], 0, span);
+      memset(qr.e_bl[1], 0, span);
+      memset(qr.e_br[0], 0, span);
+      memset(qr.e_br[1], 0, span);
+
+      for (ui32 y = 0; y < height; y += 2)
+      {
+        qr.initial = y == 0;
+        qr.vlc_tbl = y == 0 ? vlc_tbl0 : vlc_tbl1;
+        analyse(&qr, buf + y * stride, ojph_min(height - y, 2u));
+        emit_quad_row(&qr, num_quads, &mel, &vlc, &ms);
+        qr.cur ^= 1;
+      }
+
+      terminate_and_copy(&mel, &vlc, &ms, lengths, elastic, coded);
     }
   }
 }
@@ -57,6 +57,80 @@ namespace ojph {
                             ui32* lengths, 
                             ojph::mem_elastic_allocator *elastic,
                             ojph::coded_lists *& coded);
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief One row of quads, analysed ahead of bitstream emission
+     *
+     *  The SIMD encoders split the cleanup pass in two.  A vectorized
+     *  kernel computes, for every quad in a row of quads, the significance
+     *  pattern, exponents, context, VLC codeword and magnitude-sign lengths;
+     *  a scalar writer then emits the MEL, VLC and MagSgn bitstreams in
+     *  quad order.  Arrays are sized for the widest code block (1024
+     *  samples, 512 quads) plus the overshoot of a 16-quad vector.
+     */
+    struct enc_quad_row
+    {
+      static const ui32 max_quads = 512 + 16;
+
+      // inputs, set by the driver
+      ui32 width;           // code block width in samples
+      ui32 stride;          // row stride of the sample buffer
+      ui32 p;               // 30 - missing_msbs
+      bool initial;         // true for the initial row of quads
+      const ui16* vlc_tbl;  // vlc_tbl0 or vlc_tbl1, padded for 32-bit gathers
+      int cur;              // which of the e_bl/e_br buffers this row writes
+
+      // outputs of the analysis kernel, one entry per quad unless noted
+      ui32 rho_store[max_quads + 1]; // rho_store[0] is quad -1, always 0
+      ui32 e_max[max_quads];         // E_max of the quad
+      ui32 e_eq[max_quads];          // samples with E == E_max
+      ui32 e_bl[2][max_quads + 1];   // E of bottom-left sample
+      ui32 e_br[2][max_quads + 1];   // E of bottom-right sample, from [1]
+      ui32 c_q[max_quads];           // context
+      ui32 u_q[max_quads];           // u_q = U_q - kappa_q
+      ui32 tuple[max_quads];         // VLC table entry
+      ui32 ms_len[max_quads];        // MagSgn bit count, one byte per sample
+      ui32 s[4 * max_quads];         // v_n in quad order, 4 per quad
+
+      ui32* rho() { return rho_store + 1; }
+    };
+
+    // vectorized analysis of one row of quads; rows is 1 or 2
+    typedef void (*enc_analyse_fn)(enc_quad_row* qr, const ui32* sp,
+                                   ui32 rows);
+
+    // encodes a code block with the given analysis kernel
+    void
+      ojph_encode_codeblock_vec(enc_analyse_fn analyse,
+                                ui32* buf, ui32 missing_msbs,
+                                ui32 num_passes, ui32 width, ui32 height,
+                                ui32 stride, ui32* lengths,
+                                ojph::mem_elastic_allocator *elastic,
+                                ojph::coded_lists *& coded);
+
+    // SSE4.1-accelerated encoder
+    void
+      ojph_encode_codeblock_sse41(ui32* buf, ui32 missing_msbs,
+                                  ui32 num_passes, ui32 width, ui32 height,
+                                  ui32 stride, ui32* lengths,
+                                  ojph::mem_elastic_allocator *elastic,
+                                  ojph::coded_lists *& coded);
+
+    // AVX2-accelerated encoder
+    void
+      ojph_encode_codeblock_avx2(ui32* buf, ui32 missing_msbs,
+                                 ui32 num_passes, ui32 width, ui32 height,
+                                 ui32 stride, ui32* lengths,
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded);
+
+    // AVX-512-accelerated encoder
+    void
+      ojph_encode_codeblock_avx512(ui32* buf, ui32 missing_msbs,
+                                   ui32 num_passes, ui32 width, ui32 height,
+                                   ui32 stride, ui32* lengths,
+                                   ojph::mem_elastic_allocator *elastic,
+                                   ojph::coded_lists *& coded);
   }
 }
 
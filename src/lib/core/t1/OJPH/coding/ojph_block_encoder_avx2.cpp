@@ -0,0 +1,301 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_avx2.cpp
+// Author: Aous Naman
+// Date: 13 May 2022
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_avx2.cpp
+ *  @brief implements a faster HTJ2K block encoder using avx2
+ *
+ *  Only the analysis of each row of quads is vectorized here; the MEL, VLC
+ *  and MagSgn bitstreams are written by ojph_encode_codeblock_vec, so the
+ *  output is identical to that of ojph_encode_codeblock.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "ojph_defs.h"
+#include "ojph_block_encoder.h"
+
+#include <immintrin.h>
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief exponent and value of 8 samples
+     *
+     *  e is the number of bits in 2 mu_p - 1 and v is 2(mu_p - 1) + s_n;
+     *  both are zero for insignificant samples.  Since the float
+     *  conversion rounds, bits that are followed by a set bit are cleared
+     *  first, so that the exponent of the float is that of the leading bit.
+     */
+    static inline void
+    exp_and_val(__m256i t, __m128i p, __m256i& e, __m256i& v)
+    {
+      const __m256i one = _mm256_set1_epi32(1);
+      __m256i val = _mm256_add_epi32(t, t);      // get rid of sign
+      val = _mm256_srl_epi32(val, p);            // 2 \mu_p + x
+      val = _mm256_andnot_si256(one, val);       // 2 \mu_p
+      __m256i insig = _mm256_cmpeq_epi32(val, _mm256_setzero_si256());
+
+      // bits in (2 \mu_p - 1) = 1 + bits in (\mu_p - 1)
+      __m256i w = _mm256_sub_epi32(_mm256_srli_epi32(val, 1), one);
+      w = _mm256_andnot_si256(_mm256_srli_epi32(w, 1), w);
+      __m256i f = _mm256_castps_si256(_mm256_cvtepi32_ps(w));
+      __m256i bits = _mm256_sub_epi32(_mm256_srli_epi32(f, 23),
+                                      _mm256_set1_epi32(126));
+      bits = _mm256_max_epi32(bits, _mm256_setzero_si256());
+      e = _mm256_andnot_si256(insig, _mm256_add_epi32(bits, one));
+
+      // v_n = 2(\mu_p-1) + s_n
+      __m256i s = _mm256_add_epi32(_mm256_sub_epi32(val, _mm256_set1_epi32(2)),
+                                   _mm256_srli_epi32(t, 31));
+      v = _mm256_andnot_si256(insig, s);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // gathers the even (or odd) 32-bit lanes of a and b
+    static inline __m256i
+    even_lanes(__m256i a, __m256i b)
+    {
+      __m256 t = _mm256_shuffle_ps(_mm256_castsi256_ps(a),
+                                   _mm256_castsi256_ps(b),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+      return _mm256_permute4x64_epi64(_mm256_castps_si256(t),
+                                      _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    static inline __m256i
+    odd_lanes(__m256i a, __m256i b)
+    {
+      __m256 t = _mm256_shuffle_ps(_mm256_castsi256_ps(a),
+                                   _mm256_castsi256_ps(b),
+                                   _MM_SHUFFLE(3, 1, 3, 1));
+      return _mm256_permute4x64_epi64(_mm256_castps_si256(t),
+                                      _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief per-quad E_max, samples equal to E_max and rho for 4 quads
+     *
+     *  Column pairs of the two rows form quads; results are in the even
+     *  lanes.  Samples are numbered top-left, bottom-left, top-right and
+     *  bottom-right.
+     */
+    static inline void
+    quad_stats(__m256i e0, __m256i e1, __m256i& e_max, __m256i& e_eq,
+               __m256i& rho)
+    {
+      const __m256i w0 = _mm256_setr_epi32(1, 4, 1, 4, 1, 4, 1, 4);
+      const __m256i w1 = _mm256_setr_epi32(2, 8, 2, 8, 2, 8, 2, 8);
+      const __m256i zero = _mm256_setzero_si256();
+
+      __m256i m = _mm256_max_epi32(e0, e1);
+      m = _mm256_max_epi32(m, _mm256_srli_epi64(m, 32));
+      e_max = _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 2, 0, 0));
+
+      __m256i t = _mm256_or_si256(
+        _mm256_and_si256(_mm256_cmpeq_epi32(e0, e_max), w0),
+        _mm256_and_si256(_mm256_cmpeq_epi32(e1, e_max), w1));
+      e_eq = _mm256_add_epi32(t, _mm256_srli_epi64(t, 32));
+
+      t = _mm256_or_si256(
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(e0, zero), w0),
+        _mm256_andnot_si256(_mm256_cmpeq_epi32(e1, zero), w1));
+      rho = _mm256_add_epi32(t, _mm256_srli_epi64(t, 32));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // spreads the 4 low bits of each lane to the 4 bytes of that lane
+    static inline __m256i
+    spread_bits(__m256i x)
+    {
+      x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x00204081));
+      return _mm256_and_si256(x, _mm256_set1_epi32(0x01010101));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void
+    analyse_quad_row(enc_quad_row* qr, const ui32* sp, ui32 rows)
+    {
+      const ui32 width = qr->width;
+      const __m128i p = _mm_cvtsi32_si128((int)qr->p);
+      const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      ui32 *rho = qr->rho();
+      ui32 *e_bl = qr->e_bl[qr->cur], *e_br = qr->e_br[qr->cur] + 1;
+
+      // samples to quads, 16 columns (8 quads) at a time
+      for (ui32 x = 0, q = 0; x < width; x += 16, q += 8)
+      {
+        const ui32* p0 = sp + x;
+        const ui32* p1 = p0 + qr->stride;
+        __m256i t0a, t0b, t1a, t1b;
+        __m256i zero = _mm256_setzero_si256();
+        if (x + 16 <= width)
+        {
+          t0a = _mm256_loadu_si256((__m256i*)p0);
+          t0b = _mm256_loadu_si256((__m256i*)(p0 + 8));
+          t1a = rows > 1 ? _mm256_loadu_si256((__m256i*)p1) : zero;
+          t1b = rows > 1 ? _mm256_loadu_si256((__m256i*)(p1 + 8)) : zero;
+        }
+        else
+        {
+          // masked loads do not touch memory beyond the row
+          __m256i ma = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(width - x)),
+                                          lane);
+          __m256i mb = _mm256_cmpgt_epi32(
+            _mm256_set1_epi32((int)(width - x) - 8), lane);
+          t0a = _mm256_maskload_epi32((const int*)p0, ma);
+          t0b = _mm256_maskload_epi32((const int*)(p0 + 8), mb);
+          t1a = rows > 1 ? _mm256_maskload_epi32((const int*)p1, ma) : zero;
+          t1b = rows > 1 ? _mm256_maskload_epi32((const int*)(p1 + 8), mb)
+                         : zero;
+        }
+
+        __m256i e0a, e0b, e1a, e1b, v0a, v0b, v1a, v1b;
+        exp_and_val(t0a, p, e0a, v0a);
+        exp_and_val(t0b, p, e0b, v0b);
+        exp_and_val(t1a, p, e1a, v1a);
+        exp_and_val(t1b, p, e1b, v1b);
+
+        __m256i e_max_a, e_max_b, e_eq_a, e_eq_b, rho_a, rho_b;
+        quad_stats(e0a, e1a, e_max_a, e_eq_a, rho_a);
+        quad_stats(e0b, e1b, e_max_b, e_eq_b, rho_b);
+        _mm256_storeu_si256((__m256i*)(rho + q), even_lanes(rho_a, rho_b));
+        _mm256_storeu_si256((__m256i*)(qr->e_max + q),
+                            even_lanes(e_max_a, e_max_b));
+        _mm256_storeu_si256((__m256i*)(qr->e_eq + q),
+                            even_lanes(e_eq_a, e_eq_b));
+        _mm256_storeu_si256((__m256i*)(e_bl + q), even_lanes(e1a, e1b));
+        _mm256_storeu_si256((__m256i*)(e_br + q), odd_lanes(e1a, e1b));
+
+        // v_n in quad order is the two rows interleaved
+        ui32* s = qr->s + 2 * x;
+        __m256i lo = _mm256_unpacklo_epi32(v0a, v1a);
+        __m256i hi = _mm256_unpackhi_epi32(v0a, v1a);
+        _mm256_storeu_si256((__m256i*)s, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(s + 8),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+        lo = _mm256_unpacklo_epi32(v0b, v1b);
+        hi = _mm256_unpackhi_epi32(v0b, v1b);
+        _mm256_storeu_si256((__m256i*)(s + 16),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(s + 24),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+
+      // context, kappa, u_q, VLC codeword and MagSgn lengths, 8 quads at
+      // a time; the previous row's bottom samples give kappa and c_q
+      const ui32 num_quads = (width + 1) >> 1;
+      const ui32 *pe_bl = qr->e_bl[qr->cur ^ 1];
+      const ui32 *pe_br = qr->e_br[qr->cur ^ 1];
+      const __m256i one = _mm256_set1_epi32(1);
+      const __m256i two = _mm256_set1_epi32(2);
+      for (ui32 q = 0; q < num_quads; q += 8)
+      {
+        __m256i rq = _mm256_loadu_si256((__m256i*)(rho + q));
+        __m256i rl = _mm256_loadu_si256((__m256i*)(rho + q - 1));
+        __m256i c, kappa;
+        if (qr->initial)
+        {
+          c = _mm256_or_si256(_mm256_and_si256(rl, one),
+                              _mm256_srli_epi32(rl, 1));
+          kappa = one;
+        }
+        else
+        {
+          __m256i el = _mm256_loadu_si256((__m256i*)(pe_bl + q));
+          __m256i el1 = _mm256_loadu_si256((__m256i*)(pe_bl + q + 1));
+          __m256i erl = _mm256_loadu_si256((__m256i*)(pe_br + q));
+          __m256i er = _mm256_loadu_si256((__m256i*)(pe_br + q + 1));
+          __m256i max_e = _mm256_max_epi32(_mm256_max_epi32(el, el1),
+                                           _mm256_max_epi32(erl, er));
+          max_e = _mm256_sub_epi32(max_e, one);
+          __m256i cx0 = _mm256_min_epu32(_mm256_or_si256(el, erl), one);
+          __m256i cx1 = _mm256_min_epu32(_mm256_or_si256(el1, er), one);
+          __m256i cl = _mm256_or_si256(_mm256_srli_epi32(rl, 1),
+                                       _mm256_srli_epi32(rl, 2));
+          c = _mm256_or_si256(_mm256_or_si256(cx0, _mm256_slli_epi32(cx1, 2)),
+                              _mm256_and_si256(cl, two));
+          // kappa is 1 unless more than one sample is significant
+          __m256i single = _mm256_cmpeq_epi32(
+            _mm256_and_si256(rq, _mm256_sub_epi32(rq, one)),
+            _mm256_setzero_si256());
+          kappa = _mm256_blendv_epi8(_mm256_max_epi32(max_e, one), one,
+                                     single);
+        }
+        __m256i e_max = _mm256_loadu_si256((__m256i*)(qr->e_max + q));
+        __m256i U_q = _mm256_max_epi32(e_max, kappa);
+        __m256i u_q = _mm256_sub_epi32(U_q, kappa);
+        __m256i eps = _mm256_and_si256(
+          _mm256_loadu_si256((__m256i*)(qr->e_eq + q)),
+          _mm256_cmpgt_epi32(u_q, _mm256_setzero_si256()));
+
+        __m256i idx = _mm256_or_si256(_mm256_slli_epi32(c, 8),
+                                      _mm256_slli_epi32(rq, 4));
+        idx = _mm256_or_si256(idx, eps);
+        __m256i tuple = _mm256_i32gather_epi32((const int*)qr->vlc_tbl,
+                                               idx, 2);
+        tuple = _mm256_and_si256(tuple, _mm256_set1_epi32(0xFFFF));
+
+        // m_n = U_q - emb_n for significant samples, one byte per sample
+        __m256i m = _mm256_sub_epi32(
+          _mm256_mullo_epi32(U_q, _mm256_set1_epi32(0x01010101)),
+          spread_bits(_mm256_and_si256(tuple, _mm256_set1_epi32(0xF))));
+        m = _mm256_and_si256(m, _mm256_mullo_epi32(spread_bits(rq),
+                                                   _mm256_set1_epi32(0xFF)));
+
+        _mm256_storeu_si256((__m256i*)(qr->c_q + q), c);
+        _mm256_storeu_si256((__m256i*)(qr->u_q + q), u_q);
+        _mm256_storeu_si256((__m256i*)(qr->tuple + q), tuple);
+        _mm256_storeu_si256((__m256i*)(qr->ms_len + q), m);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ojph_encode_codeblock_avx2(ui32* buf, ui32 missing_msbs,
+                                    ui32 num_passes, ui32 width, ui32 height,
+                                    ui32 stride, ui32* lengths,
+                                    ojph::mem_elastic_allocator *elastic,
+                                    ojph::coded_lists *& coded)
+    {
+      ojph_encode_codeblock_vec(analyse_quad_row, buf, missing_msbs,
+                                num_passes, width, height, stride, lengths,
+                                elastic, coded);
+    }
+  }
+}
@@ -0,0 +1,258 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_avx512.cpp
+// Author: Aous Naman
+// Date: 13 May 2022
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_avx512.cpp
+ *  @brief implements a faster HTJ2K block encoder using avx512
+ *
+ *  Only the analysis of each row of quads is vectorized here; the MEL, VLC
+ *  and MagSgn bitstreams are written by ojph_encode_codeblock_vec, so the
+ *  output is identical to that of ojph_encode_codeblock.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "ojph_defs.h"
+#include "ojph_block_encoder.h"
+
+#include <immintrin.h>
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief exponent and value of 16 samples
+     *
+     *  e is the number of bits in 2 mu_p - 1 and v is 2(mu_p - 1) + s_n;
+     *  both are zero for insignificant samples.
+     */
+    static inline void
+    exp_and_val(__m512i t, __m128i p, __m512i& e, __m512i& v)
+    {
+      const __m512i one = _mm512_set1_epi32(1);
+      __m512i val = _mm512_add_epi32(t, t);      // get rid of sign
+      val = _mm512_srl_epi32(val, p);            // 2 \mu_p + x
+      val = _mm512_andnot_si512(one, val);       // 2 \mu_p
+      __mmask16 sig = _mm512_test_epi32_mask(val, val);
+
+      __m512i lz = _mm512_lzcnt_epi32(_mm512_sub_epi32(val, one));
+      e = _mm512_maskz_sub_epi32(sig, _mm512_set1_epi32(32), lz);
+
+      // v_n = 2(\mu_p-1) + s_n
+      __m512i s = _mm512_add_epi32(_mm512_sub_epi32(val, _mm512_set1_epi32(2)),
+                                   _mm512_srli_epi32(t, 31));
+      v = _mm512_maskz_mov_epi32(sig, s);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief per-quad E_max, samples equal to E_max and rho for 8 quads
+     *
+     *  Column pairs of the two rows form quads; results are in the even
+     *  lanes.  Samples are numbered top-left, bottom-left, top-right and
+     *  bottom-right.
+     */
+    static inline void
+    quad_stats(__m512i e0, __m512i e1, __m512i& e_max, __m512i& e_eq,
+               __m512i& rho)
+    {
+      const __m512i w0 = _mm512_set4_epi32(4, 1, 4, 1);
+      const __m512i w1 = _mm512_set4_epi32(8, 2, 8, 2);
+
+      __m512i m = _mm512_max_epi32(e0, e1);
+      m = _mm512_max_epi32(m, _mm512_srli_epi64(m, 32));
+      e_max = _mm512_shuffle_epi32(m, _MM_PERM_CCAA);
+
+      __m512i t = _mm512_or_si512(
+        _mm512_maskz_mov_epi32(_mm512_cmpeq_epi32_mask(e0, e_max), w0),
+        _mm512_maskz_mov_epi32(_mm512_cmpeq_epi32_mask(e1, e_max), w1));
+      e_eq = _mm512_add_epi32(t, _mm512_srli_epi64(t, 32));
+
+      t = _mm512_or_si512(
+        _mm512_maskz_mov_epi32(_mm512_test_epi32_mask(e0, e0), w0),
+        _mm512_maskz_mov_epi32(_mm512_test_epi32_mask(e1, e1), w1));
+      rho = _mm512_add_epi32(t, _mm512_srli_epi64(t, 32));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // spreads the 4 low bits of each lane to the 4 bytes of that lane
+    static inline __m512i
+    spread_bits(__m512i x)
+    {
+      x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x00204081));
+      return _mm512_and_si512(x, _mm512_set1_epi32(0x01010101));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void
+    analyse_quad_row(enc_quad_row* qr, const ui32* sp, ui32 rows)
+    {
+      const ui32 width = qr->width;
+      const __m128i p = _mm_cvtsi32_si128((int)qr->p);
+      ui32 *rho = qr->rho();
+      ui32 *e_bl = qr->e_bl[qr->cur], *e_br = qr->e_br[qr->cur] + 1;
+
+      const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                             16, 18, 20, 22, 24, 26, 28, 30);
+      const __m512i odd = _mm512_add_epi32(even, _mm512_set1_epi32(1));
+      const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19,
+                                           4, 20, 5, 21, 6, 22, 7, 23);
+      const __m512i hi = _mm512_add_epi32(lo, _mm512_set1_epi32(8));
+
+      // samples to quads, 32 columns (16 quads) at a time
+      for (ui32 x = 0, q = 0; x < width; x += 32, q += 16)
+      {
+        const ui32* p0 = sp + x;
+        const ui32* p1 = p0 + qr->stride;
+        // masked loads do not touch memory beyond the row
+        ui32 n = ojph_min(width - x, 32u);
+        __mmask16 ma = (__mmask16)(n >= 16 ? 0xFFFF : (1u << n) - 1);
+        __mmask16 mb = (__mmask16)(n >= 32 ? 0xFFFF
+                                   : n > 16 ? (1u << (n - 16)) - 1 : 0);
+        __mmask16 m1a = rows > 1 ? ma : 0, m1b = rows > 1 ? mb : 0;
+        __m512i t0a = _mm512_maskz_loadu_epi32(ma, p0);
+        __m512i t0b = _mm512_maskz_loadu_epi32(mb, p0 + 16);
+        __m512i t1a = _mm512_maskz_loadu_epi32(m1a, p1);
+        __m512i t1b = _mm512_maskz_loadu_epi32(m1b, p1 + 16);
+
+        __m512i e0a, e0b, e1a, e1b, v0a, v0b, v1a, v1b;
+        exp_and_val(t0a, p, e0a, v0a);
+        exp_and_val(t0b, p, e0b, v0b);
+        exp_and_val(t1a, p, e1a, v1a);
+        exp_and_val(t1b, p, e1b, v1b);
+
+        __m512i e_max_a, e_max_b, e_eq_a, e_eq_b, rho_a, rho_b;
+        quad_stats(e0a, e1a, e_max_a, e_eq_a, rho_a);
+        quad_stats(e0b, e1b, e_max_b, e_eq_b, rho_b);
+        _mm512_storeu_si512(rho + q,
+                            _mm512_permutex2var_epi32(rho_a, even, rho_b));
+        _mm512_storeu_si512(qr->e_max + q,
+                            _mm512_permutex2var_epi32(e_max_a, even, e_max_b));
+        _mm512_storeu_si512(qr->e_eq + q,
+                            _mm512_permutex2var_epi32(e_eq_a, even, e_eq_b));
+        _mm512_storeu_si512(e_bl + q,
+                            _mm512_permutex2var_epi32(e1a, even, e1b));
+        _mm512_storeu_si512(e_br + q,
+                            _mm512_permutex2var_epi32(e1a, odd, e1b));
+
+        // v_n in quad order is the two rows interleaved
+        ui32* s = qr->s + 2 * x;
+        _mm512_storeu_si512(s, _mm512_permutex2var_epi32(v0a, lo, v1a));
+        _mm512_storeu_si512(s + 16, _mm512_permutex2var_epi32(v0a, hi, v1a));
+        _mm512_storeu_si512(s + 32, _mm512_permutex2var_epi32(v0b, lo, v1b));
+        _mm512_storeu_si512(s + 48, _mm512_permutex2var_epi32(v0b, hi, v1b));
+      }
+
+      // context, kappa, u_q, VLC codeword and MagSgn lengths, 16 quads at
+      // a time; the previous row's bottom samples give kappa and c_q
+      const ui32 num_quads = (width + 1) >> 1;
+      const ui32 *pe_bl = qr->e_bl[qr->cur ^ 1];
+      const ui32 *pe_br = qr->e_br[qr->cur ^ 1];
+      const __m512i one = _mm512_set1_epi32(1);
+      const __m512i two = _mm512_set1_epi32(2);
+      for (ui32 q = 0; q < num_quads; q += 16)
+      {
+        __m512i rq = _mm512_loadu_si512(rho + q);
+        __m512i rl = _mm512_loadu_si512(rho + q - 1);
+        __m512i c, kappa;
+        if (qr->initial)
+        {
+          c = _mm512_or_si512(_mm512_and_si512(rl, one),
+                              _mm512_srli_epi32(rl, 1));
+          kappa = one;
+        }
+        else
+        {
+          __m512i el = _mm512_loadu_si512(pe_bl + q);
+          __m512i el1 = _mm512_loadu_si512(pe_bl + q + 1);
+          __m512i erl = _mm512_loadu_si512(pe_br + q);
+          __m512i er = _mm512_loadu_si512(pe_br + q + 1);
+          __m512i max_e = _mm512_max_epi32(_mm512_max_epi32(el, el1),
+                                           _mm512_max_epi32(erl, er));
+          max_e = _mm512_sub_epi32(max_e, one);
+          __m512i cx0 = _mm512_min_epu32(_mm512_or_si512(el, erl), one);
+          __m512i cx1 = _mm512_min_epu32(_mm512_or_si512(el1, er), one);
+          __m512i cl = _mm512_or_si512(_mm512_srli_epi32(rl, 1),
+                                       _mm512_srli_epi32(rl, 2));
+          c = _mm512_or_si512(_mm512_or_si512(cx0, _mm512_slli_epi32(cx1, 2)),
+                              _mm512_and_si512(cl, two));
+          // kappa is 1 unless more than one sample is significant
+          __mmask16 multi = _mm512_test_epi32_mask(
+            rq, _mm512_sub_epi32(rq, one));
+          kappa = _mm512_mask_max_epi32(one, multi, max_e, one);
+        }
+        __m512i e_max = _mm512_loadu_si512(qr->e_max + q);
+        __m512i U_q = _mm512_max_epi32(e_max, kappa);
+        __m512i u_q = _mm512_sub_epi32(U_q, kappa);
+        __m512i eps = _mm512_maskz_loadu_epi32(
+          _mm512_cmpgt_epi32_mask(u_q, _mm512_setzero_si512()),
+          qr->e_eq + q);
+
+        __m512i idx = _mm512_or_si512(_mm512_slli_epi32(c, 8),
+                                      _mm512_slli_epi32(rq, 4));
+        idx = _mm512_or_si512(idx, eps);
+        __m512i tuple = _mm512_i32gather_epi32(idx, qr->vlc_tbl, 2);
+        tuple = _mm512_and_si512(tuple, _mm512_set1_epi32(0xFFFF));
+
+        // m_n = U_q - emb_n for significant samples, one byte per sample
+        __m512i m = _mm512_sub_epi32(
+          _mm512_mullo_epi32(U_q, _mm512_set1_epi32(0x01010101)),
+          spread_bits(_mm512_and_si512(tuple, _mm512_set1_epi32(0xF))));
+        m = _mm512_and_si512(m, _mm512_mullo_epi32(spread_bits(rq),
+                                                   _mm512_set1_epi32(0xFF)));
+
+        _mm512_storeu_si512(qr->c_q + q, c);
+        _mm512_storeu_si512(qr->u_q + q, u_q);
+        _mm512_storeu_si512(qr->tuple + q, tuple);
+        _mm512_storeu_si512(qr->ms_len + q, m);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ojph_encode_codeblock_avx512(ui32* buf, ui32 missing_msbs,
+                                      ui32 num_passes, ui32 width,
+                                      ui32 height, ui32 stride,
+                                      ui32* lengths,
+                                      ojph::mem_elastic_allocator *elastic,
+                                      ojph::coded_lists *& coded)
+    {
+      ojph_encode_codeblock_vec(analyse_quad_row, buf, missing_msbs,
+                                num_passes, width, height, stride, lengths,
+                                elastic, coded);
+    }
+  }
+}
@@ -0,0 +1,282 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_sse41.cpp
+// Author: Aous Naman
+// Date: 13 May 2022
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_sse41.cpp
+ *  @brief implements a faster HTJ2K block encoder using sse4.1
+ *
+ *  Only the analysis of each row of quads is vectorized here; the MEL, VLC
+ *  and MagSgn bitstreams are written by ojph_encode_codeblock_vec, so the
+ *  output is identical to that of ojph_encode_codeblock.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "ojph_defs.h"
+#include "ojph_block_encoder.h"
+
+#include <smmintrin.h>
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief exponent and value of 4 samples
+     *
+     *  e is the number of bits in 2 mu_p - 1 and v is 2(mu_p - 1) + s_n;
+     *  both are zero for insignificant samples.  Since the float
+     *  conversion rounds, bits that are followed by a set bit are cleared
+     *  first, so that the exponent of the float is that of the leading bit.
+     */
+    static inline void
+    exp_and_val(__m128i t, __m128i p, __m128i& e, __m128i& v)
+    {
+      const __m128i one = _mm_set1_epi32(1);
+      __m128i val = _mm_add_epi32(t, t);      // get rid of sign
+      val = _mm_srl_epi32(val, p);            // 2 \mu_p + x
+      val = _mm_andnot_si128(one, val);       // 2 \mu_p
+      __m128i insig = _mm_cmpeq_epi32(val, _mm_setzero_si128());
+
+      // bits in (2 \mu_p - 1) = 1 + bits in (\mu_p - 1)
+      __m128i w = _mm_sub_epi32(_mm_srli_epi32(val, 1), one);
+      w = _mm_andnot_si128(_mm_srli_epi32(w, 1), w);
+      __m128i f = _mm_castps_si128(_mm_cvtepi32_ps(w));
+      __m128i bits = _mm_sub_epi32(_mm_srli_epi32(f, 23),
+                                   _mm_set1_epi32(126));
+      bits = _mm_max_epi32(bits, _mm_setzero_si128());
+      e = _mm_andnot_si128(insig, _mm_add_epi32(bits, one));
+
+      // v_n = 2(\mu_p-1) + s_n
+      __m128i s = _mm_add_epi32(_mm_sub_epi32(val, _mm_set1_epi32(2)),
+                                _mm_srli_epi32(t, 31));
+      v = _mm_andnot_si128(insig, s);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // gathers the even (or odd) 32-bit lanes of a and b
+    static inline __m128i
+    even_lanes(__m128i a, __m128i b)
+    {
+      return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a),
+                                             _mm_castsi128_ps(b),
+                                             _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    static inline __m128i
+    odd_lanes(__m128i a, __m128i b)
+    {
+      return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a),
+                                             _mm_castsi128_ps(b),
+                                             _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /** @brief per-quad E_max, samples equal to E_max and rho for 2 quads
+     *
+     *  Column pairs of the two rows form quads; results are in the even
+     *  lanes.  Samples are numbered top-left, bottom-left, top-right and
+     *  bottom-right.
+     */
+    static inline void
+    quad_stats(__m128i e0, __m128i e1, __m128i& e_max, __m128i& e_eq,
+               __m128i& rho)
+    {
+      const __m128i w0 = _mm_setr_epi32(1, 4, 1, 4);
+      const __m128i w1 = _mm_setr_epi32(2, 8, 2, 8);
+      const __m128i zero = _mm_setzero_si128();
+
+      __m128i m = _mm_max_epi32(e0, e1);
+      m = _mm_max_epi32(m, _mm_srli_epi64(m, 32));
+      e_max = _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 2, 0, 0));
+
+      __m128i t = _mm_or_si128(
+        _mm_and_si128(_mm_cmpeq_epi32(e0, e_max), w0),
+        _mm_and_si128(_mm_cmpeq_epi32(e1, e_max), w1));
+      e_eq = _mm_add_epi32(t, _mm_srli_epi64(t, 32));
+
+      t = _mm_or_si128(
+        _mm_andnot_si128(_mm_cmpeq_epi32(e0, zero), w0),
+        _mm_andnot_si128(_mm_cmpeq_epi32(e1, zero), w1));
+      rho = _mm_add_epi32(t, _mm_srli_epi64(t, 32));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // spreads the 4 low bits of each lane to the 4 bytes of that lane
+    static inline __m128i
+    spread_bits(__m128i x)
+    {
+      x = _mm_mullo_epi32(x, _mm_set1_epi32(0x00204081));
+      return _mm_and_si128(x, _mm_set1_epi32(0x01010101));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void
+    analyse_quad_row(enc_quad_row* qr, const ui32* sp, ui32 rows)
+    {
+      const ui32 width = qr->width;
+      const __m128i p = _mm_cvtsi32_si128((int)qr->p);
+      ui32 *rho = qr->rho();
+      ui32 *e_bl = qr->e_bl[qr->cur], *e_br = qr->e_br[qr->cur] + 1;
+
+      // samples to quads, 8 columns (4 quads) at a time
+      for (ui32 x = 0, q = 0; x < width; x += 8, q += 4)
+      {
+        const ui32* p0 = sp + x;
+        const ui32* p1 = p0 + qr->stride;
+        ui32 tail[2][8];
+        if (x + 8 > width)
+        {
+          // copy the end of the row, so as not to read beyond it
+          memset(tail, 0, sizeof(tail));
+          memcpy(tail[0], p0, (width - x) * sizeof(ui32));
+          if (rows > 1)
+            memcpy(tail[1], p1, (width - x) * sizeof(ui32));
+          p0 = tail[0];
+          p1 = tail[1];
+        }
+        __m128i zero = _mm_setzero_si128();
+        __m128i t0a = _mm_loadu_si128((__m128i*)p0);
+        __m128i t0b = _mm_loadu_si128((__m128i*)(p0 + 4));
+        __m128i t1a = rows > 1 ? _mm_loadu_si128((__m128i*)p1) : zero;
+        __m128i t1b = rows > 1 ? _mm_loadu_si128((__m128i*)(p1 + 4)) : zero;
+
+        __m128i e0a, e0b, e1a, e1b, v0a, v0b, v1a, v1b;
+        exp_and_val(t0a, p, e0a, v0a);
+        exp_and_val(t0b, p, e0b, v0b);
+        exp_and_val(t1a, p, e1a, v1a);
+        exp_and_val(t1b, p, e1b, v1b);
+
+        __m128i e_max_a, e_max_b, e_eq_a, e_eq_b, rho_a, rho_b;
+        quad_stats(e0a, e1a, e_max_a, e_eq_a, rho_a);
+        quad_stats(e0b, e1b, e_max_b, e_eq_b, rho_b);
+        _mm_storeu_si128((__m128i*)(rho + q), even_lanes(rho_a, rho_b));
+        _mm_storeu_si128((__m128i*)(qr->e_max + q),
+                         even_lanes(e_max_a, e_max_b));
+        _mm_storeu_si128((__m128i*)(qr->e_eq + q),
+                         even_lanes(e_eq_a, e_eq_b));
+        _mm_storeu_si128((__m128i*)(e_bl + q), even_lanes(e1a, e1b));
+        _mm_storeu_si128((__m128i*)(e_br + q), odd_lanes(e1a, e1b));
+
+        // v_n in quad order is the two rows interleaved
+        ui32* s = qr->s + 2 * x;
+        _mm_storeu_si128((__m128i*)s, _mm_unpacklo_epi32(v0a, v1a));
+        _mm_storeu_si128((__m128i*)(s + 4), _mm_unpackhi_epi32(v0a, v1a));
+        _mm_storeu_si128((__m128i*)(s + 8), _mm_unpacklo_epi32(v0b, v1b));
+        _mm_storeu_si128((__m128i*)(s + 12), _mm_unpackhi_epi32(v0b, v1b));
+      }
+
+      // context, kappa, u_q, VLC codeword and MagSgn lengths, 4 quads at
+      // a time; the previous row's bottom samples give kappa and c_q
+      const ui32 num_quads = (width + 1) >> 1;
+      const ui32 *pe_bl = qr->e_bl[qr->cur ^ 1];
+      const ui32 *pe_br = qr->e_br[qr->cur ^ 1];
+      const __m128i one = _mm_set1_epi32(1);
+      const __m128i two = _mm_set1_epi32(2);
+      for (ui32 q = 0; q < num_quads; q += 4)
+      {
+        __m128i rq = _mm_loadu_si128((__m128i*)(rho + q));
+        __m128i rl = _mm_loadu_si128((__m128i*)(rho + q - 1));
+        __m128i c, kappa;
+        if (qr->initial)
+        {
+          c = _mm_or_si128(_mm_and_si128(rl, one), _mm_srli_epi32(rl, 1));
+          kappa = one;
+        }
+        else
+        {
+          __m128i el = _mm_loadu_si128((__m128i*)(pe_bl + q));
+          __m128i el1 = _mm_loadu_si128((__m128i*)(pe_bl + q + 1));
+          __m128i erl = _mm_loadu_si128((__m128i*)(pe_br + q));
+          __m128i er = _mm_loadu_si128((__m128i*)(pe_br + q + 1));
+          __m128i max_e = _mm_max_epi32(_mm_max_epi32(el, el1),
+                                        _mm_max_epi32(erl, er));
+          max_e = _mm_sub_epi32(max_e, one);
+          __m128i cx0 = _mm_min_epu32(_mm_or_si128(el, erl), one);
+          __m128i cx1 = _mm_min_epu32(_mm_or_si128(el1, er), one);
+          __m128i cl = _mm_or_si128(_mm_srli_epi32(rl, 1),
+                                    _mm_srli_epi32(rl, 2));
+          c = _mm_or_si128(_mm_or_si128(cx0, _mm_slli_epi32(cx1, 2)),
+                           _mm_and_si128(cl, two));
+          // kappa is 1 unless more than one sample is significant
+          __m128i single = _mm_cmpeq_epi32(
+            _mm_and_si128(rq, _mm_sub_epi32(rq, one)), _mm_setzero_si128());
+          kappa = _mm_blendv_epi8(_mm_max_epi32(max_e, one), one, single);
+        }
+        __m128i e_max = _mm_loadu_si128((__m128i*)(qr->e_max + q));
+        __m128i U_q = _mm_max_epi32(e_max, kappa);
+        __m128i u_q = _mm_sub_epi32(U_q, kappa);
+        __m128i eps = _mm_and_si128(
+          _mm_loadu_si128((__m128i*)(qr->e_eq + q)),
+          _mm_cmpgt_epi32(u_q, _mm_setzero_si128()));
+
+        __m128i idx = _mm_or_si128(_mm_slli_epi32(c, 8),
+                                   _mm_slli_epi32(rq, 4));
+        idx = _mm_or_si128(idx, eps);
+        const ui16* tbl = qr->vlc_tbl;
+        __m128i tuple = _mm_setr_epi32(tbl[_mm_extract_epi32(idx, 0)],
+                                       tbl[_mm_extract_epi32(idx, 1)],
+                                       tbl[_mm_extract_epi32(idx, 2)],
+                                       tbl[_mm_extract_epi32(idx, 3)]);
+
+        // m_n = U_q - emb_n for significant samples, one byte per sample
+        __m128i m = _mm_sub_epi32(
+          _mm_mullo_epi32(U_q, _mm_set1_epi32(0x01010101)),
+          spread_bits(_mm_and_si128(tuple, _mm_set1_epi32(0xF))));
+        m = _mm_and_si128(m, _mm_mullo_epi32(spread_bits(rq),
+                                             _mm_set1_epi32(0xFF)));
+
+        _mm_storeu_si128((__m128i*)(qr->c_q + q), c);
+        _mm_storeu_si128((__m128i*)(qr->u_q + q), u_q);
+        _mm_storeu_si128((__m128i*)(qr->tuple + q), tuple);
+        _mm_storeu_si128((__m128i*)(qr->ms_len + q), m);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ojph_encode_codeblock_sse41(ui32* buf, ui32 missing_msbs,
+                                     ui32 num_passes, ui32 width, ui32 height,
+                                     ui32 stride, ui32* lengths,
+                                     ojph::mem_elastic_allocator *elastic,
+                                     ojph::coded_lists *& coded)
+    {
+      ojph_encode_codeblock_vec(analyse_quad_row, buf, missing_msbs,
+                                num_passes, width, height, stride, lengths,
+                                elastic, coded);
+    }
+  }
+}
@@ -59,6 +59,14 @@
 #define OJPH_EMSCRIPTEN
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// preprocessor directives for architecture
+///////////////////////////////////////////////////////////////////////////////
+#if (defined __x86_64__) || (defined _M_X64) || (defined __i386__) \
+  || (defined _M_IX86)
+#define OJPH_ARCH_X86
+#endif
+
 #ifdef OJPH_COMPILER_MSVC
 #include <intrin.h>
 #endif
@@ -103,7 +111,8 @@ namespace ojph {
     X86_CPU_EXT_LEVEL_AVX = 8,
     X86_CPU_EXT_LEVEL_AVX2 = 9,
     X86_CPU_EXT_LEVEL_AVX2FMA = 10,
-    X86_CPU_EXT_LEVEL_AVX512 = 11,
+    X86_CPU_EXT_LEVEL_AVX512 = 11,       // F, CD, BW, DQ and VL
+    X86_CPU_EXT_LEVEL_AVX512_VBMI2 = 12, // AVX512 plus VBMI2
   };
 
   /////////////////////////////////////////////////////////////////////////////
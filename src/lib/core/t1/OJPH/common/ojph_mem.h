@@ -195,6 +195,9 @@ namespace ojph {
     }
 
     void get_buffer(ui32 needed_bytes, coded_lists*& p);
+    // make all allocated memory available again; buffers obtained
+    // before the restart must no longer be used
+    void restart();
 
   private:
     struct stores_list
@@ -202,7 +205,7 @@ namespace ojph {
       stores_list(ui32 available_bytes)
       {
         this->next_store = NULL;
-        this->available = available_bytes;
+        this->size = this->available = available_bytes;
         this->data = (ui8*)this + sizeof(stores_list);
       }
       static ui32 eval_store_bytes(ui32 available_bytes) 
@@ -210,6 +213,7 @@ namespace ojph {
         return available_bytes + (ui32)sizeof(stores_list);
       }
       stores_list *next_store;
+      ui32 size;
       ui32 available;
       ui8* data;
     };
@@ -0,0 +1,151 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_arch.cpp
+// Author: Aous Naman
+// Date: 28 August 2019
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+namespace ojph {
+
+#ifdef OJPH_ARCH_X86
+
+  ////////////////////////////////////////////////////////////////////////////
+  // runs cpuid with eax = leaf and ecx = subleaf, and stores the
+  // results in abcd (eax, ebx, ecx, edx)
+  static void run_cpuid(ui32 leaf, ui32 subleaf, ui32 *abcd)
+  {
+  #ifdef OJPH_COMPILER_MSVC
+    int regs[4];
+    __cpuidex(regs, (int)leaf, (int)subleaf);
+    for (int i = 0; i < 4; ++i)
+      abcd[i] = (ui32)regs[i];
+  #else
+    ui32 eax = leaf, ebx = 0, ecx = subleaf, edx = 0;
+  #if (defined __i386__) && (defined __PIC__)
+    // ebx holds the GOT pointer, and cannot be clobbered
+    __asm__ ("movl %%ebx, %%edi \n\t cpuid \n\t xchgl %%ebx, %%edi"
+             : "=D" (ebx), "+a" (eax), "+c" (ecx), "=d" (edx));
+  #else
+    __asm__ ("cpuid" : "+b" (ebx), "+a" (eax), "+c" (ecx), "=d" (edx));
+  #endif
+    abcd[0] = eax; abcd[1] = ebx; abcd[2] = ecx; abcd[3] = edx;
+  #endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // reads extended control register index; only valid when OSXSAVE is set
+  static ui64 read_xcr(ui32 index)
+  {
+  #ifdef OJPH_COMPILER_MSVC
+    return _xgetbv(index);
+  #else
+    ui32 eax = 0, edx = 0;
+    __asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+    return ((ui64)edx << 32) | eax;
+  #endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static int init_cpu_ext_level()
+  {
+    ui32 abcd[4];
+    run_cpuid(0, 0, abcd);
+    ui32 max_leaf = abcd[0];
+    if (max_leaf < 1)
+      return X86_CPU_EXT_LEVEL_GENERIC;
+
+    run_cpuid(1, 0, abcd);
+    const ui32 ecx1 = abcd[2], edx1 = abcd[3];
+    if (!(edx1 & (1u << 23)))
+      return X86_CPU_EXT_LEVEL_GENERIC;
+    if (!(edx1 & (1u << 25)))
+      return X86_CPU_EXT_LEVEL_MMX;
+    if (!(edx1 & (1u << 26)))
+      return X86_CPU_EXT_LEVEL_SSE;
+    if (!(ecx1 & (1u << 0)))
+      return X86_CPU_EXT_LEVEL_SSE2;
+    if (!(ecx1 & (1u << 9)))
+      return X86_CPU_EXT_LEVEL_SSE3;
+    if (!(ecx1 & (1u << 19)))
+      return X86_CPU_EXT_LEVEL_SSSE3;
+    if (!(ecx1 & (1u << 20)))
+      return X86_CPU_EXT_LEVEL_SSE41;
+
+    // AVX requires that the OS saves the YMM state on context switches
+    bool osxsave = (ecx1 & (1u << 27)) != 0;
+    ui64 xcr0 = osxsave ? read_xcr(0) : 0;
+    if (!(ecx1 & (1u << 28)) || (xcr0 & 0x6) != 0x6)
+      return X86_CPU_EXT_LEVEL_SSE42;
+    if (max_leaf < 7)
+      return X86_CPU_EXT_LEVEL_AVX;
+
+    run_cpuid(7, 0, abcd);
+    const ui32 ebx7 = abcd[1], ecx7 = abcd[2];
+    if (!(ebx7 & (1u << 5)))
+      return X86_CPU_EXT_LEVEL_AVX;
+    if (!(ecx1 & (1u << 12)))
+      return X86_CPU_EXT_LEVEL_AVX2;
+
+    // AVX-512 additionally requires the opmask and ZMM states
+    const ui32 avx512_mask = (1u << 16)  // F
+                           | (1u << 17)  // DQ
+                           | (1u << 28)  // CD
+                           | (1u << 30)  // BW
+                           | (1u << 31); // VL
+    if ((ebx7 & avx512_mask) != avx512_mask || (xcr0 & 0xE6) != 0xE6)
+      return X86_CPU_EXT_LEVEL_AVX2FMA;
+    if (!(ecx7 & (1u << 6)))
+      return X86_CPU_EXT_LEVEL_AVX512;
+    return X86_CPU_EXT_LEVEL_AVX512_VBMI2;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  int get_cpu_ext_level()
+  {
+    static const int level = init_cpu_ext_level();
+    return level;
+  }
+
+#else // !OJPH_ARCH_X86
+
+  ////////////////////////////////////////////////////////////////////////////
+  int get_cpu_ext_level()
+  {
+    return X86_CPU_EXT_LEVEL_GENERIC;
+  }
+
+#endif // !OJPH_ARCH_X86
+
+}
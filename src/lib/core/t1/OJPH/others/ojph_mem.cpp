@@ -119,6 +119,10 @@ namespace ojph {
       total_allocated += store_bytes;
     }
 
+    // after a restart, later stores may already be allocated
+    while (cur_store->available < extended_bytes && cur_store->next_store)
+      cur_store = cur_store->next_store;
+
     if (cur_store->available < extended_bytes)
     {
       ui32 bytes = ojph_max(extended_bytes, chunk_size);
@@ -135,4 +139,15 @@ namespace ojph {
     cur_store->data += extended_bytes;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_elastic_allocator::restart()
+  {
+    for (stores_list* s = store; s; s = s->next_store)
+    {
+      s->available = s->size;
+      s->data = (ui8*)s + sizeof(stores_list);
+    }
+    cur_store = store;
+  }
+
 }
@@ -23,12 +23,13 @@
 namespace grk
 {
 T1Interface* T1Factory::makeT1(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
-							   uint32_t maxCblkH)
+							   uint32_t maxCblkH, GRK_T1_DECODER t1Decoder)
 {
 	if(tcp->isHT())
 		return new ojph::T1OJPH(isCompressor, tcp, maxCblkW, maxCblkH);
 	else
-		return new t1_part1::T1Part1(isCompressor, maxCblkW, maxCblkH);
+		return new t1_part1::T1Part1(isCompressor, maxCblkW, maxCblkH,
+									 t1Decoder == GRK_T1_DECODER_REFERENCE);
 }
 
 Quantizer* T1Factory::makeQuantizer(bool ht, bool reversible, uint8_t guardBits)
@@ -24,8 +24,18 @@ namespace grk
 class T1Factory
 {
   public:
+	/**
+	 * Create block coder
+	 *
+	 * @param isCompressor true for compression
+	 * @param tcp tile coding parameters
+	 * @param maxCblkW maximum code block width
+	 * @param maxCblkH maximum code block height
+	 * @param t1Decoder Part 1 decoder engine, ignored for compression and HTJ2K
+	 * @return block coder
+	 */
 	static T1Interface* makeT1(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
-							   uint32_t maxCblkH);
+							   uint32_t maxCblkH, GRK_T1_DECODER t1Decoder = GRK_T1_DECODER_LUT);
 	static Quantizer* makeQuantizer(bool ht, bool reversible, uint8_t guardBits);
 };
 
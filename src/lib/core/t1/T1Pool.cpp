@@ -0,0 +1,49 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+namespace grk
+{
+T1Pool::~T1Pool()
+{
+	for(auto& c : coders_)
+	{
+		for(auto t1 : c.second)
+			delete t1;
+	}
+}
+std::vector<T1Interface*>* T1Pool::get(bool isCompressor, TileCodingParams* tcp,
+									   uint32_t maxCblkW, uint32_t maxCblkH)
+{
+	uint64_t key = ((uint64_t)maxCblkW << 32) | ((uint64_t)maxCblkH << 2) |
+				   ((uint64_t)tcp->isHT() << 1) | (uint64_t)isCompressor;
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto iter = coders_.find(key);
+	if(iter != coders_.end())
+		return &iter->second;
+	auto& coders = coders_[key];
+	for(auto i = 0U; i < ExecSingleton::get()->num_workers(); ++i)
+		coders.push_back(T1Factory::makeT1(isCompressor, tcp, maxCblkW, maxCblkH, t1Decoder_));
+
+	return &coders;
+}
+void T1Pool::setT1Decoder(GRK_T1_DECODER t1Decoder)
+{
+	t1Decoder_ = t1Decoder;
+}
+
+} // namespace grk
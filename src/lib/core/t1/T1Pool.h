@@ -0,0 +1,64 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace grk
+{
+/**
+ * T1 coders shared by all tiles of a single compress or decompress call.
+ *
+ * Each executor worker owns one coder per coder configuration, so coder buffers
+ * are allocated once per worker, rather than once per worker for every tile component.
+ */
+class T1Pool
+{
+  public:
+	T1Pool(void) = default;
+	~T1Pool();
+
+	/**
+	 * Get coders for a configuration, creating them on first use
+	 *
+	 * @param isCompressor true for compression
+	 * @param tcp tile coding parameters
+	 * @param maxCblkW maximum code block width
+	 * @param maxCblkH maximum code block height
+	 * @return one coder per executor worker : the coder at index i
+	 * must only be used by worker i
+	 */
+	std::vector<T1Interface*>* get(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
+								   uint32_t maxCblkH);
+
+	/**
+	 * Set Part 1 decoder engine. Must be called before any coders are created.
+	 *
+	 * @param t1Decoder decoder engine
+	 */
+	void setT1Decoder(GRK_T1_DECODER t1Decoder);
+
+  private:
+	GRK_T1_DECODER t1Decoder_ = GRK_T1_DECODER_LUT;
+	std::map<uint64_t, std::vector<T1Interface*>> coders_;
+	std::mutex mutex_;
+};
+
+} // namespace grk
@@ -0,0 +1,159 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+#include "PostT1DecompressFilters.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/part1/PostT1DecompressFilters.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/**
+	 * Apply vector filter to a row of code block samples.
+	 * The partial vector at the end of the row is filtered through a scratch
+	 * buffer, so that neither source nor destination is touched beyond the row.
+	 */
+	template<typename F, typename D>
+	void filterRow(F filter, D* dest, const int32_t* src, uint32_t len)
+	{
+		const HWY_FULL(int32_t) di;
+		const HWY_FULL(D) dd;
+		const size_t N = Lanes(di);
+		size_t i = 0;
+		for(; i + N <= len; i += N)
+			StoreU(filter(LoadU(di, src + i)), dd, dest + i);
+		if(i < len)
+		{
+			HWY_ALIGN int32_t in[MaxLanes(di)] = {};
+			HWY_ALIGN D out[MaxLanes(dd)];
+			memcpy(in, src + i, (len - i) * sizeof(int32_t));
+			Store(filter(Load(di, in)), dd, out);
+			memcpy(dest + i, out, (len - i) * sizeof(D));
+		}
+	}
+
+	using VecI32 = Vec<HWY_FULL(int32_t)>;
+
+	/**
+	 * Undo region of interest max shift: magnitudes at or above the threshold
+	 * are shifted back down
+	 */
+	static HWY_INLINE VecI32 roiUnshift(VecI32 val, int roiShift)
+	{
+		const HWY_FULL(int32_t) di;
+		auto mag = Abs(val);
+		auto shifted = ShiftRightSame(mag, roiShift);
+		shifted = IfNegativeThenElse(val, Neg(shifted), shifted);
+		return IfThenElse(mag >= Set(di, 1 << roiShift), shifted, val);
+	}
+
+	// division by 2, rounding towards zero
+	static HWY_INLINE VecI32 halve(VecI32 val)
+	{
+		return ShiftRight<1>(Sub(val, ShiftRight<31>(val)));
+	}
+
+	struct Shift
+	{
+		VecI32 operator()(VecI32 val) const
+		{
+			return halve(val);
+		}
+	};
+	struct RoiShift
+	{
+		int roiShift;
+		VecI32 operator()(VecI32 val) const
+		{
+			return halve(roiUnshift(val, roiShift));
+		}
+	};
+	struct Scale
+	{
+		float scale;
+		Vec<HWY_FULL(float)> operator()(VecI32 val) const
+		{
+			const HWY_FULL(float) df;
+			return Mul(ConvertTo(df, val), Set(df, scale));
+		}
+	};
+	struct RoiScale
+	{
+		int roiShift;
+		float scale;
+		Vec<HWY_FULL(float)> operator()(VecI32 val) const
+		{
+			const HWY_FULL(float) df;
+			return Mul(ConvertTo(df, roiUnshift(val, roiShift)), Set(df, scale));
+		}
+	};
+
+	void hwy_shift_filter(int32_t* dest, const int32_t* src, uint32_t len)
+	{
+		filterRow(Shift(), dest, src, len);
+	}
+	void hwy_roi_shift_filter(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift)
+	{
+		filterRow(RoiShift{(int)roiShift}, dest, src, len);
+	}
+	void hwy_scale_filter(float* dest, const int32_t* src, uint32_t len, float scale)
+	{
+		filterRow(Scale{scale}, dest, src, len);
+	}
+	void hwy_roi_scale_filter(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+							  float scale)
+	{
+		filterRow(RoiScale{(int)roiShift, scale}, dest, src, len);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_shift_filter);
+HWY_EXPORT(hwy_roi_shift_filter);
+HWY_EXPORT(hwy_scale_filter);
+HWY_EXPORT(hwy_roi_scale_filter);
+
+void postT1Shift(int32_t* dest, const int32_t* src, uint32_t len)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_shift_filter)(dest, src, len);
+}
+void postT1RoiShift(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_roi_shift_filter)(dest, src, len, roiShift);
+}
+void postT1Scale(float* dest, const int32_t* src, uint32_t len, float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_scale_filter)(dest, src, len, scale);
+}
+void postT1RoiScale(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+					float scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_roi_scale_filter)(dest, src, len, roiShift, scale);
+}
+
+} // namespace grk
+#endif
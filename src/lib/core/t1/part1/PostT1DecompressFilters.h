@@ -4,6 +4,16 @@
 
 namespace grk
 {
+/**
+ * Vectorized row filters, dispatched to the best available SIMD target.
+ * dest and src may be the same buffer.
+ */
+void postT1Shift(int32_t* dest, const int32_t* src, uint32_t len);
+void postT1RoiShift(int32_t* dest, const int32_t* src, uint32_t len, uint32_t roiShift);
+void postT1Scale(float* dest, const int32_t* src, uint32_t len, float scale);
+void postT1RoiScale(float* dest, const int32_t* src, uint32_t len, uint32_t roiShift,
+					float scale);
+
 template<typename T>
 class RoiShiftFilter
 {
@@ -11,18 +21,7 @@ class RoiShiftFilter
 	RoiShiftFilter(DecompressBlockExec* block) : roiShift(block->roishift) {}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = abs(val);
-			if(mag >= thresh)
-			{
-				mag >>= roiShift;
-				val = val < 0 ? -mag : mag;
-			}
-			dest[i] = val / 2;
-		}
+		postT1RoiShift(dest, src, len, roiShift);
 	}
 
   private:
@@ -35,8 +34,7 @@ class ShiftFilter
 	ShiftFilter([[maybe_unused]] DecompressBlockExec* block) {}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-			dest[i] = src[i] / 2;
+		postT1Shift(dest, src, len);
 	}
 };
 
@@ -49,18 +47,7 @@ class RoiScaleFilter
 	{}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		T thresh = 1 << roiShift;
-		for(uint32_t i = 0; i < len; ++i)
-		{
-			T val = src[i];
-			T mag = abs(val);
-			if(mag >= thresh)
-			{
-				mag >>= roiShift;
-				val = val < 0 ? -mag : mag;
-			}
-			((float*)dest)[i] = (float)val * scale;
-		}
+		postT1RoiScale((float*)dest, src, len, roiShift, scale);
 	}
 
   private:
@@ -75,8 +62,7 @@ class ScaleFilter
 	ScaleFilter(DecompressBlockExec* block) : scale(block->stepsize / 2) {}
 	inline void copy(T* dest, const T* src, uint32_t len)
 	{
-		for(uint32_t i = 0; i < len; ++i)
-			((float*)dest)[i] = (float)src[i] * scale;
+		postT1Scale((float*)dest, src, len, scale);
 	}
 
   private:
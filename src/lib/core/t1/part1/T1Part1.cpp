@@ -19,15 +19,21 @@
 #include "TileProcessor.h"
 #include "t1_common.h"
 #include "T1.h"
+#include "T1Fast.h"
 #include <algorithm>
 
 namespace grk
 {
 namespace t1_part1
 {
-	T1Part1::T1Part1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH) : t1(nullptr)
+	T1Part1::T1Part1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH,
+					 bool referenceDecoder)
+		: t1(nullptr)
 	{
-		t1 = new T1(isCompressor, maxCblkW, maxCblkH);
+		if(isCompressor || referenceDecoder)
+			t1 = new T1(isCompressor, maxCblkW, maxCblkH);
+		else
+			t1 = new T1Fast(maxCblkW, maxCblkH);
 	}
 	T1Part1::~T1Part1()
 	{
@@ -59,7 +65,7 @@ namespace t1_part1
 			{
 				for(auto i = 0U; i < w; ++i)
 				{
-					int32_t temp = (block->tiledp[tileIndex++] *= (1 << T1_NMSEDEC_FRACBITS));
+					int32_t temp = block->tiledp[tileIndex++] * (1 << T1_NMSEDEC_FRACBITS);
 					int32_t mag = temp * ((temp > 0) - (temp < 0));
 					if((uint32_t)mag > maximum)
 						maximum = (uint32_t)mag;
@@ -118,7 +124,7 @@ namespace t1_part1
 			&cblkexp, max, block->bandOrientation, block->compno,
 			(uint8_t)((block->tile->comps + block->compno)->numresolutions - 1 - block->resno),
 			block->qmfbid, block->stepsize, block->cblk_sty, block->mct_norms, block->mct_numcomps,
-			block->doRateControl);
+			block->doRateControl, block->truncationSlope);
 
 		cblk->numPassesTotal = cblkexp.numPassesTotal;
 		cblk->numbps = cblkexp.numbps;
@@ -168,7 +174,13 @@ namespace t1_part1
 		}
 
 		block->tilec->postProcess(t1->getUncompressedData(), block);
-		cblk->release();
+		// open code block keeps its decompressed data for next decompression
+		if(block->retainDecompressed)
+			return true;
+		if(block->retainSegments)
+			cblk->releaseUncompressedData();
+		else
+			cblk->release();
 
 		return true;
 	}
@@ -25,7 +25,16 @@ namespace t1_part1
 	class T1Part1 : public T1Interface
 	{
 	  public:
-		T1Part1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH);
+		/**
+		 * Create Part 1 block coder
+		 *
+		 * @param isCompressor true for compression
+		 * @param maxCblkW maximum code block width
+		 * @param maxCblkH maximum code block height
+		 * @param referenceDecoder if true, decompress with the symbol-at-a-time
+		 * reference MQ decoder rather than the table-driven decoder
+		 */
+		T1Part1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH, bool referenceDecoder);
 		virtual ~T1Part1();
 
 		bool compress(CompressBlockExec* block);
@@ -22,108 +22,10 @@
 #include "grk_includes.h"
 #include "t1_common.h"
 #include "t1_luts.h"
+#include "t1_flags.h"
 
 namespace grk
 {
-/** We hold the state of individual data points for the T1 compressor using
- *  a single 32-bit flags word to hold the state of 4 data points.  This corresponds
- *  to the 4-point-high columns that the data is processed in.
- *  These \#defines declare the layout of a 32-bit flags word.
- */
-
-/* SIGMA: significance state (3 cols x 6 rows)
- * CHI:   state for negative sample value (1 col x 6 rows)
- * MU:    state for visited in refinement pass (1 col x 4 rows)
- * PI:    state for visited in significance pass (1 col * 4 rows)
- */
-
-#define T1_SIGMA_0 (1U << 0)
-#define T1_SIGMA_1 (1U << 1)
-#define T1_SIGMA_2 (1U << 2)
-#define T1_SIGMA_3 (1U << 3)
-#define T1_SIGMA_4 (1U << 4)
-#define T1_SIGMA_5 (1U << 5)
-#define T1_SIGMA_6 (1U << 6)
-#define T1_SIGMA_7 (1U << 7)
-#define T1_SIGMA_8 (1U << 8)
-#define T1_SIGMA_9 (1U << 9)
-#define T1_SIGMA_10 (1U << 10)
-#define T1_SIGMA_11 (1U << 11)
-#define T1_SIGMA_12 (1U << 12)
-#define T1_SIGMA_13 (1U << 13)
-#define T1_SIGMA_14 (1U << 14)
-#define T1_SIGMA_15 (1U << 15)
-#define T1_SIGMA_16 (1U << 16)
-#define T1_SIGMA_17 (1U << 17)
-#define T1_CHI_0 (1U << 18)
-#define T1_CHI_0_I 18
-#define T1_CHI_1 (1U << 19)
-#define T1_CHI_1_I 19
-#define T1_MU_0 (1U << 20)
-#define T1_PI_0 (1U << 21)
-#define T1_CHI_2 (1U << 22)
-#define T1_CHI_2_I 22
-#define T1_MU_1 (1U << 23)
-#define T1_PI_1_I 24
-#define T1_PI_1 (1U << T1_PI_1_I)
-#define T1_CHI_3 (1U << 25)
-#define T1_MU_2 (1U << 26)
-#define T1_PI_2_I 27
-#define T1_PI_2 (1U << T1_PI_2_I)
-#define T1_CHI_4 (1U << 28)
-#define T1_MU_3 (1U << 29)
-#define T1_PI_3 (1U << 30)
-#define T1_CHI_5 (1U << 31)
-#define T1_CHI_5_I 31
-
-/** As an example, the bits T1_SIGMA_3, T1_SIGMA_4 and T1_SIGMA_5
- *  indicate the significance state of the west neighbour of data point zero
- *  of our four, the point itself, and its east neighbour respectively.
- *  Many of the bits are arranged so that given a flags word, you can
- *  look at the values for the data point 0, then shift the flags
- *  word right by 3 bits and look at the same bit positions to see the
- *  values for data point 1.
- *
- *  The \#defines below help a bit with this; say you have a flags word
- *  f, you can do things like
- *
- *  (f & T1_SIGMA_THIS)
- *
- *  to see the significance bit of data point 0, then do
- *
- *  ((f >> 3) & T1_SIGMA_THIS)
- *
- *  to see the significance bit of data point 1.
- */
-
-#define T1_SIGMA_NW T1_SIGMA_0
-#define T1_SIGMA_N T1_SIGMA_1
-#define T1_SIGMA_NE T1_SIGMA_2
-#define T1_SIGMA_W T1_SIGMA_3
-#define T1_SIGMA_THIS T1_SIGMA_4
-#define T1_SIGMA_E T1_SIGMA_5
-#define T1_SIGMA_SW T1_SIGMA_6
-#define T1_SIGMA_S T1_SIGMA_7
-#define T1_SIGMA_SE T1_SIGMA_8
-#define T1_SIGMA_NEIGHBOURS                                                                        \
-	(T1_SIGMA_NW | T1_SIGMA_N | T1_SIGMA_NE | T1_SIGMA_W | T1_SIGMA_E | T1_SIGMA_SW | T1_SIGMA_S | \
-	 T1_SIGMA_SE)
-
-#define T1_CHI_THIS T1_CHI_1
-#define T1_CHI_THIS_I T1_CHI_1_I
-#define T1_MU_THIS T1_MU_0
-#define T1_PI_THIS T1_PI_0
-#define T1_CHI_S T1_CHI_2
-
-#define T1_LUT_SGN_W (1U << 0)
-#define T1_LUT_SIG_N (1U << 1)
-#define T1_LUT_SGN_E (1U << 2)
-#define T1_LUT_SIG_W (1U << 3)
-#define T1_LUT_SGN_N (1U << 4)
-#define T1_LUT_SIG_E (1U << 5)
-#define T1_LUT_SGN_S (1U << 6)
-#define T1_LUT_SIG_S (1U << 7)
-
 #define T1_TYPE_MQ 0 /** Normal coding using entropy coder */
 #define T1_TYPE_RAW 1 /** Raw compressing*/
 
@@ -136,42 +38,11 @@ static int16_t getnmsedec_ref(uint32_t x, uint32_t bitpos);
 // DECODE
 static INLINE uint8_t getctxno_zc(mqcoder* mqc, uint32_t f);
 static INLINE uint8_t getctxno_mag(uint32_t f);
-static INLINE uint8_t getctxtno_sc_or_spb_index(uint32_t fX, uint32_t pfX, uint32_t nfX,
-												uint32_t ci);
 static INLINE uint8_t getspb(uint32_t lu);
 static INLINE uint8_t getctxno_zc(mqcoder* mqc, uint32_t f)
 {
 	return mqc->lut_ctxno_zc_orient[(f & T1_SIGMA_NEIGHBOURS)];
 }
-static INLINE uint8_t getctxtno_sc_or_spb_index(uint32_t fX, uint32_t pfX, uint32_t nfX,
-												uint32_t ci)
-{
-	/*
-	 0 pfX T1_CHI_THIS           T1_LUT_SGN_W
-	 1 tfX T1_SIGMA_1            T1_LUT_SIG_N
-	 2 nfX T1_CHI_THIS           T1_LUT_SGN_E
-	 3 tfX T1_SIGMA_3            T1_LUT_SIG_W
-	 4  fX T1_CHI_(THIS - 1)     T1_LUT_SGN_N
-	 5 tfX T1_SIGMA_5            T1_LUT_SIG_E
-	 6  fX T1_CHI_(THIS + 1)     T1_LUT_SGN_S
-	 7 tfX T1_SIGMA_7            T1_LUT_SIG_S
-	 */
-	uint32_t lu = (fX >> (ci)) & (T1_SIGMA_1 | T1_SIGMA_3 | T1_SIGMA_5 | T1_SIGMA_7);
-
-	lu |= (pfX >> (T1_CHI_THIS_I + (ci))) & (1U << 0);
-	lu |= (nfX >> (T1_CHI_THIS_I - 2U + (ci))) & (1U << 2);
-	if(ci == 0U)
-	{
-		lu |= (fX >> (T1_CHI_0_I - 4U)) & (1U << 4);
-	}
-	else
-	{
-		lu |= (fX >> (T1_CHI_1_I - 4U + ((ci - 3U)))) & (1U << 4);
-	}
-	lu |= (fX >> (T1_CHI_2_I - 6U + (ci))) & (1U << 6);
-
-	return (uint8_t)lu;
-}
 static INLINE uint8_t getctxno_sc(uint32_t lu)
 {
 	return lut_ctxno_sc[lu];
@@ -201,31 +72,6 @@ static int16_t getnmsedec_ref(uint32_t x, uint32_t bitpos)
 
 	return lut_nmsedec_ref0[x & ((1 << T1_NMSEDEC_BITS) - 1)];
 }
-#define update_flags_macro(flags, flagsp, ci, s, stride, vsc) \
-	{                                                         \
-		/* east */                                            \
-		flagsp[-1] |= T1_SIGMA_5 << (ci);                     \
-		/* mark target as significant */                      \
-		flags |= ((s << T1_CHI_1_I) | T1_SIGMA_4) << (ci);    \
-		/* west */                                            \
-		flagsp[1] |= T1_SIGMA_3 << (ci);                      \
-		/* north-west, north, north-east */                   \
-		if(ci == 0U && !(vsc))                                \
-		{                                                     \
-			auto north = flagsp - (stride);                   \
-			*north |= (s << T1_CHI_5_I) | T1_SIGMA_16;        \
-			north[-1] |= T1_SIGMA_17;                         \
-			north[1] |= T1_SIGMA_15;                          \
-		}                                                     \
-		/* south-west, south, south-east */                   \
-		if(ci == 9U)                                          \
-		{                                                     \
-			auto south = flagsp + (stride);                   \
-			*south |= (s << T1_CHI_0_I) | T1_SIGMA_1;         \
-			south[-1] |= T1_SIGMA_2;                          \
-			south[1] |= T1_SIGMA_0;                           \
-		}                                                     \
-	}
 static INLINE void update_flags(grk_flag* flagsp, uint32_t ci, uint32_t s, uint32_t stride,
 								uint32_t vsc)
 {
@@ -750,7 +596,8 @@ void T1::enc_clnpass(int32_t bpno, int32_t* nmsedec, uint32_t cblksty)
 }
 double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint16_t compno,
 						 uint8_t level, uint8_t qmfbid, double stepsize, uint32_t cblksty,
-						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl)
+						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl,
+						 double truncationSlope)
 {
 	code_block_enc_allocate(cblk);
 	auto mqc = &coder;
@@ -790,8 +637,12 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 #endif
 
 	double cumwmsedec = 0.0;
+	// distortion and rate at start of current bit plane
+	double planeDistortion = 0.0;
+	uint32_t planeRate = 0;
+	bool truncate = false;
 	uint32_t passno;
-	for(passno = 0; bpno >= 0; ++passno)
+	for(passno = 0; bpno >= 0 && !truncate; ++passno)
 	{
 		auto* pass = cblk->passes + passno;
 		uint8_t type = ((bpno < ((int32_t)(cblk->numbps) - 4)) && (passtype < 2) &&
@@ -833,8 +684,22 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 									 mct_norms, mct_numcomps);
 			cumwmsedec += tempwmsedec;
 			pass->distortiondec = cumwmsedec;
+			// stop after a bit plane whose rate-distortion slope is below the
+			// truncation slope : the remaining planes will not be included
+			if(truncationSlope > 0 && passtype == 2 && bpno > 0)
+			{
+				// number of bytes is one less than actual rate : see below
+				uint32_t rate = mqc_numbytes_enc(mqc) + 1;
+				if(rate > planeRate)
+				{
+					if(cumwmsedec - planeDistortion < truncationSlope * (rate - planeRate))
+						truncate = true;
+					planeDistortion = cumwmsedec;
+					planeRate = rate;
+				}
+			}
 		}
-		if(enc_is_term_pass(cblk, cblksty, bpno, passtype))
+		if(truncate || enc_is_term_pass(cblk, cblksty, bpno, passtype))
 		{
 			if(type == T1_TYPE_RAW)
 			{
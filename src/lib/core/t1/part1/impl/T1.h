@@ -31,15 +31,16 @@ struct DecompressCodeblock;
 struct T1
 {
 	T1(bool isCompressor, uint32_t maxCblkW, uint32_t maxCblkH);
-	~T1();
+	virtual ~T1();
 
-	bool decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uint8_t orientation,
-						 uint32_t cblksty);
+	virtual bool decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData,
+								 uint8_t orientation, uint32_t cblksty);
 	void code_block_enc_deallocate(cblk_enc* p_code_block);
 	bool alloc(uint32_t w, uint32_t h);
 	double compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint16_t compno,
 						 uint8_t level, uint8_t qmfbid, double stepsize, uint32_t cblksty,
-						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl);
+						 const double* mct_norms, uint16_t mct_numcomps, bool doRateControl,
+						 double truncationSlope);
 	mqcoder coder;
 
 	int32_t* getUncompressedData(void);
@@ -48,7 +49,7 @@ struct T1
 	uint8_t* getCompressedDataBuffer(void);
 	static double getnorm(uint32_t level, uint8_t orientation, bool reversible);
 
-  private:
+  protected:
 	bool allocUncompressedData(size_t len);
 	void deallocUncompressedData(void);
 	int32_t* uncompressedData;
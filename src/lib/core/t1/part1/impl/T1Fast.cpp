@@ -0,0 +1,636 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <Logger.h>
+#include "grk_includes.h"
+#include "t1_common.h"
+#include "t1_luts.h"
+#include "t1_flags.h"
+#include "T1Fast.h"
+
+namespace grk
+{
+/* sign coding context in low 7 bits, sign prediction bit in high bit */
+static const auto lut_ctxno_sc_spb = [] {
+	std::array<uint8_t, 256> lut{};
+	for(uint32_t i = 0; i < lut.size(); ++i)
+		lut[i] = (uint8_t)(lut_ctxno_sc[i] | (lut_spb[i] << 7));
+	return lut;
+}();
+
+#define T1_PI_MASK (T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3)
+
+/**
+ * Decode sign of sample that has just become significant, and update flags
+ */
+template<uint32_t ci, bool vsc>
+static FORCE_INLINE void dec_sign(mqc_lut_decoder& dec, mqc_lut_ctx* ctxs, grk_flag& f, grk_flag* flagsp,
+							int32_t* datap, int32_t oneplushalf, uint32_t flags_stride)
+{
+	uint32_t lu = getctxtno_sc_or_spb_index(f, flagsp[-1], flagsp[1], ci);
+	uint32_t sc = lut_ctxno_sc_spb[lu];
+	uint32_t v = dec.decode(ctxs[sc & 0x7F]) ^ (sc >> 7);
+	*datap = v ? -oneplushalf : oneplushalf;
+	update_flags_macro(f, flagsp, ci, v, flags_stride, vsc);
+}
+
+/**
+ * Decode significance, and sign if significant
+ */
+template<uint32_t ci, bool vsc>
+static FORCE_INLINE void dec_sig(mqc_lut_decoder& dec, mqc_lut_ctx* ctxs, const uint8_t* lut_zc, grk_flag& f,
+						   grk_flag* flagsp, int32_t* datap, int32_t oneplushalf,
+						   uint32_t flags_stride)
+{
+	if(dec.decode(ctxs[lut_zc[(f >> ci) & T1_SIGMA_NEIGHBOURS]]))
+		dec_sign<ci, vsc>(dec, ctxs, f, flagsp, datap, oneplushalf, flags_stride);
+}
+
+/**
+ * Cleanup pass step for sample that was not visited by the significance pass
+ */
+template<uint32_t ci, bool vsc>
+static FORCE_INLINE void dec_cln_step(mqc_lut_decoder& dec, mqc_lut_ctx* ctxs, const uint8_t* lut_zc,
+								grk_flag& f, grk_flag* flagsp, int32_t* datap, int32_t oneplushalf,
+								uint32_t flags_stride)
+{
+	if(!(f & ((T1_SIGMA_THIS | T1_PI_THIS) << ci)))
+		dec_sig<ci, vsc>(dec, ctxs, lut_zc, f, flagsp, datap, oneplushalf, flags_stride);
+}
+
+/**
+ * Significance pass step
+ */
+template<uint32_t ci, bool vsc>
+static FORCE_INLINE void dec_sig_step(mqc_lut_decoder& dec, mqc_lut_ctx* ctxs, const uint8_t* lut_zc,
+								grk_flag& f, grk_flag* flagsp, int32_t* datap, int32_t oneplushalf,
+								uint32_t flags_stride)
+{
+	if((f & ((T1_SIGMA_THIS | T1_PI_THIS) << ci)) == 0U && (f & (T1_SIGMA_NEIGHBOURS << ci)) != 0U)
+	{
+		dec_sig<ci, vsc>(dec, ctxs, lut_zc, f, flagsp, datap, oneplushalf, flags_stride);
+		f |= T1_PI_THIS << ci;
+	}
+}
+
+/**
+ * Magnitude refinement pass step
+ */
+template<uint32_t ci>
+static FORCE_INLINE void dec_ref_step(mqc_lut_decoder& dec, mqc_lut_ctx* ctxs, grk_flag& f, int32_t* datap,
+								int32_t poshalf)
+{
+	if((f & ((T1_SIGMA_THIS | T1_PI_THIS) << ci)) == (T1_SIGMA_THIS << ci))
+	{
+		uint32_t fci = f >> ci;
+		uint32_t ctxno = (fci & T1_MU_0) ? T1_CTXNO_MAG + 2
+										 : T1_CTXNO_MAG + ((fci & T1_SIGMA_NEIGHBOURS) != 0);
+		uint32_t v = dec.decode(ctxs[ctxno]);
+		*datap += (v ^ (*datap < 0)) ? poshalf : -poshalf;
+		f |= T1_MU_THIS << ci;
+	}
+}
+
+/**
+ * Significance pass step, raw mode
+ */
+template<uint32_t ci, bool vsc>
+static FORCE_INLINE void dec_sig_step_raw(mqc_raw_lut_decoder& raw, grk_flag& f, grk_flag* flagsp,
+										  int32_t* datap, int32_t oneplushalf,
+										  uint32_t flags_stride)
+{
+	if((f & ((T1_SIGMA_THIS | T1_PI_THIS) << ci)) == 0U && (f & (T1_SIGMA_NEIGHBOURS << ci)) != 0U)
+	{
+		if(raw.decode())
+		{
+			uint32_t v = raw.decode();
+			*datap = v ? -oneplushalf : oneplushalf;
+			update_flags_macro(f, flagsp, ci, v, flags_stride, vsc);
+		}
+		f |= T1_PI_THIS << ci;
+	}
+}
+
+/**
+ * Magnitude refinement pass step, raw mode
+ */
+template<uint32_t ci>
+static FORCE_INLINE void dec_ref_step_raw(mqc_raw_lut_decoder& raw, grk_flag& f, int32_t* datap,
+										  int32_t poshalf)
+{
+	if((f & ((T1_SIGMA_THIS | T1_PI_THIS) << ci)) == (T1_SIGMA_THIS << ci))
+	{
+		uint32_t v = raw.decode();
+		*datap += (v ^ (*datap < 0)) ? poshalf : -poshalf;
+		f |= T1_MU_THIS << ci;
+	}
+}
+
+T1Fast::T1Fast(uint32_t maxCblkW, uint32_t maxCblkH) : T1(false, maxCblkW, maxCblkH)
+{
+	resetstates();
+}
+void T1Fast::resetstates(void)
+{
+	memset(ctxs_, 0, sizeof(ctxs_));
+	ctxs_[T1_CTXNO_UNI] = 46 << 1;
+	ctxs_[T1_CTXNO_AGG] = 3 << 1;
+	ctxs_[T1_CTXNO_ZC] = 4 << 1;
+}
+template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+void T1Fast::dec_clnpass_lut(int32_t bpno)
+{
+	const uint32_t width = cblkw ? cblkw : w;
+	const uint32_t height = cblkh ? cblkh : h;
+	const uint32_t flags_stride = width + 2;
+	const int32_t one = 1 << bpno;
+	const int32_t oneplushalf = one | (one >> 1);
+	const auto lut_zc = coder.lut_ctxno_zc_orient;
+	auto ctxs = ctxs_;
+	auto data = uncompressedData;
+	auto flagsp = flags + flags_stride + 1;
+	mqc_lut_decoder dec(&coder);
+	uint32_t k;
+	for(k = 0; k < (height & ~3U); k += 4, data += 3 * width, flagsp += 2)
+	{
+		// end of current run of columns with all-zero flags
+		uint32_t runEnd = 0;
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			if(f == 0)
+			{
+				// columns with no significant samples or neighbours are coded
+				// with run-length decisions : decode the whole run at once if possible
+				if(i >= runEnd)
+				{
+					runEnd = i + 1;
+					while(runEnd < width && flagsp[runEnd - i] == 0)
+						++runEnd;
+				}
+				uint32_t run = runEnd - i;
+				if(run > 1 && dec.decode_zero_run(ctxs[T1_CTXNO_AGG], run))
+				{
+					i += run - 1;
+					data += run - 1;
+					flagsp += run - 1;
+					continue;
+				}
+				if(!dec.decode(ctxs[T1_CTXNO_AGG]))
+					continue;
+				// significant sample found : flags of next column may change
+				runEnd = 0;
+				uint32_t runlen = dec.decode(ctxs[T1_CTXNO_UNI]) << 1;
+				runlen |= dec.decode(ctxs[T1_CTXNO_UNI]);
+				switch(runlen)
+				{
+					case 0:
+						dec_sign<0, vsc>(dec, ctxs, f, flagsp, data, oneplushalf, flags_stride);
+						dec_sig<3, false>(dec, ctxs, lut_zc, f, flagsp, data + width, oneplushalf,
+										  flags_stride);
+						dec_sig<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+										  flags_stride);
+						dec_sig<9, false>(dec, ctxs, lut_zc, f, flagsp, data + 3 * width, oneplushalf,
+										  flags_stride);
+						break;
+					case 1:
+						dec_sign<3, false>(dec, ctxs, f, flagsp, data + width, oneplushalf,
+										   flags_stride);
+						dec_sig<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+										  flags_stride);
+						dec_sig<9, false>(dec, ctxs, lut_zc, f, flagsp, data + 3 * width, oneplushalf,
+										  flags_stride);
+						break;
+					case 2:
+						dec_sign<6, false>(dec, ctxs, f, flagsp, data + 2 * width, oneplushalf,
+										   flags_stride);
+						dec_sig<9, false>(dec, ctxs, lut_zc, f, flagsp, data + 3 * width, oneplushalf,
+										  flags_stride);
+						break;
+					case 3:
+						dec_sign<9, false>(dec, ctxs, f, flagsp, data + 3 * width, oneplushalf,
+										   flags_stride);
+						break;
+				}
+			}
+			else
+			{
+				dec_cln_step<0, vsc>(dec, ctxs, lut_zc, f, flagsp, data, oneplushalf,
+									 flags_stride);
+				dec_cln_step<3, false>(dec, ctxs, lut_zc, f, flagsp, data + width, oneplushalf,
+									   flags_stride);
+				dec_cln_step<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+									   flags_stride);
+				dec_cln_step<9, false>(dec, ctxs, lut_zc, f, flagsp, data + 3 * width, oneplushalf,
+									   flags_stride);
+			}
+			*flagsp = f & ~T1_PI_MASK;
+		}
+	}
+	if(k < height)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			dec_cln_step<0, vsc>(dec, ctxs, lut_zc, f, flagsp, data, oneplushalf, flags_stride);
+			if(height - k > 1)
+				dec_cln_step<3, false>(dec, ctxs, lut_zc, f, flagsp, data + width, oneplushalf,
+									   flags_stride);
+			if(height - k > 2)
+				dec_cln_step<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+									   flags_stride);
+			*flagsp = f & ~T1_PI_MASK;
+		}
+	}
+}
+void T1Fast::dec_clnpass_lut(int32_t bpno, int32_t cblksty)
+{
+	bool vsc = cblksty & GRK_CBLKSTY_VSC;
+	if(w == 64 && h == 64)
+	{
+		if(vsc)
+			dec_clnpass_lut<64, 64, true>(bpno);
+		else
+			dec_clnpass_lut<64, 64, false>(bpno);
+	}
+	else
+	{
+		if(vsc)
+			dec_clnpass_lut<0, 0, true>(bpno);
+		else
+			dec_clnpass_lut<0, 0, false>(bpno);
+	}
+	if(cblksty & GRK_CBLKSTY_SEGSYM)
+	{
+		mqc_lut_decoder dec(&coder);
+		uint32_t v = 0;
+		for(uint32_t i = 0; i < 4; ++i)
+			v = (v << 1) | dec.decode(ctxs_[T1_CTXNO_UNI]);
+		if(v != 0xa)
+			Logger::logger_.warn("Bad segmentation symbol %x", v);
+	}
+}
+template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+void T1Fast::dec_sigpass_lut(int32_t bpno)
+{
+	const uint32_t width = cblkw ? cblkw : w;
+	const uint32_t height = cblkh ? cblkh : h;
+	const uint32_t flags_stride = width + 2;
+	const int32_t one = 1 << bpno;
+	const int32_t oneplushalf = one | (one >> 1);
+	const auto lut_zc = coder.lut_ctxno_zc_orient;
+	auto ctxs = ctxs_;
+	auto data = uncompressedData;
+	auto flagsp = flags + flags_stride + 1;
+	mqc_lut_decoder dec(&coder);
+	uint32_t k;
+	for(k = 0; k < (height & ~3U); k += 4, data += 3 * width, flagsp += 2)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			if(f == 0)
+				continue;
+			dec_sig_step<0, vsc>(dec, ctxs, lut_zc, f, flagsp, data, oneplushalf, flags_stride);
+			dec_sig_step<3, false>(dec, ctxs, lut_zc, f, flagsp, data + width, oneplushalf,
+								   flags_stride);
+			dec_sig_step<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+								   flags_stride);
+			dec_sig_step<9, false>(dec, ctxs, lut_zc, f, flagsp, data + 3 * width, oneplushalf,
+								   flags_stride);
+			*flagsp = f;
+		}
+	}
+	if(k < height)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			dec_sig_step<0, vsc>(dec, ctxs, lut_zc, f, flagsp, data, oneplushalf, flags_stride);
+			if(height - k > 1)
+				dec_sig_step<3, false>(dec, ctxs, lut_zc, f, flagsp, data + width, oneplushalf,
+									   flags_stride);
+			if(height - k > 2)
+				dec_sig_step<6, false>(dec, ctxs, lut_zc, f, flagsp, data + 2 * width, oneplushalf,
+									   flags_stride);
+			*flagsp = f;
+		}
+	}
+}
+void T1Fast::dec_sigpass_lut(int32_t bpno, int32_t cblksty)
+{
+	bool vsc = cblksty & GRK_CBLKSTY_VSC;
+	if(w == 64 && h == 64)
+	{
+		if(vsc)
+			dec_sigpass_lut<64, 64, true>(bpno);
+		else
+			dec_sigpass_lut<64, 64, false>(bpno);
+	}
+	else
+	{
+		if(vsc)
+			dec_sigpass_lut<0, 0, true>(bpno);
+		else
+			dec_sigpass_lut<0, 0, false>(bpno);
+	}
+}
+void T1Fast::dec_refpass_lut(int32_t bpno)
+{
+	if(w == 64 && h == 64)
+		dec_refpass_lut<64, 64>(bpno);
+	else
+		dec_refpass_lut<0, 0>(bpno);
+}
+template<uint32_t cblkw, uint32_t cblkh>
+void T1Fast::dec_refpass_lut(int32_t bpno)
+{
+	const uint32_t width = cblkw ? cblkw : w;
+	const uint32_t height = cblkh ? cblkh : h;
+	const int32_t poshalf = (1 << bpno) >> 1;
+	auto ctxs = ctxs_;
+	auto data = uncompressedData;
+	auto flagsp = flags + width + 2 + 1;
+	mqc_lut_decoder dec(&coder);
+	uint32_t k;
+	for(k = 0; k < (height & ~3U); k += 4, data += 3 * width, flagsp += 2)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			if(f == 0)
+				continue;
+			dec_ref_step<0>(dec, ctxs, f, data, poshalf);
+			dec_ref_step<3>(dec, ctxs, f, data + width, poshalf);
+			dec_ref_step<6>(dec, ctxs, f, data + 2 * width, poshalf);
+			dec_ref_step<9>(dec, ctxs, f, data + 3 * width, poshalf);
+			*flagsp = f;
+		}
+	}
+	if(k < height)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			dec_ref_step<0>(dec, ctxs, f, data, poshalf);
+			if(height - k > 1)
+				dec_ref_step<3>(dec, ctxs, f, data + width, poshalf);
+			if(height - k > 2)
+				dec_ref_step<6>(dec, ctxs, f, data + 2 * width, poshalf);
+			*flagsp = f;
+		}
+	}
+}
+template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+void T1Fast::dec_sigpass_raw_lut(int32_t bpno)
+{
+	const uint32_t width = cblkw ? cblkw : w;
+	const uint32_t height = cblkh ? cblkh : h;
+	const uint32_t flags_stride = width + 2;
+	const int32_t one = 1 << bpno;
+	const int32_t oneplushalf = one | (one >> 1);
+	auto raw = raw_;
+	auto data = uncompressedData;
+	auto flagsp = flags + flags_stride + 1;
+	uint32_t k;
+	for(k = 0; k < (height & ~3U); k += 4, data += 3 * width, flagsp += 2)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			if(f == 0)
+				continue;
+			dec_sig_step_raw<0, vsc>(raw, f, flagsp, data, oneplushalf, flags_stride);
+			dec_sig_step_raw<3, false>(raw, f, flagsp, data + width, oneplushalf, flags_stride);
+			dec_sig_step_raw<6, false>(raw, f, flagsp, data + 2 * width, oneplushalf, flags_stride);
+			dec_sig_step_raw<9, false>(raw, f, flagsp, data + 3 * width, oneplushalf, flags_stride);
+			*flagsp = f;
+		}
+	}
+	if(k < height)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			dec_sig_step_raw<0, vsc>(raw, f, flagsp, data, oneplushalf, flags_stride);
+			if(height - k > 1)
+				dec_sig_step_raw<3, false>(raw, f, flagsp, data + width, oneplushalf, flags_stride);
+			if(height - k > 2)
+				dec_sig_step_raw<6, false>(raw, f, flagsp, data + 2 * width, oneplushalf,
+										   flags_stride);
+			*flagsp = f;
+		}
+	}
+	raw_ = raw;
+}
+void T1Fast::dec_sigpass_raw_lut(int32_t bpno, int32_t cblksty)
+{
+	bool vsc = cblksty & GRK_CBLKSTY_VSC;
+	if(w == 64 && h == 64)
+	{
+		if(vsc)
+			dec_sigpass_raw_lut<64, 64, true>(bpno);
+		else
+			dec_sigpass_raw_lut<64, 64, false>(bpno);
+	}
+	else
+	{
+		if(vsc)
+			dec_sigpass_raw_lut<0, 0, true>(bpno);
+		else
+			dec_sigpass_raw_lut<0, 0, false>(bpno);
+	}
+}
+template<uint32_t cblkw, uint32_t cblkh>
+void T1Fast::dec_refpass_raw_lut(int32_t bpno)
+{
+	const uint32_t width = cblkw ? cblkw : w;
+	const uint32_t height = cblkh ? cblkh : h;
+	const int32_t poshalf = (1 << bpno) >> 1;
+	auto raw = raw_;
+	auto data = uncompressedData;
+	auto flagsp = flags + width + 2 + 1;
+	uint32_t k;
+	for(k = 0; k < (height & ~3U); k += 4, data += 3 * width, flagsp += 2)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			if(f == 0)
+				continue;
+			dec_ref_step_raw<0>(raw, f, data, poshalf);
+			dec_ref_step_raw<3>(raw, f, data + width, poshalf);
+			dec_ref_step_raw<6>(raw, f, data + 2 * width, poshalf);
+			dec_ref_step_raw<9>(raw, f, data + 3 * width, poshalf);
+			*flagsp = f;
+		}
+	}
+	if(k < height)
+	{
+		for(uint32_t i = 0; i < width; ++i, ++data, ++flagsp)
+		{
+			auto f = *flagsp;
+			dec_ref_step_raw<0>(raw, f, data, poshalf);
+			if(height - k > 1)
+				dec_ref_step_raw<3>(raw, f, data + width, poshalf);
+			if(height - k > 2)
+				dec_ref_step_raw<6>(raw, f, data + 2 * width, poshalf);
+			*flagsp = f;
+		}
+	}
+	raw_ = raw;
+}
+void T1Fast::dec_refpass_raw_lut(int32_t bpno)
+{
+	if(w == 64 && h == 64)
+		dec_refpass_raw_lut<64, 64>(bpno);
+	else
+		dec_refpass_raw_lut<0, 0>(bpno);
+}
+/**
+ * Segments of a code block are located before decoding starts, and all raw (BYPASS)
+ * segments are unstuffed in one sweep over the compressed data. This takes the
+ * byte-level marker handling out of the raw passes, which then only consume bits.
+ *
+ * MQ segments are left as is : their decoder is initialized in place, which requires
+ * the artificial end marker that temporarily overwrites the start of the next segment.
+ */
+void T1Fast::unstuffRawSegments(DecompressCodeblock* cblk, uint8_t* compressedData,
+								uint32_t cblksty)
+{
+	if(!(cblksty & GRK_CBLKSTY_LAZY))
+		return;
+	uint32_t numSegments = cblk->getNumSegments();
+	size_t numWords = 0;
+	for(uint32_t segno = 0; segno < numSegments; ++segno)
+		numWords += mqc_raw_unstuffed_words(cblk->getSegment(segno)->len);
+	if(rawBits_.size() < numWords)
+		rawBits_.resize(numWords);
+	rawSegs_.resize(numSegments);
+
+	int32_t bpno_plus_one = (int32_t)(cblk->numbps);
+	uint32_t passtype = 2;
+	uint32_t cblkdataindex = 0;
+	uint32_t offset = 0;
+	for(uint32_t segno = 0; segno < numSegments; ++segno)
+	{
+		auto seg = cblk->getSegment(segno);
+		bool raw = (bpno_plus_one <= ((int32_t)(cblk->numbps)) - 4) && (passtype < 2);
+		if(raw)
+		{
+			uint32_t numSegWords =
+				mqc_raw_unstuff(compressedData + cblkdataindex, seg->len, rawBits_.data() + offset);
+			rawSegs_[segno] = {offset, numSegWords};
+			offset += mqc_raw_unstuffed_words(seg->len);
+		}
+		cblkdataindex += seg->len;
+		for(uint32_t passno = 0; (passno < seg->numpasses) && (bpno_plus_one >= 1); ++passno)
+		{
+			if(++passtype == 3)
+			{
+				passtype = 0;
+				bpno_plus_one--;
+			}
+		}
+	}
+}
+bool T1Fast::decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData,
+							 uint8_t orientation, uint32_t cblksty)
+{
+	auto mqc = &coder;
+	uint32_t cblkdataindex = 0;
+	bool check_pterm = cblksty & GRK_CBLKSTY_PTERM;
+	mqc->lut_ctxno_zc_orient = lut_ctxno_zc + (orientation << 9);
+	int32_t bpno_plus_one = (int32_t)(cblk->numbps);
+	if(bpno_plus_one >= (int32_t)maxBitPlanesGRK)
+	{
+		grk::Logger::logger_.error("unsupported number of bit planes: %u > %u", bpno_plus_one,
+								   maxBitPlanesGRK);
+		return false;
+	}
+	uint32_t passtype = 2;
+	resetstates();
+	unstuffRawSegments(cblk, compressedData, cblksty);
+
+	for(uint32_t segno = 0; segno < cblk->getNumSegments(); ++segno)
+	{
+		auto seg = cblk->getSegment(segno);
+		/* BYPASS mode */
+		bool raw = (bpno_plus_one <= ((int32_t)(cblk->numbps)) - 4) && (passtype < 2) &&
+				   (cblksty & GRK_CBLKSTY_LAZY);
+		if(raw)
+			raw_.init(rawBits_.data() + rawSegs_[segno].first, rawSegs_[segno].second);
+		else
+			mqc_init_dec(mqc, compressedData + cblkdataindex, seg->len);
+		auto segData = compressedData + cblkdataindex;
+		cblkdataindex += seg->len;
+		for(uint32_t passno = 0; (passno < seg->numpasses) && (bpno_plus_one >= 1); ++passno)
+		{
+			switch(passtype)
+			{
+				case 0:
+					if(raw)
+						dec_sigpass_raw_lut(bpno_plus_one, (int32_t)cblksty);
+					else
+						dec_sigpass_lut(bpno_plus_one, (int32_t)cblksty);
+					break;
+				case 1:
+					if(raw)
+						dec_refpass_raw_lut(bpno_plus_one);
+					else
+						dec_refpass_lut(bpno_plus_one);
+					break;
+				case 2:
+					dec_clnpass_lut(bpno_plus_one, (int32_t)cblksty);
+					break;
+			}
+
+			if((cblksty & GRK_CBLKSTY_RESET) && !raw)
+				resetstates();
+			if(++passtype == 3)
+			{
+				passtype = 0;
+				bpno_plus_one--;
+			}
+		}
+		if(raw)
+		{
+			// position the coder where mqc_raw_decode() would have stopped
+			mqc->start = segData;
+			mqc->end = segData + seg->len;
+			mqc->bp = segData + mqc_raw_bytes_consumed(segData, seg->len, raw_.bitsDecoded());
+		}
+		else
+		{
+			mqc_finish_dec(mqc);
+		}
+	}
+	if(check_pterm)
+	{
+		if(mqc->bp + 2 < mqc->end)
+			grk::Logger::logger_.warn(
+				"PTERM check failure: %u remaining bytes in code block (%u used / %u)",
+				(int)(mqc->end - mqc->bp) - 2, (int)(mqc->bp - mqc->start),
+				(int)(mqc->end - mqc->start));
+		else if(mqc->end_of_byte_stream_counter > 2)
+			grk::Logger::logger_.warn("PTERM check failure: %u synthesized 0xFF markers read",
+									  mqc->end_of_byte_stream_counter);
+	}
+
+	return true;
+}
+
+} // namespace grk
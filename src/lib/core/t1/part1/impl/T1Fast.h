@@ -0,0 +1,75 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+#include "t1_common.h"
+
+namespace grk
+{
+/**
+ * Part 1 code block decoder built on the table-driven MQ decoder.
+ *
+ * Contexts are held as compact state indices, sign coding contexts and sign
+ * predictions come from a single lookup, and in the cleanup pass, runs of
+ * insignificant stripe columns are decoded in one step whenever the MQ registers
+ * show that every run-length decision must be zero.
+ *
+ * Raw (BYPASS) segments of a code block are unstuffed into plain bit streams
+ * before decoding starts, so that raw passes read 64 bits at a time.
+ *
+ * Output is bit-exact with T1. Compression is inherited from T1.
+ */
+struct T1Fast : public T1
+{
+	T1Fast(uint32_t maxCblkW, uint32_t maxCblkH);
+	~T1Fast() = default;
+
+	bool decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uint8_t orientation,
+						 uint32_t cblksty) override;
+
+  private:
+	/* passes are specialized for code block dimensions cblkw x cblkh;
+	   zero dimensions are read from the T1 at run time */
+	template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+	void dec_clnpass_lut(int32_t bpno);
+	void dec_clnpass_lut(int32_t bpno, int32_t cblksty);
+	template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+	void dec_sigpass_lut(int32_t bpno);
+	void dec_sigpass_lut(int32_t bpno, int32_t cblksty);
+	template<uint32_t cblkw, uint32_t cblkh>
+	void dec_refpass_lut(int32_t bpno);
+	void dec_refpass_lut(int32_t bpno);
+	template<uint32_t cblkw, uint32_t cblkh, bool vsc>
+	void dec_sigpass_raw_lut(int32_t bpno);
+	void dec_sigpass_raw_lut(int32_t bpno, int32_t cblksty);
+	template<uint32_t cblkw, uint32_t cblkh>
+	void dec_refpass_raw_lut(int32_t bpno);
+	void dec_refpass_raw_lut(int32_t bpno);
+	void resetstates(void);
+	void unstuffRawSegments(DecompressCodeblock* cblk, uint8_t* compressedData,
+							uint32_t cblksty);
+
+	/** context states, indexing mqc_lut_states */
+	mqc_lut_ctx ctxs_[MQC_NUMCTXS];
+	/** unstuffed raw segments */
+	std::vector<uint64_t> rawBits_;
+	/** offset and number of words in rawBits_, per segment */
+	std::vector<std::pair<uint32_t, uint32_t>> rawSegs_;
+	mqc_raw_lut_decoder raw_;
+};
+
+} // namespace grk
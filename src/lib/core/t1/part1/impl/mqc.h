@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <array>
+#include <bit>
 #include <t1_common.h>
 #include "plugin_interface.h"
 namespace grk
@@ -79,6 +81,7 @@ const uint32_t A_MIN = 0x8000;
 
 #include "mqc_inl.h"
 #include "mqc_dec_inl.h"
+#include "mqc_dec_lut.h"
 #include "mqc_enc_inl.h"
 
 uint32_t mqc_numbytes_enc(mqcoder* mqc);
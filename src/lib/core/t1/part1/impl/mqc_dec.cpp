@@ -25,7 +25,7 @@
 
 namespace grk
 {
-static const mqc_state mqc_states[47 * 2] = {
+static constexpr mqc_state mqc_states[47 * 2] = {
 	{0x5601, 0, &mqc_states[2], &mqc_states[3]},   {0x5601, 1, &mqc_states[3], &mqc_states[2]},
 	{0x3401, 0, &mqc_states[4], &mqc_states[12]},  {0x3401, 1, &mqc_states[5], &mqc_states[13]},
 	{0x1801, 0, &mqc_states[6], &mqc_states[18]},  {0x1801, 1, &mqc_states[7], &mqc_states[19]},
@@ -75,6 +75,22 @@ static const mqc_state mqc_states[47 * 2] = {
 	{0x5601, 0, &mqc_states[92], &mqc_states[92]}, {0x5601, 1, &mqc_states[93], &mqc_states[93]},
 };
 
+static constexpr std::array<mqc_lut_state, MQC_LUT_NUMSTATES> mqc_make_lut_states(void)
+{
+	std::array<mqc_lut_state, MQC_LUT_NUMSTATES> states{};
+	for(uint8_t i = 0; i < MQC_LUT_NUMSTATES; ++i)
+	{
+		auto st = mqc_states + i;
+		states[i].qeval_shift = st->qeval << 16;
+		states[i].next[0] = (uint8_t)(st->nmps - mqc_states);
+		states[i].next[1] = (uint8_t)(st->nlps - mqc_states);
+		states[i].mps = (uint8_t)st->mps;
+	}
+
+	return states;
+}
+constexpr std::array<mqc_lut_state, MQC_LUT_NUMSTATES> mqc_lut_states = mqc_make_lut_states();
+
 static void mqc_init_dec_common(mqcoder* mqc, uint8_t* bp, uint32_t len)
 {
 	mqc->start = bp;
@@ -126,4 +142,106 @@ void mqc_resetstates(mqcoder* mqc)
 	mqc->ctxs[T1_CTXNO_ZC] = mqc_states + (uint32_t)(4 << 1);
 }
 
+/**
+ * Bit stream writer for mqc_raw_unstuff()
+ */
+struct mqc_raw_bit_writer
+{
+	explicit mqc_raw_bit_writer(uint64_t* dest) : start(dest), wp(dest), acc(0), numBits(0) {}
+	/* append 64 bits */
+	void putWord(uint64_t w)
+	{
+		*wp++ = acc | (w >> numBits);
+		acc = numBits ? w << (64 - numBits) : 0;
+	}
+	/* append n <= 8 bits */
+	void putBits(uint32_t v, uint32_t n)
+	{
+		if(numBits + n < 64)
+		{
+			acc |= (uint64_t)v << (64 - numBits - n);
+			numBits += n;
+			return;
+		}
+		uint32_t rem = numBits + n - 64;
+		*wp++ = acc | ((uint64_t)v >> rem);
+		acc = rem ? (uint64_t)v << (64 - rem) : 0;
+		numBits = rem;
+	}
+	/* pad final word with ones */
+	uint32_t finish(void)
+	{
+		if(numBits)
+			*wp++ = acc | (~(uint64_t)0 >> numBits);
+
+		return (uint32_t)(wp - start);
+	}
+	uint64_t* start;
+	uint64_t* wp;
+	uint64_t acc;
+	uint32_t numBits;
+};
+
+uint32_t mqc_raw_unstuff(const uint8_t* bp, uint32_t len, uint64_t* dest)
+{
+	mqc_raw_bit_writer writer(dest);
+	bool prevFF = false;
+	uint32_t i = 0;
+	while(i < len)
+	{
+		// fast path : eight bytes with no 0xFF among them, and no stuffed bit in the first
+		if(!prevFF && i + 8 <= len)
+		{
+			uint64_t w;
+			grk_read<uint64_t>(bp + i, &w);
+			uint64_t x = ~w;
+			if(((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) == 0)
+			{
+				writer.putWord(w);
+				i += 8;
+				continue;
+			}
+		}
+		uint8_t b = bp[i++];
+		if(prevFF)
+		{
+			// marker : mqc_raw_decode() stops here
+			if(b > 0x8f)
+				break;
+			writer.putBits(b & 0x7fU, 7);
+		}
+		else
+		{
+			writer.putBits(b, 8);
+		}
+		prevFF = (b == 0xff);
+	}
+
+	return writer.finish();
+}
+
+uint32_t mqc_raw_bytes_consumed(const uint8_t* bp, uint32_t len, uint64_t numBits)
+{
+	// replay the byte fetches of mqc_raw_decode(), which reads
+	// an artificial 0xFF 0xFF marker at the end of the segment
+	bool prevFF = false;
+	uint32_t i = 0;
+	while(numBits)
+	{
+		uint8_t b = i < len ? bp[i] : 0xff;
+		uint32_t n = 8;
+		if(prevFF)
+		{
+			if(b > 0x8f)
+				break;
+			n = 7;
+		}
+		i++;
+		numBits -= std::min<uint64_t>(numBits, n);
+		prevFF = (b == 0xff);
+	}
+
+	return i;
+}
+
 } // namespace grk
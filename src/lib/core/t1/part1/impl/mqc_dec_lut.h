@@ -0,0 +1,267 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+/**
+ * Compact MQ probability state. A state is addressed by a small index,
+ * 2 * (probability estimate index) + mps, so that all contexts of a code block
+ * fit in a few bytes, and a state transition is a single table lookup.
+ */
+struct mqc_lut_state
+{
+	/** probability of the Least Probable Symbol, aligned with the C register */
+	uint32_t qeval_shift;
+	/** next state, indexed by 0 if an MPS was decoded and 1 if an LPS was decoded */
+	uint8_t next[2];
+	/** the Most Probable Symbol (0 or 1) */
+	uint8_t mps;
+};
+
+const uint8_t MQC_LUT_NUMSTATES = 47 * 2;
+
+/**
+ * Context : index of its current state
+ */
+typedef uint8_t mqc_lut_ctx;
+extern const std::array<mqc_lut_state, MQC_LUT_NUMSTATES> mqc_lut_states;
+
+/**
+ * Table-driven MQ decoder (ISO 15444-1 C.3.2).
+ *
+ * Decoder registers are loaded from an initialized mqcoder and held in locals
+ * for the duration of a coding pass; they are written back on destruction.
+ * Renormalization shifts by the full normalization distance at once,
+ * rather than one bit at a time, unless a new byte must be read part way.
+ */
+struct mqc_lut_decoder
+{
+	explicit mqc_lut_decoder(mqcoder* mqc)
+		: mqc_(mqc), c(mqc->c), a(mqc->a), ct(mqc->ct), bp(mqc->bp)
+	{}
+	~mqc_lut_decoder()
+	{
+		mqc_->c = c;
+		mqc_->a = a;
+		mqc_->ct = ct;
+		mqc_->bp = bp;
+	}
+
+	/**
+	 * Decode a decision
+	 *
+	 * @param state context state, updated in place
+	 * @return decoded symbol (0 or 1)
+	 */
+	FORCE_INLINE uint32_t decode(mqc_lut_ctx& state)
+	{
+		const auto s = mqc_lut_states[state];
+		uint32_t qeval = s.qeval_shift >> 16;
+		a -= qeval;
+		if(c < s.qeval_shift)
+		{
+			// LPS sub-interval, with conditional exchange
+			uint32_t lps = a >= qeval;
+			a = qeval;
+			state = s.next[lps];
+			renorm();
+			return s.mps ^ lps;
+		}
+		c -= s.qeval_shift;
+		if(a < A_MIN)
+		{
+			// MPS sub-interval, with conditional exchange
+			uint32_t lps = a < qeval;
+			state = s.next[lps];
+			renorm();
+			return s.mps ^ lps;
+		}
+
+		return s.mps;
+	}
+
+	/**
+	 * Decode a run of zero decisions in a single step, if the registers show that
+	 * none of them can be an LPS or require renormalization. In that case, the
+	 * context state does not change, and the result is identical to calling
+	 * decode() numDecisions times.
+	 *
+	 * @param state context state
+	 * @param numDecisions number of decisions
+	 * @return true if all decisions were decoded as zero, otherwise false,
+	 * and no decisions were decoded
+	 */
+	FORCE_INLINE bool decode_zero_run(mqc_lut_ctx state, uint32_t numDecisions)
+	{
+		const auto s = mqc_lut_states[state];
+		if(s.mps)
+			return false;
+		uint64_t span = (uint64_t)numDecisions * (s.qeval_shift >> 16);
+		uint64_t cspan = span << 16;
+		if((uint64_t)a < A_MIN + span || (uint64_t)c < cspan)
+			return false;
+		a -= (uint32_t)span;
+		c -= (uint32_t)cspan;
+
+		return true;
+	}
+
+  private:
+	FORCE_INLINE void bytein(void)
+	{
+		/* Given mqc_init_dec() we know that at some point we will */
+		/* have a 0xFF 0xFF artificial marker */
+		uint32_t l_c = bp[1];
+		if(*bp == 0xff)
+		{
+			if(l_c > 0x8f)
+			{
+				c += 0xff00;
+				ct = 8;
+				mqc_->end_of_byte_stream_counter++;
+			}
+			else
+			{
+				bp++;
+				c += l_c << 9;
+				ct = 7;
+			}
+		}
+		else
+		{
+			bp++;
+			c += l_c << 8;
+			ct = 8;
+		}
+	}
+	FORCE_INLINE void renorm(void)
+	{
+		// a is non-zero and less than A_MIN
+		uint32_t shift = (uint32_t)std::countl_zero(a) - 16;
+		if(ct >= shift)
+		{
+			a <<= shift;
+			c <<= shift;
+			ct -= shift;
+			return;
+		}
+		while(shift)
+		{
+			if(ct == 0)
+				bytein();
+			uint32_t n = std::min(shift, ct);
+			a <<= n;
+			c <<= n;
+			ct -= n;
+			shift -= n;
+		}
+	}
+
+	mqcoder* mqc_;
+	uint32_t c;
+	uint32_t a;
+	uint32_t ct;
+	uint8_t* bp;
+};
+
+/**
+ * Unstuff a raw (BYPASS) segment into a contiguous bit stream,
+ * most significant bit first. Stuffed bits following 0xFF bytes are removed,
+ * and the stream ends at the first marker, exactly where mqc_raw_decode()
+ * would stop advancing.
+ *
+ * @param bp segment data
+ * @param len segment length
+ * @param dest destination, which must hold at least mqc_raw_unstuffed_words(len) words
+ * @return number of words written
+ */
+uint32_t mqc_raw_unstuff(const uint8_t* bp, uint32_t len, uint64_t* dest);
+
+/**
+ * Get number of words needed to unstuff a raw segment
+ *
+ * @param len segment length
+ * @return number of 64 bit words
+ */
+constexpr uint32_t mqc_raw_unstuffed_words(uint32_t len)
+{
+	return len / 8 + 2;
+}
+
+/**
+ * Get number of segment bytes that mqc_raw_decode() would have consumed
+ * after decoding a given number of bits
+ *
+ * @param bp segment data
+ * @param len segment length
+ * @param numBits number of decoded bits
+ * @return number of bytes
+ */
+uint32_t mqc_raw_bytes_consumed(const uint8_t* bp, uint32_t len, uint64_t numBits);
+
+/**
+ * Raw (BYPASS) decoder reading a bit stream produced by mqc_raw_unstuff().
+ * Decoding returns the same symbols as mqc_raw_decode(), with a refill
+ * every 64 bits rather than a byte fetch every 8 bits. Past the end of the
+ * stream, all bits are one.
+ */
+struct mqc_raw_lut_decoder
+{
+	mqc_raw_lut_decoder(void) : wp(nullptr), wend(nullptr), cur(0), avail(0), numBits(0) {}
+	void init(const uint64_t* words, uint32_t numWords)
+	{
+		wp = words;
+		wend = words + numWords;
+		cur = 0;
+		avail = 0;
+		numBits = 0;
+	}
+
+	/**
+	 * Decode a raw symbol
+	 *
+	 * @return decoded symbol (0 or 1)
+	 */
+	FORCE_INLINE uint32_t decode(void)
+	{
+		if(avail == 0)
+		{
+			cur = wp < wend ? *wp++ : ~(uint64_t)0;
+			avail = 64;
+			numBits += 64;
+		}
+		uint32_t v = (uint32_t)(cur >> 63);
+		cur <<= 1;
+		avail--;
+
+		return v;
+	}
+	/**
+	 * Get number of bits decoded so far
+	 */
+	uint64_t bitsDecoded(void) const
+	{
+		return numBits - avail;
+	}
+
+  private:
+	const uint64_t* wp;
+	const uint64_t* wend;
+	uint64_t cur;
+	uint32_t avail;
+	uint64_t numBits;
+};
@@ -29,6 +29,16 @@
 #endif /* defined(<Compiler>) */
 #endif /* INLINE */
 
+#ifndef FORCE_INLINE
+#if defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define FORCE_INLINE inline
+#endif /* defined(<Compiler>) */
+#endif /* FORCE_INLINE */
+
 /////////////////
 // buffer padding
 
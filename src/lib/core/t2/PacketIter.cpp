@@ -902,7 +902,8 @@ void PacketIter::init(PacketManager* packetMan, uint32_t pino, TileCodingParams*
 }
 bool PacketIter::isWholeTile(void)
 {
-	return compression_ || packetManager->getTileProcessor()->cp_->wholeTileDecompress_;
+	return compression_ || packetManager->getTileProcessor()->cp_->wholeTileDecompress_ ||
+		   packetManager->getTileProcessor()->retainsPackets();
 }
 bool PacketIter::next(SparseBuffer* src)
 {
@@ -0,0 +1,202 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+namespace grk
+{
+PacketSizeEstimator::PacketSizeEstimator(TileProcessor* tileProcessor)
+	: t2_(tileProcessor), packetOverhead_(0), committedBytes_(0), numCommittedLayers_(0)
+{
+	auto tcp = tileProcessor->getTileCodingParams();
+	if(tcp->csty & J2K_CP_CSTY_SOP)
+		packetOverhead_ += 6;
+	if(tcp->csty & J2K_CP_CSTY_EPH)
+		packetOverhead_ += 2;
+	auto tile = tileProcessor->getTile();
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numresolutions; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			uint64_t numPrecincts = (uint64_t)res->precinctGridWidth * res->precinctGridHeight;
+			for(uint64_t precinctIndex = 0; precinctIndex < numPrecincts; ++precinctIndex)
+				precincts_.emplace_back(res, precinctIndex);
+		}
+	}
+}
+bool PacketSizeEstimator::canEstimate(CodingParams* cp)
+{
+	// component size limits depend on packet order, so they need T2 simulation
+	return cp->coding_params_.enc_.max_comp_size_ == 0;
+}
+bool PacketSizeEstimator::estimate(uint16_t layno, uint64_t* allPacketBytes)
+{
+	assert(layno == numCommittedLayers_);
+	uint64_t bytes = committedBytes_;
+	for(auto& prc : precincts_)
+	{
+		if(contributionsChanged(&prc, layno))
+		{
+			if(!packetBytes(&prc, layno, false, &prc.bytes_))
+				return false;
+			prc.valid_ = true;
+		}
+		bytes += prc.bytes_;
+	}
+	*allPacketBytes = bytes;
+
+	return true;
+}
+bool PacketSizeEstimator::commit(uint16_t layno)
+{
+	assert(layno == numCommittedLayers_);
+	for(auto& prc : precincts_)
+	{
+		uint64_t bytes = 0;
+		if(!packetBytes(&prc, layno, true, &bytes))
+			return false;
+		committedBytes_ += bytes;
+		prc.valid_ = false;
+	}
+	numCommittedLayers_ = (uint16_t)(layno + 1);
+
+	return true;
+}
+bool PacketSizeEstimator::contributionsChanged(PrecinctPackets* prc, uint16_t layno)
+{
+	bool changed = !prc->valid_;
+	size_t i = 0;
+	auto update = [prc, &i, &changed](uint32_t val) {
+		if(i == prc->contributions_.size())
+		{
+			prc->contributions_.push_back(val);
+			changed = true;
+		}
+		else if(prc->contributions_[i] != val)
+		{
+			prc->contributions_[i] = val;
+			changed = true;
+		}
+		i++;
+	};
+	auto res = prc->res_;
+	for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		auto precinct = band->precincts[prc->precinctIndex_];
+		uint64_t numBlocks = precinct->getNumCblks();
+		if(band->empty() || !numBlocks)
+			continue;
+		for(uint64_t cblkno = 0; cblkno < numBlocks; ++cblkno)
+		{
+			auto cblk = precinct->getCompressedBlockPtr(cblkno);
+			auto layer = cblk->layers + layno;
+			update(layer->numpasses);
+			if(layer->numpasses)
+			{
+				update(layer->len);
+				update(cblk->numbps);
+			}
+		}
+	}
+
+	return changed;
+}
+bool PacketSizeEstimator::packetBytes(PrecinctPackets* prc, uint16_t layno, bool commit,
+									  uint64_t* bytes)
+{
+	// header state is reset for the first layer, so it need not be restored
+	bool restore = !commit && layno > 0;
+	if(restore)
+		saveState(prc);
+	BitIO bio(nullptr, UINT_MAX, true);
+	bool rc = t2_.compressHeader(&bio, prc->res_, layno, prc->precinctIndex_);
+	uint64_t packetBytes = packetOverhead_ + bio.numBytes();
+	auto res = prc->res_;
+	for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		auto precinct = band->precincts[prc->precinctIndex_];
+		uint64_t numBlocks = precinct->getNumCblks();
+		for(uint64_t cblkno = 0; cblkno < numBlocks; ++cblkno)
+		{
+			auto cblk = precinct->getCompressedBlockPtr(cblkno);
+			auto layer = cblk->layers + layno;
+			if(!layer->numpasses)
+				continue;
+			packetBytes += layer->len;
+			if(commit)
+				cblk->incNumPassesInPacket(0, (uint8_t)layer->numpasses);
+		}
+	}
+	if(restore)
+		restoreState(prc);
+	*bytes = packetBytes;
+
+	return rc;
+}
+void PacketSizeEstimator::saveState(PrecinctPackets* prc)
+{
+	inclState_.clear();
+	imsbState_.clear();
+	numlenbits_.clear();
+	auto res = prc->res_;
+	for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		auto precinct = band->precincts[prc->precinctIndex_];
+		uint64_t numBlocks = precinct->getNumCblks();
+		if(band->empty() || !numBlocks)
+			continue;
+		auto inclTree = precinct->getInclTree();
+		auto offset = inclState_.size();
+		inclState_.resize(offset + inclTree->getNumNodes());
+		inclTree->saveState(inclState_.data() + offset);
+		auto imsbTree = precinct->getImsbTree();
+		offset = imsbState_.size();
+		imsbState_.resize(offset + imsbTree->getNumNodes());
+		imsbTree->saveState(imsbState_.data() + offset);
+		for(uint64_t cblkno = 0; cblkno < numBlocks; ++cblkno)
+			numlenbits_.push_back(precinct->getCompressedBlockPtr(cblkno)->numlenbits);
+	}
+}
+void PacketSizeEstimator::restoreState(PrecinctPackets* prc)
+{
+	size_t inclOffset = 0;
+	size_t imsbOffset = 0;
+	size_t blockOffset = 0;
+	auto res = prc->res_;
+	for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		auto precinct = band->precincts[prc->precinctIndex_];
+		uint64_t numBlocks = precinct->getNumCblks();
+		if(band->empty() || !numBlocks)
+			continue;
+		auto inclTree = precinct->getInclTree();
+		inclTree->restoreState(inclState_.data() + inclOffset);
+		inclOffset += inclTree->getNumNodes();
+		auto imsbTree = precinct->getImsbTree();
+		imsbTree->restoreState(imsbState_.data() + imsbOffset);
+		imsbOffset += imsbTree->getNumNodes();
+		for(uint64_t cblkno = 0; cblkno < numBlocks; ++cblkno)
+			precinct->getCompressedBlockPtr(cblkno)->numlenbits = numlenbits_[blockOffset++];
+	}
+}
+
+} // namespace grk
@@ -0,0 +1,89 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace grk
+{
+/**
+ * Packet lengths of a tile during rate allocation, without a T2 simulation of
+ * all layers at every step of the bisection.
+ *
+ * Layers are committed in order. The packet headers of the layer being formed
+ * are encoded against the header state left by the committed layers, and this state
+ * is then restored. A precinct is only encoded again when the contributions of
+ * its code blocks to the layer have changed.
+ *
+ * Lengths are exact, but component size limits are not checked, so the
+ * estimator is only used when there are no such limits.
+ */
+class PacketSizeEstimator
+{
+  public:
+	explicit PacketSizeEstimator(TileProcessor* tileProcessor);
+	/**
+	 * Check if packet lengths for these coding parameters can be estimated
+	 */
+	static bool canEstimate(CodingParams* cp);
+	/**
+	 * Get length of all packets up to and including a layer, as currently formed
+	 *
+	 * @param layno layer number : all previous layers must have been committed
+	 * @param allPacketBytes length of all packets
+	 * @return true if successful
+	 */
+	bool estimate(uint16_t layno, uint64_t* allPacketBytes);
+	/**
+	 * Commit a layer once it has been formed, so that the next layer can be estimated
+	 *
+	 * @param layno layer number
+	 * @return true if successful
+	 */
+	bool commit(uint16_t layno);
+
+  private:
+	struct PrecinctPackets
+	{
+		PrecinctPackets(Resolution* res, uint64_t precinctIndex)
+			: res_(res), precinctIndex_(precinctIndex), bytes_(0), valid_(false)
+		{}
+		Resolution* res_;
+		uint64_t precinctIndex_;
+		// code block contributions to the layer when bytes_ was calculated
+		std::vector<uint32_t> contributions_;
+		uint64_t bytes_;
+		bool valid_;
+	};
+	bool contributionsChanged(PrecinctPackets* prc, uint16_t layno);
+	bool packetBytes(PrecinctPackets* prc, uint16_t layno, bool commit, uint64_t* bytes);
+	void saveState(PrecinctPackets* prc);
+	void restoreState(PrecinctPackets* prc);
+
+	T2Compress t2_;
+	std::vector<PrecinctPackets> precincts_;
+	uint64_t packetOverhead_;
+	uint64_t committedBytes_;
+	uint16_t numCommittedLayers_;
+	// header state of precinct, saved before estimating its packet
+	std::vector<TagTreeNode<uint16_t>> inclState_;
+	std::vector<TagTreeNode<uint8_t>> imsbState_;
+	std::vector<uint8_t> numlenbits_;
+};
+
+} // namespace grk
@@ -244,6 +244,8 @@ bool T2Compress::compressHeader(BitIO* bio, Resolution* res, uint16_t layno, uin
 		}
 	}
 
+	bool isHT = tileProcessor->cp_->tcps[0].isHT();
+
 	// Empty header bit. Grok always sets this to 1,
 	// even though there is also an option to set it to zero.
 	if(!bio->write(1))
@@ -298,6 +300,18 @@ bool T2Compress::compressHeader(BitIO* bio, Resolution* res, uint16_t layno, uin
 			/* number of coding passes included */
 			if(!bio->putnumpasses(layer->numpasses))
 				return false;
+			if(isHT)
+			{
+				// single cleanup pass, chosen from alternatives by rate control
+				increment = (uint8_t)std::max<int8_t>(
+					0, int8_t(floorlog2(layer->len) + 1 - cblk->numlenbits));
+				if(!bio->putcommacode(increment))
+					return false;
+				cblk->numlenbits += increment;
+				if(!bio->write(layer->len, cblk->numlenbits))
+					return false;
+				continue;
+			}
 			uint32_t nb_passes = cblk->getNumPassesInPacket(0) + layer->numpasses;
 			auto pass = cblk->passes + cblk->getNumPassesInPacket(0);
 
@@ -59,6 +59,16 @@ struct T2Compress
 								 uint32_t max_len, uint32_t tppos, PLMarkerMgr* markers,
 								 bool isFinal, bool debug);
 
+	/**
+	 Encode a packet header. Packet headers of a precinct must be encoded in layer order,
+	 as they depend on the header state of the precinct's previous layers.
+	 @param bio 			bit writer
+	 @param res 			resolution
+	 @param layno 			layer number
+	 @param precinctIndex 	precinct index
+	 */
+	bool compressHeader(BitIO* bio, Resolution* res, uint16_t layno, uint64_t precinctIndex);
+
   private:
 	TileProcessor* tileProcessor;
 
@@ -84,8 +94,6 @@ struct T2Compress
 	 */
 	bool compressPacketSimulate(TileCodingParams* tcp, PacketIter* pi, uint32_t* p_data_written,
 								uint32_t len, PLMarkerMgr* markers, bool debug);
-
-	bool compressHeader(BitIO* bio, Resolution* res, uint16_t layno, uint64_t precinctIndex);
 };
 
 } // namespace grk
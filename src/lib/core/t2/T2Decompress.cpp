@@ -106,8 +106,11 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 	auto tilec = tileProcessor->getTile()->comps + compno;
 	auto res = tilec->resolutions_ + resno;
 	auto tcp = tileProcessor->getTileCodingParams();
-	auto skip = layno >= tcp->numLayersToDecompress || resno >= tilec->numResolutionsToDecompress;
-	if(!skip && !tilec->isWholeTileDecoding())
+	// retained packets must cover all resolutions, and the whole tile
+	bool retain = tileProcessor->retainsPackets();
+	auto skip = layno >= tcp->numLayersToDecompress ||
+				(!retain && resno >= tilec->numResolutionsToDecompress);
+	if(!skip && !retain && !tilec->isWholeTileDecoding())
 	{
 		skip = true;
 		auto tilecBuffer = tilec->getWindow();
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <limits>
 
 namespace grk
@@ -141,6 +142,29 @@ class TagTree
 			current_node->known = false;
 		}
 	}
+	/**
+	 Get number of nodes in tree
+	 */
+	uint64_t getNumNodes(void) const
+	{
+		return nodeCount;
+	}
+	/**
+	 Save state of all nodes
+	 @param state destination for getNumNodes() nodes
+	 */
+	void saveState(TagTreeNode<T>* state) const
+	{
+		std::copy(nodes, nodes + nodeCount, state);
+	}
+	/**
+	 Restore state of all nodes, previously saved from this tree
+	 @param state saved nodes
+	 */
+	void restoreState(const TagTreeNode<T>* state)
+	{
+		std::copy(state, state + nodeCount, nodes);
+	}
 	/**
 	 Set the value of a leaf of a tag tree
 	 @param leafno leaf to modify
@@ -31,13 +31,16 @@ TileProcessor::TileProcessor(uint16_t tileIndex, CodeStream* codeStream, Buffere
 	  tileIndex_(tileIndex), stream_(stream), corrupt_packet_(false),
 	  newTilePartProgressionPosition(cp_->coding_params_.enc_.newTilePartProgressionPosition),
 	  tcp_(cp_->tcps + tileIndex_), truncated(false), image_(nullptr), isCompressor_(isCompressor),
-	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache))
+	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache)),
+	  t1Pool_(codeStream->getT1Pool()), retainPackets_(false), packetsRetained_(false), retainBlocks_(false),
+	  packetSizeEstimator_(nullptr), truncationThresh_(0), lastLayerThresh_(0)
 {}
 TileProcessor::~TileProcessor()
 {
 	release(GRK_TILE_CACHE_NONE);
 	delete scheduler_;
 	delete mct_;
+	delete packetSizeEstimator_;
 }
 uint64_t TileProcessor::getTilePartDataLength(void)
 {
@@ -147,6 +150,10 @@ Scheduler* TileProcessor::getScheduler(void)
 {
 	return scheduler_;
 }
+T1Pool* TileProcessor::getT1Pool(void)
+{
+	return t1Pool_;
+}
 bool TileProcessor::isCompressor(void)
 {
 	return isCompressor_;
@@ -161,20 +168,88 @@ GrkImage* TileProcessor::getImage(void)
 {
 	return image_;
 }
+/**
+ * Retain a copy of (single tile) output image, for the tile cache
+ */
+bool TileProcessor::retainImage(GrkImage* src)
+{
+	if(image_)
+		grk_object_unref(&image_->obj);
+	image_ = src->duplicate();
+
+	return image_ != nullptr;
+}
 void TileProcessor::release(GRK_TILE_CACHE_STRATEGY strategy)
 {
 	// delete image in absence of tile cache strategy
-	if(strategy == GRK_TILE_CACHE_NONE)
+	if(strategy == GRK_TILE_CACHE_NONE || strategy == GRK_TILE_CACHE_PACKETS ||
+	   strategy == GRK_TILE_CACHE_BLOCKS)
 	{
 		if(image_)
 			grk_object_unref(&image_->obj);
 		image_ = nullptr;
 	}
+	// keep tile components, with their parsed code blocks
+	if((strategy == GRK_TILE_CACHE_PACKETS || strategy == GRK_TILE_CACHE_BLOCKS) &&
+	   retainPackets_ && tile)
+	{
+		packetsRetained_ = true;
+		return;
+	}
+	packetsRetained_ = false;
 
 	// delete tile components
 	delete tile;
 	tile = nullptr;
 }
+void TileProcessor::setRetainPackets(bool retain)
+{
+	retainPackets_ = retain;
+}
+bool TileProcessor::retainsPackets(void)
+{
+	return retainPackets_;
+}
+void TileProcessor::setRetainBlocks(bool retain)
+{
+	retainBlocks_ = retain;
+}
+bool TileProcessor::retainsBlocks(void)
+{
+	return retainBlocks_;
+}
+uint64_t TileProcessor::getRetainedBlockBytes(void)
+{
+	uint64_t rc = 0;
+	if(!retainBlocks_ || !packetsRetained_)
+		return rc;
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numresolutions; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+			{
+				for(auto precinct : res->tileBand[bandIndex].precincts)
+				{
+					for(uint64_t cblkno = 0; cblkno < precinct->getNumCblks(); ++cblkno)
+					{
+						auto cblk = precinct->tryGetDecompressedBlockPtr(cblkno);
+						if(cblk && cblk->isOpen())
+							rc += (uint64_t)cblk->stride * cblk->height() * sizeof(int32_t);
+					}
+				}
+			}
+		}
+	}
+
+	return rc;
+}
+bool TileProcessor::hasRetainedPackets(void)
+{
+	return packetsRetained_;
+}
 PacketTracker* TileProcessor::getPacketTracker(void)
 {
 	return &packetTracker_;
@@ -191,6 +266,12 @@ uint8_t TileProcessor::getMaxNumDecompressResolutions(void)
 	{
 		auto tccp = tcp->tccps + compno;
 		auto numresolutions = tccp->numresolutions;
+		// retained packets must cover all resolutions
+		if(retainPackets_)
+		{
+			rc = std::max<uint8_t>(rc, numresolutions);
+			continue;
+		}
 		uint8_t resToDecomp;
 		if(numresolutions < cp_->coding_params_.dec_.reduce_)
 			resToDecomp = 1;
@@ -298,6 +379,10 @@ bool TileProcessor::createWindowBuffers(const GrkImage* outputImage)
 
 grk_rect32 TileProcessor::getUnreducedTileWindow(void)
 {
+	// retained packets must cover the whole tile
+	if(retainPackets_)
+		return *((grk_rect32*)tile);
+
 	return unreducedImageWindow.clip(tile);
 }
 
@@ -309,7 +394,7 @@ void TileProcessor::deallocBuffers()
 		tile_comp->dealloc();
 	}
 }
-bool TileProcessor::doCompress(void)
+bool TileProcessor::compressT1(void)
 {
 	uint32_t state = grk_plugin_get_debug_state();
 #ifdef PLUGIN_DEBUG_ENCODE
@@ -340,15 +425,28 @@ bool TileProcessor::doCompress(void)
 			if(!dwt_encode())
 				return false;
 		}
-		t1_encode();
+		t1_encode(true);
 	}
+
+	return true;
+}
+bool TileProcessor::doCompress(void)
+{
+	if(!compressT1())
+		return false;
 	// 1. create PLT marker if required
-	packetLengthCache.deleteMarkers();
-	if(cp_->coding_params_.enc_.writePLT)
-		packetLengthCache.createMarkers(stream_);
+	createPacketLengthMarkers();
 	// 2. rate control
 	uint32_t allPacketBytes = 0;
 	bool rc = rateAllocate(&allPacketBytes, false);
+	if(rc && truncationThresh_ && lastLayerThresh_ <= truncationThresh_)
+	{
+		// passes that were never coded may have been included,
+		// so compress tile again without truncation
+		t1_encode(false);
+		createPacketLengthMarkers();
+		rc = rateAllocate(&allPacketBytes, false);
+	}
 	if(!rc)
 	{
 		Logger::logger_.warn("Unable to perform rate control on tile %d", tileIndex_);
@@ -361,6 +459,18 @@ bool TileProcessor::doCompress(void)
 			return false;
 		}
 	}
+	preCalculateTileLen(allPacketBytes);
+
+	return true;
+}
+void TileProcessor::createPacketLengthMarkers(void)
+{
+	packetLengthCache.deleteMarkers();
+	if(cp_->coding_params_.enc_.writePLT)
+		packetLengthCache.createMarkers(stream_);
+}
+void TileProcessor::preCalculateTileLen(uint32_t allPacketBytes)
+{
 	packetTracker_.clear();
 
 	if(canPreCalculateTileLen())
@@ -383,7 +493,6 @@ bool TileProcessor::doCompress(void)
 		// calculate packets length
 		preCalculatedTileLen += allPacketBytes;
 	}
-	return true;
 }
 bool TileProcessor::canWritePocMarker(void)
 {
@@ -440,10 +549,23 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		Logger::logger_.error("Decompress: Tile %u has no compressed data", getIndex());
 		return false;
 	}
+	if(!tcp->compressedTileData_->readDeferred(stream_))
+	{
+		Logger::logger_.error("Decompress: unable to read compressed data for tile %u", getIndex());
+		return false;
+	}
 	bool doT1 = !current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T1);
 	bool doPostT1 =
 		!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_POST_T1);
 
+	// tile components with retained packets are updated for
+	// current resolution reduction and window
+	if(packetsRetained_)
+	{
+		for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+			tile->comps[compno].updateDecompressResolutions(cp_);
+	}
+
 	// create window buffers
 	// (no buffer allocation)
 	if(!createWindowBuffers(outputImage))
@@ -459,7 +581,8 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 			break;
 		}
 	}
-	bool doT2 = !current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T2);
+	bool doT2 = !packetsRetained_ &&
+				(!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T2));
 	if(doT2)
 	{
 		auto t2 = std::make_unique<T2Decompress>(this);
@@ -474,7 +597,8 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
 		{
 			auto tilec = tile->comps + compno;
-			for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+			uint8_t numRes = retainPackets_ ? tilec->numresolutions : tilec->numResolutionsToDecompress;
+			for(uint8_t resno = 0; resno < numRes; ++resno)
 			{
 				auto res = tilec->resolutions_ + resno;
 				parserCount += res->parserMap_->precinctParsers_.size();
@@ -489,7 +613,9 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
 				{
 					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+					uint8_t numRes =
+						retainPackets_ ? tilec->numresolutions : tilec->numResolutionsToDecompress;
+					for(uint8_t resno = 0; resno < numRes; ++resno)
 					{
 						auto res = tilec->resolutions_ + resno;
 						for(const auto& pp : res->parserMap_->precinctParsers_)
@@ -522,7 +648,9 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
 				{
 					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+					uint8_t numRes =
+						retainPackets_ ? tilec->numresolutions : tilec->numResolutionsToDecompress;
+					for(uint8_t resno = 0; resno < numRes; ++resno)
 					{
 						auto res = tilec->resolutions_ + resno;
 						for(const auto& pp : res->parserMap_->precinctParsers_)
@@ -547,10 +675,28 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 						}
 					}
 				}
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] tasks;
 			}
 		}
+		if(retainPackets_)
+		{
+			for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+			{
+				auto tilec = tile->comps + compno;
+				tilec->highestResolutionParsed = tilec->highestResolutionDecompressed;
+			}
+		}
+	}
+	// retained packets may include resolutions above those to be decompressed
+	if(retainPackets_)
+	{
+		for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+		{
+			auto tilec = tile->comps + compno;
+			tilec->highestResolutionDecompressed = std::min<uint8_t>(
+				tilec->highestResolutionParsed, (uint8_t)(tilec->numResolutionsToDecompress - 1));
+		}
 	}
 	// T1
 	if(doT1)
@@ -641,15 +787,15 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 	return true;
 }
 
-void TileProcessor::ingestImage()
+void TileProcessor::ingestImage(const GrkImage* srcImage)
 {
-	for(uint16_t i = 0; i < headerImage->numcomps; ++i)
+	for(uint16_t i = 0; i < srcImage->numcomps; ++i)
 	{
 		auto tilec = tile->comps + i;
-		auto img_comp = headerImage->comps + i;
+		auto img_comp = srcImage->comps + i;
 
-		uint32_t offset_x = ceildiv<uint32_t>(headerImage->x0, img_comp->dx);
-		uint32_t offset_y = ceildiv<uint32_t>(headerImage->y0, img_comp->dy);
+		uint32_t offset_x = ceildiv<uint32_t>(srcImage->x0, img_comp->dx);
+		uint32_t offset_y = ceildiv<uint32_t>(srcImage->y0, img_comp->dy);
 		uint64_t image_offset =
 			(tilec->x0 - offset_x) + (uint64_t)(tilec->y0 - offset_y) * img_comp->stride;
 		auto src = img_comp->data + image_offset;
@@ -802,7 +948,7 @@ bool TileProcessor::dwt_encode()
 	}
 	return rc;
 }
-void TileProcessor::t1_encode()
+void TileProcessor::t1_encode(bool predictTruncation)
 {
 	const double* mct_norms;
 	uint16_t mct_numcomps = 0U;
@@ -823,8 +969,28 @@ void TileProcessor::t1_encode()
 		mct_norms = (const double*)(tcp->mct_norms);
 	}
 
-	scheduler_ = new CompressScheduler(tile, needsRateControl(), tcp, mct_norms, mct_numcomps);
-	scheduler_->schedule(0);
+	delete scheduler_;
+	auto scheduler =
+		new CompressScheduler(tile, t1Pool_, needsRateControl(), tcp, mct_norms, mct_numcomps,
+							  predictTruncation ? truncationBudget() : 0);
+	scheduler_ = scheduler;
+	scheduler->schedule(0);
+	truncationThresh_ = scheduler->getTruncationThresh();
+}
+uint64_t TileProcessor::truncationBudget(void)
+{
+	auto enc = &cp_->coding_params_.enc_;
+	if(!enc->earlyTermination_ || !enc->allocationByRateDistortion_ ||
+	   enc->allocationByFixedQuality_ || tcp_->isHT() ||
+	   enc->rateControlAlgorithm != GRK_RATE_CONTROL_PCRD_OPT)
+		return 0;
+	for(uint16_t layno = 0; layno < tcp_->max_layers_; ++layno)
+	{
+		if(tcp_->rates[layno] <= 0.0)
+			return 0;
+	}
+
+	return (uint64_t)tcp_->rates[tcp_->max_layers_ - 1];
 }
 bool TileProcessor::encodeT2(uint32_t* tileBytesWritten)
 {
@@ -930,7 +1096,7 @@ bool TileProcessor::encodeT2(uint32_t* tileBytesWritten)
 
 	return true;
 }
-bool TileProcessor::preCompressTile()
+bool TileProcessor::preCompressTile(const GrkImage* srcImage)
 {
 	tilePartCounter_ = 0;
 	first_poc_tile_part_ = true;
@@ -946,9 +1112,10 @@ bool TileProcessor::preCompressTile()
 	if(!rc)
 		return false;
 	uint32_t numTiles = (uint32_t)cp_->t_grid_height * cp_->t_grid_width;
-	bool transfer_image_to_tile = (numTiles == 1);
-	/* if we only have one tile, then simply set tile component data equal to
-	 * image component data. Otherwise, allocate tile data and copy */
+	bool transfer_image_to_tile = (numTiles == 1) && (srcImage == headerImage);
+	/* if we only have one tile, and source image is the header image, then simply
+	 * set tile component data equal to image component data.
+	 * Otherwise, allocate tile data and copy */
 	for(uint32_t j = 0; j < headerImage->numcomps; ++j)
 	{
 		auto tilec = tile->comps + j;
@@ -962,7 +1129,7 @@ bool TileProcessor::preCompressTile()
 		}
 	}
 	if(!transfer_image_to_tile)
-		ingestImage();
+		ingestImage(srcImage);
 
 	return true;
 }
@@ -1126,7 +1293,25 @@ bool TileProcessor::cacheTilePartPackets(CodeStreamDecompress* codeStream)
 				return false;
 			}
 		}
-		current_read_size = stream_->read(zeroCopy ? nullptr : buff, len);
+		if(!zeroCopy && codeStream->deferTilePartReads())
+		{
+			// copy bytes already buffered by the stream, and leave the rest
+			// to be read by the thread that decompresses this tile
+			auto buffered = std::min<uint64_t>(len, stream_->numBufferedBytes());
+			if(buffered)
+				current_read_size = stream_->read(buff, buffered);
+			if(current_read_size == buffered && len > buffered)
+			{
+				tcp->compressedTileData_->deferRead(buff + buffered, len - buffered,
+													stream_->tell());
+				if(stream_->skip((int64_t)(len - buffered)))
+					current_read_size = len;
+			}
+		}
+		else
+		{
+			current_read_size = stream_->read(zeroCopy ? nullptr : buff, len);
+		}
 		tcp->compressedTileData_->pushBack(buff, len, !zeroCopy);
 	}
 	if(current_read_size != tilePartDataLength)
@@ -1215,35 +1400,9 @@ bool TileProcessor::makeLayerFeasible(uint32_t layno, uint16_t thresh, bool fina
 								cumulative_included_passes_in_block = passno + 1;
 							}
 						}
-						layer->numpasses =
-							cumulative_included_passes_in_block - cblk->numPassesInPreviousPackets;
-						if(!layer->numpasses)
-						{
-							layer->distortion = 0;
+						if(!updateLayer(cblk, layer, cumulative_included_passes_in_block))
 							continue;
-						}
-						// update layer
 						allocationChanged = true;
-						if(cblk->numPassesInPreviousPackets == 0)
-						{
-							layer->len = cblk->passes[cumulative_included_passes_in_block - 1].rate;
-							layer->data = cblk->paddedCompressedStream;
-							layer->distortion =
-								cblk->passes[cumulative_included_passes_in_block - 1].distortiondec;
-						}
-						else
-						{
-							layer->len =
-								cblk->passes[cumulative_included_passes_in_block - 1].rate -
-								cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->data = cblk->paddedCompressedStream +
-										  cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->distortion =
-								cblk->passes[cumulative_included_passes_in_block - 1]
-									.distortiondec -
-								cblk->passes[cblk->numPassesInPreviousPackets - 1].distortiondec;
-						}
-
 						tile->layerDistoration[layno] += layer->distortion;
 						if(finalAttempt)
 							cblk->numPassesInPreviousPackets = cumulative_included_passes_in_block;
@@ -1256,19 +1415,13 @@ bool TileProcessor::makeLayerFeasible(uint32_t layno, uint16_t thresh, bool fina
 	return allocationChanged;
 }
 /*
- Hybrid rate control using bisect algorithm with optimal truncation points
+ Find feasible truncation points of all code blocks, and return the maximum
+ squared error of the tile
  */
-bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRateControl)
+double TileProcessor::computeConvexHulls(RateInfo* rateInfo, bool singleLossless)
 {
-	bool single_lossless = tcp_->max_layers_ == 1 && !layerNeedsRateControl(0);
-	const double K = 1;
 	double maxSE = 0;
-	auto tcp = tcp_;
 	uint32_t state = grk_plugin_get_debug_state();
-	RateInfo rateInfo;
-	uint64_t numPacketsPerLayer = 0;
-	uint64_t numCodeBlocks = 0;
-	bool debug = false;
 	for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
 	{
 		auto tilec = &tile->comps[compno];
@@ -1281,10 +1434,8 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 				auto band = &res->tileBand[bandIndex];
 				for(auto prc : band->precincts)
 				{
-					numPacketsPerLayer++;
 					for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); cblkno++)
 					{
-						numCodeBlocks++;
 						auto cblk = prc->getCompressedBlockPtr(cblkno);
 						uint32_t numPix = (uint32_t)cblk->area();
 						if(!(state & GRK_PLUGIN_STATE_PRE_TR1))
@@ -1294,10 +1445,10 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 													   &numPix);
 						}
 
-						if(!single_lossless)
+						if(!singleLossless)
 						{
 							RateControl::convexHull(cblk->passes, cblk->numPassesTotal);
-							rateInfo.synch(cblk);
+							rateInfo->synch(cblk);
 							numpix += numPix;
 						}
 					} /* cbklno */
@@ -1305,13 +1456,27 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 			} /* bandIndex */
 		} /* resno */
 
-		if(!single_lossless)
+		if(!singleLossless)
 		{
 			maxSE += (double)(((uint64_t)1 << headerImage->comps[compno].prec) - 1) *
 					 (double)(((uint64_t)1 << headerImage->comps[compno].prec) - 1) *
 					 (double)numpix;
 		}
 	} /* compno */
+
+	return maxSE;
+}
+/*
+ Hybrid rate control using bisect algorithm with optimal truncation points
+ */
+bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRateControl)
+{
+	bool single_lossless = tcp_->max_layers_ == 1 && !layerNeedsRateControl(0);
+	const double K = 1;
+	auto tcp = tcp_;
+	RateInfo rateInfo;
+	bool debug = false;
+	double maxSE = computeConvexHulls(&rateInfo, single_lossless);
 	auto t2 = T2Compress(this);
 	if(single_lossless)
 	{
@@ -1323,6 +1488,7 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 										  newTilePartProgressionPosition,
 										  packetLengthCache.getMarkers(), true, false);
 	}
+	std::unique_ptr<PacketSizeEstimator> estimator(createPacketSizeEstimator());
 	uint32_t min_slope = rateInfo.getMinimumThresh();
 	uint32_t max_slope = USHRT_MAX;
 	double cumulativeDistortion[maxCompressLayersGRK];
@@ -1363,10 +1529,8 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 				}
 				else
 				{
-					if(allocationChanged && !t2.compressPacketsSimulate(
-												tileIndex_, (uint16_t)(layno + 1U), allPacketBytes,
-												maxLayerLength, newTilePartProgressionPosition,
-												packetLengthCache.getMarkers(), false, false))
+					if(allocationChanged && !layerFits(estimator.get(), &t2, layno,
+													   maxLayerLength, allPacketBytes))
 					{
 						lowerBound = thresh;
 						continue;
@@ -1378,6 +1542,7 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 			/* Threshold for Marcela Index */
 			// start by including everything in this layer
 			uint32_t goodthresh = upperBound;
+			lastLayerThresh_ = (uint16_t)goodthresh;
 			makeLayerFeasible(layno, (uint16_t)goodthresh, true);
 			if(cp_->coding_params_.enc_.allocationByFixedQuality_)
 			{
@@ -1393,6 +1558,8 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 		{
 			makeLayerFinal(layno);
 		}
+		if(estimator && layno + 1 < tcp_->max_layers_ && !estimator->commit(layno))
+			return false;
 	}
 
 	// final simulation will generate correct PLT lengths
@@ -1404,6 +1571,85 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 	// assert(!disableRateControl || rc);
 	return rc;
 }
+/*
+ Packet lengths during bisection are estimated rather than simulated,
+ when rate targets are set and no T2 simulation is required
+ */
+PacketSizeEstimator* TileProcessor::createPacketSizeEstimator(void)
+{
+	if(!cp_->coding_params_.enc_.allocationByRateDistortion_ ||
+	   !PacketSizeEstimator::canEstimate(cp_))
+		return nullptr;
+
+	return new PacketSizeEstimator(this);
+}
+/*
+ Check if all packets up to and including layer fit in maxBytes
+ */
+bool TileProcessor::layerFits(PacketSizeEstimator* estimator, T2Compress* t2, uint16_t layno,
+							  uint32_t maxBytes, uint32_t* allPacketBytes)
+{
+	if(!estimator)
+		return t2->compressPacketsSimulate(tileIndex_, (uint16_t)(layno + 1U), allPacketBytes,
+										   maxBytes, newTilePartProgressionPosition,
+										   packetLengthCache.getMarkers(), false, false);
+	uint64_t bytes = 0;
+	if(!estimator->estimate(layno, &bytes) || bytes > maxBytes)
+		return false;
+	*allPacketBytes = (uint32_t)bytes;
+
+	return true;
+}
+bool TileProcessor::prepareGlobalRateAllocation(uint16_t* minimumThresh, double* maxSE)
+{
+	createPacketLengthMarkers();
+	delete packetSizeEstimator_;
+	packetSizeEstimator_ = createPacketSizeEstimator();
+	RateInfo rateInfo;
+	*maxSE = computeConvexHulls(&rateInfo, false);
+	*minimumThresh = rateInfo.getMinimumThresh();
+
+	return true;
+}
+bool TileProcessor::makeGlobalLayer(uint16_t layno, uint16_t thresh, bool finalAttempt,
+									uint64_t* allPacketBytes)
+{
+	if(finalAttempt && !layerNeedsRateControl(layno))
+		makeLayerFinal(layno);
+	else
+		makeLayerFeasible(layno, thresh, finalAttempt);
+	if(finalAttempt)
+		return !packetSizeEstimator_ || layno + 1 == tcp_->max_layers_ ||
+			   packetSizeEstimator_->commit(layno);
+	if(!allPacketBytes)
+		return true;
+	if(packetSizeEstimator_)
+		return packetSizeEstimator_->estimate(layno, allPacketBytes);
+	uint32_t bytes = 0;
+	auto t2 = T2Compress(this);
+	bool rc = t2.compressPacketsSimulate(tileIndex_, (uint16_t)(layno + 1U), &bytes, UINT_MAX,
+										 newTilePartProgressionPosition,
+										 packetLengthCache.getMarkers(), false, false);
+	*allPacketBytes = bytes;
+
+	return rc;
+}
+bool TileProcessor::finishGlobalRateAllocation(void)
+{
+	delete packetSizeEstimator_;
+	packetSizeEstimator_ = nullptr;
+	// final simulation will generate correct PLT lengths
+	// and correct tile length
+	uint32_t allPacketBytes = 0;
+	auto t2 = T2Compress(this);
+	if(!t2.compressPacketsSimulate(tileIndex_, tcp_->max_layers_, &allPacketBytes, UINT_MAX,
+								   newTilePartProgressionPosition, packetLengthCache.getMarkers(),
+								   true, false))
+		return false;
+	preCalculateTileLen(allPacketBytes);
+
+	return true;
+}
 /*
  Simple bisect algorithm to calculate optimal layer truncation points
  */
@@ -1491,6 +1737,7 @@ bool TileProcessor::pcrdBisectSimple(uint32_t* allPacketBytes, bool disableRateC
 										  newTilePartProgressionPosition,
 										  packetLengthCache.getMarkers(), true, false);
 	}
+	std::unique_ptr<PacketSizeEstimator> estimator(createPacketSizeEstimator());
 	double cumulativeDistortion[maxCompressLayersGRK];
 	double upperBound = max_slope;
 	uint32_t maxLayerLength = UINT_MAX;
@@ -1533,9 +1780,7 @@ bool TileProcessor::pcrdBisectSimple(uint32_t* allPacketBytes, bool disableRateC
 				}
 				else
 				{
-					if(!t2.compressPacketsSimulate(tileIndex_, layno + 1U, allPacketBytes,
-												   maxLayerLength, newTilePartProgressionPosition,
-												   packetLengthCache.getMarkers(), false, false))
+					if(!layerFits(estimator.get(), &t2, layno, maxLayerLength, allPacketBytes))
 					{
 						lowerBound = thresh;
 						continue;
@@ -1558,6 +1803,8 @@ bool TileProcessor::pcrdBisectSimple(uint32_t* allPacketBytes, bool disableRateC
 			makeLayerFinal(layno);
 			assert(layno == tcp_->max_layers_ - 1);
 		}
+		if(estimator && layno + 1 < tcp_->max_layers_ && !estimator->commit(layno))
+			return false;
 	}
 
 	// final simulation will generate correct PLT lengths
@@ -1567,6 +1814,45 @@ bool TileProcessor::pcrdBisectSimple(uint32_t* allPacketBytes, bool disableRateC
 									  newTilePartProgressionPosition,
 									  packetLengthCache.getMarkers(), true, false);
 }
+/*
+ Update layer with code block passes from the end of the previous layer
+ up to includedPasses. Returns false if the layer has no passes
+ */
+bool TileProcessor::updateLayer(CompressCodeblock* cblk, Layer* layer, uint32_t includedPasses)
+{
+	layer->numpasses = includedPasses - cblk->numPassesInPreviousPackets;
+	if(!layer->numpasses)
+	{
+		layer->distortion = 0;
+		return false;
+	}
+	auto pass = cblk->passes + includedPasses - 1;
+	if(tcp_->isHT())
+	{
+		// HT passes are alternatives : the last included pass replaces the others
+		assert(cblk->numPassesInPreviousPackets == 0);
+		layer->numpasses = 1;
+		layer->len = pass->rate;
+		layer->data = cblk->paddedCompressedStream + pass->offset;
+		layer->distortion = pass->distortiondec;
+		cblk->numbps = pass->numbps;
+	}
+	else if(cblk->numPassesInPreviousPackets == 0)
+	{
+		layer->len = pass->rate;
+		layer->data = cblk->paddedCompressedStream;
+		layer->distortion = pass->distortiondec;
+	}
+	else
+	{
+		auto previous = cblk->passes + cblk->numPassesInPreviousPackets - 1;
+		layer->len = pass->rate - previous->rate;
+		layer->data = cblk->paddedCompressedStream + previous->rate;
+		layer->distortion = pass->distortiondec - previous->distortiondec;
+	}
+
+	return true;
+}
 static void prepareBlockForFirstLayer(CompressCodeblock* cblk)
 {
 	cblk->numPassesInPreviousPackets = 0;
@@ -1635,30 +1921,8 @@ void TileProcessor::makeLayerSimple(uint32_t layno, double thresh, bool finalAtt
 									included_blk_passes = passno + 1;
 							}
 						}
-						layer->numpasses = included_blk_passes - cblk->numPassesInPreviousPackets;
-						if(!layer->numpasses)
-						{
-							layer->distortion = 0;
+						if(!updateLayer(cblk, layer, included_blk_passes))
 							continue;
-						}
-
-						// update layer
-						if(cblk->numPassesInPreviousPackets == 0)
-						{
-							layer->len = cblk->passes[included_blk_passes - 1].rate;
-							layer->data = cblk->paddedCompressedStream;
-							layer->distortion = cblk->passes[included_blk_passes - 1].distortiondec;
-						}
-						else
-						{
-							layer->len = cblk->passes[included_blk_passes - 1].rate -
-										 cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->data = cblk->paddedCompressedStream +
-										  cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->distortion =
-								cblk->passes[included_blk_passes - 1].distortiondec -
-								cblk->passes[cblk->numPassesInPreviousPackets - 1].distortiondec;
-						}
 						tile->layerDistoration[layno] += layer->distortion;
 						if(finalAttempt)
 							cblk->numPassesInPreviousPackets = included_blk_passes;
@@ -1693,29 +1957,8 @@ void TileProcessor::makeLayerFinal(uint32_t layno)
 						if(cblk->numPassesTotal > cblk->numPassesInPreviousPackets)
 							included_blk_passes = cblk->numPassesTotal;
 
-						layer->numpasses = included_blk_passes - cblk->numPassesInPreviousPackets;
-						if(!layer->numpasses)
-						{
-							layer->distortion = 0;
+						if(!updateLayer(cblk, layer, included_blk_passes))
 							continue;
-						}
-						// update layer
-						if(cblk->numPassesInPreviousPackets == 0)
-						{
-							layer->len = cblk->passes[included_blk_passes - 1].rate;
-							layer->data = cblk->paddedCompressedStream;
-							layer->distortion = cblk->passes[included_blk_passes - 1].distortiondec;
-						}
-						else
-						{
-							layer->len = cblk->passes[included_blk_passes - 1].rate -
-										 cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->data = cblk->paddedCompressedStream +
-										  cblk->passes[cblk->numPassesInPreviousPackets - 1].rate;
-							layer->distortion =
-								cblk->passes[included_blk_passes - 1].distortiondec -
-								cblk->passes[cblk->numPassesInPreviousPackets - 1].distortiondec;
-						}
 						tile->layerDistoration[layno] += layer->distortion;
 						cblk->numPassesInPreviousPackets = included_blk_passes;
 						assert(cblk->numPassesInPreviousPackets == cblk->numPassesTotal);
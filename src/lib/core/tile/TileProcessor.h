@@ -73,6 +73,9 @@ struct PacketTracker
  */
 
 class mct;
+class RateInfo;
+class PacketSizeEstimator;
+struct T2Compress;
 
 struct TileProcessor
 {
@@ -82,18 +85,68 @@ struct TileProcessor
 	bool init(void);
 	bool createWindowBuffers(const GrkImage* outputImage);
 	void deallocBuffers();
-	bool preCompressTile(void);
+	bool preCompressTile(const GrkImage* srcImage);
 	bool canWritePocMarker(void);
 	bool writeTilePartT2(uint32_t* tileBytesWritten);
 	bool doCompress(void);
+	/**
+	 * Compress tile up to and including T1, leaving rate allocation and T2 for later
+	 */
+	bool compressT1(void);
+	/**
+	 * Global rate allocation across all tiles of the image : compute convex hulls
+	 * of the code block truncation points
+	 *
+	 * @param minimumThresh minimum slope threshold of tile
+	 * @param maxSE maximum squared error of tile
+	 */
+	bool prepareGlobalRateAllocation(uint16_t* minimumThresh, double* maxSE);
+	/**
+	 * Global rate allocation : form layer from truncation points with slope above
+	 * an image-wide threshold. Layers that need no rate control are formed from all
+	 * remaining passes on the final attempt.
+	 *
+	 * @param layno layer number
+	 * @param thresh slope threshold
+	 * @param finalAttempt if true, layer is committed
+	 * @param allPacketBytes if not null, set to simulated length of all packets
+	 * up to and including this layer
+	 */
+	bool makeGlobalLayer(uint16_t layno, uint16_t thresh, bool finalAttempt,
+						 uint64_t* allPacketBytes);
+	/**
+	 * Global rate allocation : generate final packet lengths once all layers are formed
+	 */
+	bool finishGlobalRateAllocation(void);
 	bool decompressT2T1(GrkImage* outputImage);
 	bool ingestUncompressedData(uint8_t* p_src, uint64_t src_length);
 	bool needsRateControl();
-	void ingestImage();
+	void ingestImage(const GrkImage* srcImage);
 	bool cacheTilePartPackets(CodeStreamDecompress* codeStream);
 	void generateImage(GrkImage* src_image, Tile* src_tile);
 	GrkImage* getImage(void);
+	bool retainImage(GrkImage* src);
 	void release(GRK_TILE_CACHE_STRATEGY strategy);
+	/**
+	 * Set whether parsed packets are retained after decompression, so that
+	 * tile can be decompressed again at a different window or resolution
+	 * without re-reading its tile parts
+	 */
+	void setRetainPackets(bool retain);
+	bool retainsPackets(void);
+	bool hasRetainedPackets(void);
+	/**
+	 * Set whether decompressed code blocks are also retained, so that
+	 * they are not decompressed again by later decompressions of the tile
+	 */
+	void setRetainBlocks(bool retain);
+	bool retainsBlocks(void);
+	/**
+	 * Get memory held by retained decompressed code blocks
+	 *
+	 * @return number of bytes
+	 */
+	uint64_t getRetainedBlockBytes(void);
 	void setCorruptPacket(void);
 	PacketTracker* getPacketTracker(void);
 	grk_rect32 getUnreducedTileWindow(void);
@@ -106,6 +159,7 @@ struct TileProcessor
 	void incrementIndex(void);
 	Tile* getTile(void);
 	Scheduler* getScheduler(void);
+	T1Pool* getT1Pool(void);
 	bool isCompressor(void);
 
 	/** Compression Only
@@ -141,9 +195,26 @@ struct TileProcessor
 	bool dcLevelShiftCompress();
 	bool mct_encode();
 	bool dwt_encode();
-	void t1_encode();
+	/**
+	 * Compress code blocks
+	 *
+	 * @param predictTruncation if true, and the tile is compressed to a target rate,
+	 * code blocks may be truncated below a predicted slope threshold
+	 */
+	void t1_encode(bool predictTruncation);
+	/**
+	 * Get byte budget of tile, if code blocks can be truncated below a slope threshold
+	 * predicted from this budget : only for lossy Part 1 compression where all layers
+	 * have target rates, with per-tile bisection on feasible truncation points
+	 *
+	 * @return budget, or 0 if code blocks cannot be truncated
+	 */
+	uint64_t truncationBudget(void);
 	bool encodeT2(uint32_t* packet_bytes_written);
+	void createPacketLengthMarkers(void);
+	void preCalculateTileLen(uint32_t allPacketBytes);
 	bool rateAllocate(uint32_t* allPacketBytes, bool disableRateControl);
+	double computeConvexHulls(RateInfo* rateInfo, bool singleLossless);
 	bool layerNeedsRateControl(uint32_t layno);
 	bool makeSingleLosslessLayer();
 	void makeLayerFinal(uint32_t layno);
@@ -151,6 +222,10 @@ struct TileProcessor
 	void makeLayerSimple(uint32_t layno, double thresh, bool finalAttempt);
 	bool pcrdBisectFeasible(uint32_t* p_data_written, bool disableRateControl);
 	bool makeLayerFeasible(uint32_t layno, uint16_t thresh, bool finalAttempt);
+	bool updateLayer(CompressCodeblock* cblk, Layer* layer, uint32_t includedPasses);
+	PacketSizeEstimator* createPacketSizeEstimator(void);
+	bool layerFits(PacketSizeEstimator* estimator, T2Compress* t2, uint16_t layno,
+				   uint32_t maxBytes, uint32_t* allPacketBytes);
 
 	Tile* tile;
 	Scheduler* scheduler_;
@@ -175,6 +250,21 @@ struct TileProcessor
 	grk_rect32 unreducedImageWindow;
 	uint32_t preCalculatedTileLen;
 	mct* mct_;
+	// T1 coders shared with the other tiles of the code stream
+	T1Pool* t1Pool_;
+	// Decompressing Only
+	// parse all resolutions and layers, and keep tile after decompression
+	bool retainPackets_;
+	// true once tile has been released with its parsed packets intact
+	bool packetsRetained_;
+	// keep decompressed code blocks along with parsed packets
+	bool retainBlocks_;
+	// Compressing only - packet lengths during global rate allocation
+	PacketSizeEstimator* packetSizeEstimator_;
+	// Compressing only - slope threshold below which T1 truncated code blocks, or zero
+	uint16_t truncationThresh_;
+	// Compressing only - slope threshold of last layer formed by bisection
+	uint16_t lastLayerThresh_;
 };
 
 } // namespace grk
@@ -29,7 +29,7 @@ void grk_read(const uint8_t* buffer, TYPE* value, uint32_t numBytes);
 // buffered stream
 BufferedStream::BufferedStream(uint8_t* buffer, size_t buffer_size, bool is_input)
 	: user_data_(nullptr), free_user_data_fn_(nullptr), user_data_length_(0), read_fn_(nullptr),
-	  zero_copy_read_fn_(nullptr), write_fn_(nullptr), seek_fn_(nullptr),
+	  zero_copy_read_fn_(nullptr), write_fn_(nullptr), seek_fn_(nullptr), pread_fn_(nullptr),
 	  status_(is_input ? GROK_STREAM_STATUS_INPUT : GROK_STREAM_STATUS_OUTPUT), buf_(nullptr),
 	  buffered_bytes_(0), read_bytes_seekable_(0), stream_offset_(0), format_(GRK_CODEC_UNK)
 {
@@ -85,6 +85,35 @@ void BufferedStream::setSeekFunction(grk_stream_seek_fn fn)
 {
 	seek_fn_ = fn;
 }
+void BufferedStream::setPositionalReadFunction(grk_stream_pread_fn fn)
+{
+	pread_fn_ = fn;
+}
+size_t BufferedStream::readAt(uint8_t* buffer, size_t p_size, uint64_t offset)
+{
+	assert(pread_fn_);
+	if(!buffer || !pread_fn_)
+		return 0;
+	size_t read_nb_bytes = 0;
+	while(read_nb_bytes < p_size)
+	{
+		size_t bytes = pread_fn_(buffer + read_nb_bytes, p_size - read_nb_bytes,
+								 offset + read_nb_bytes, user_data_);
+		if(bytes == 0 || bytes > p_size - read_nb_bytes)
+			break;
+		read_nb_bytes += bytes;
+	}
+
+	return read_nb_bytes;
+}
+bool BufferedStream::supportsPositionalRead()
+{
+	return pread_fn_ && hasSeek() && (status_ & GROK_STREAM_STATUS_INPUT);
+}
+size_t BufferedStream::numBufferedBytes()
+{
+	return buffered_bytes_;
+}
 // note: passing in nullptr for buffer will execute a zero-copy read
 size_t BufferedStream::read(uint8_t* buffer, size_t p_size)
 {
@@ -47,6 +47,7 @@ struct BufferedStream
 	void setZeroCopyReadFunction(grk_stream_zero_copy_read_fn fn);
 	void setWriteFunction(grk_stream_write_fn fn);
 	void setSeekFunction(grk_stream_seek_fn fn);
+	void setPositionalReadFunction(grk_stream_pread_fn fn);
 	/**
 	 * Reads some bytes from the stream.
 	 * @param		buffer	pointer to the data buffer
@@ -56,6 +57,26 @@ struct BufferedStream
 	 * @return		the number of bytes read
 	 */
 	size_t read(uint8_t* buffer, size_t p_size);
+	/**
+	 * Reads some bytes from an absolute offset in the stream, without
+	 * changing the stream position. Safe to call concurrently with other
+	 * stream methods.
+	 * @param		buffer	pointer to the data buffer
+	 * 							that will receive the data.
+	 * @param		p_size		number of bytes to read.
+	 * @param		offset		absolute offset
+	 *
+	 * @return		the number of bytes read
+	 */
+	size_t readAt(uint8_t* buffer, size_t p_size, uint64_t offset);
+	/**
+	 * Check if stream supports positional reads
+	 */
+	bool supportsPositionalRead();
+	/**
+	 * Get number of bytes that can be read without reading from the media
+	 */
+	size_t numBufferedBytes();
 
 	// low-level write methods (endian taken into account)
 	bool writeShort(uint16_t value);
@@ -191,6 +212,10 @@ struct BufferedStream
 	 * Pointer to actual seek function (if available).
 	 */
 	grk_stream_seek_fn seek_fn_;
+	/**
+	 * Pointer to positional read function (optional)
+	 */
+	grk_stream_pread_fn pread_fn_;
 	/**
 	 * Stream status flags
 	 */
@@ -0,0 +1,294 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+#include "ColourConversion.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "util/ColourConversion.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/*
+	 * Each conversion evaluates the same operations, in the same order and precision,
+	 * as its scalar form below, which handles row tails. Floating point contraction
+	 * is disabled for this file, so vector and scalar results are identical.
+	 */
+
+	static HWY_INLINE int32_t clampSample(int32_t val, int32_t upb)
+	{
+		return val < 0 ? 0 : (val > upb ? upb : val);
+	}
+	static HWY_INLINE void syccPixel(int32_t offset, int32_t upb, int32_t y, int32_t cb,
+									 int32_t cr, int32_t* r, int32_t* g, int32_t* b)
+	{
+		cb -= offset;
+		cr -= offset;
+		*r = clampSample(y + (int32_t)(1.402 * cr), upb);
+		*g = clampSample(y - (int32_t)(0.344 * cb + 0.714 * cr), upb);
+		*b = clampSample(y + (int32_t)(1.772 * cb), upb);
+	}
+
+	void hwy_sycc_to_rgb_row(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+							 int32_t* g, int32_t* b, uint32_t w, uint32_t chromaW,
+							 bool subsampled, bool oddFirstX, bool zeroFirst, uint8_t prec)
+	{
+		int32_t offset = 1 << (prec - 1);
+		int32_t upb = (1 << prec) - 1;
+		uint32_t start = oddFirstX ? 1 : 0;
+		uint32_t x = 0;
+		if(oddFirstX && w)
+		{
+			bool zero = !cb || zeroFirst;
+			syccPixel(offset, upb, y[0], zero ? 0 : cb[0], zero ? 0 : cr[0], r, g, b);
+			x = 1;
+		}
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) df;
+		const Rebind<int32_t, decltype(df)> di;
+		const size_t N = Lanes(df);
+		// chroma lane i / 2 for luma lane i
+		HWY_ALIGN int32_t upsample[MaxLanes(di)];
+		for(size_t i = 0; i < N; ++i)
+			upsample[i] = (int32_t)(i / 2);
+		const auto upsampleIdx = SetTableIndices(di, upsample);
+		const auto voffset = Set(di, offset);
+		const auto vzero = Zero(di);
+		const auto vupb = Set(di, upb);
+		const auto kr = Set(df, 1.402);
+		const auto kgb = Set(df, 0.344);
+		const auto kgr = Set(df, 0.714);
+		const auto kb = Set(df, 1.772);
+		for(; x + N <= w; x += N)
+		{
+			uint32_t c = subsampled ? (x - start) / 2 : x - start;
+			auto vcb = vzero;
+			auto vcr = vzero;
+			if(cb)
+			{
+				if(c + N > chromaW)
+					break;
+				vcb = LoadU(di, cb + c);
+				vcr = LoadU(di, cr + c);
+				if(subsampled)
+				{
+					vcb = TableLookupLanes(vcb, upsampleIdx);
+					vcr = TableLookupLanes(vcr, upsampleIdx);
+				}
+			}
+			auto dcb = PromoteTo(df, Sub(vcb, voffset));
+			auto dcr = PromoteTo(df, Sub(vcr, voffset));
+			auto vy = LoadU(di, y + x);
+			auto vr = Add(vy, DemoteTo(di, Mul(kr, dcr)));
+			auto vg = Sub(vy, DemoteTo(di, Add(Mul(kgb, dcb), Mul(kgr, dcr))));
+			auto vb = Add(vy, DemoteTo(di, Mul(kb, dcb)));
+			StoreU(Clamp(vr, vzero, vupb), di, r + x);
+			StoreU(Clamp(vg, vzero, vupb), di, g + x);
+			StoreU(Clamp(vb, vzero, vupb), di, b + x);
+		}
+#endif
+		for(; x < w; ++x)
+		{
+			uint32_t c = subsampled ? (x - start) / 2 : x - start;
+			syccPixel(offset, upb, y[x], cb ? cb[c] : 0, cr ? cr[c] : 0, r + x, g + x, b + x);
+		}
+	}
+
+	void hwy_esycc_to_rgb_row(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t cbOffset,
+							  int32_t crOffset, int32_t upb)
+	{
+		uint32_t x = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) df;
+		const Rebind<int32_t, decltype(df)> di;
+		const size_t N = Lanes(df);
+		const auto vcbOffset = Set(di, cbOffset);
+		const auto vcrOffset = Set(di, crOffset);
+		const auto vzero = Zero(di);
+		const auto vupb = Set(di, upb);
+		const auto half = Set(df, 0.5);
+		for(; x + N <= w; x += N)
+		{
+			auto dy = PromoteTo(df, LoadU(di, y + x));
+			auto dcb = PromoteTo(df, Sub(LoadU(di, cb + x), vcbOffset));
+			auto dcr = PromoteTo(df, Sub(LoadU(di, cr + x), vcrOffset));
+			auto v0 = Add(Add(Sub(dy, Mul(Set(df, 0.0000368), dcb)), Mul(Set(df, 1.40199), dcr)),
+						  half);
+			auto v1 = Add(Sub(Sub(Mul(Set(df, 1.0003), dy), Mul(Set(df, 0.344125), dcb)),
+							  Mul(Set(df, 0.7141128), dcr)),
+						  half);
+			auto v2 = Add(Sub(Add(Mul(Set(df, 0.999823), dy), Mul(Set(df, 1.77204), dcb)),
+							  Mul(Set(df, 0.000008), dcr)),
+						  half);
+			StoreU(Clamp(DemoteTo(di, v0), vzero, vupb), di, y + x);
+			StoreU(Clamp(DemoteTo(di, v1), vzero, vupb), di, cb + x);
+			StoreU(Clamp(DemoteTo(di, v2), vzero, vupb), di, cr + x);
+		}
+#endif
+		for(; x < w; ++x)
+		{
+			int32_t vy = y[x];
+			int32_t vcb = cb[x] - cbOffset;
+			int32_t vcr = cr[x] - crOffset;
+			y[x] = clampSample((int32_t)(vy - 0.0000368 * vcb + 1.40199 * vcr + 0.5), upb);
+			cb[x] = clampSample((int32_t)(1.0003 * vy - 0.344125 * vcb - 0.7141128 * vcr + 0.5),
+								upb);
+			cr[x] = clampSample((int32_t)(0.999823 * vy + 1.77204 * vcb - 0.000008 * vcr + 0.5),
+								upb);
+		}
+	}
+
+	void hwy_cmyk_to_rgb_row(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+							 const float* scale)
+	{
+		const HWY_FULL(float) df;
+		const RebindToSigned<decltype(df)> di;
+		const size_t N = Lanes(df);
+		const auto one = Set(df, 1.0F);
+		const auto max = Set(df, 255.0F);
+		const auto sC = Set(df, scale[0]);
+		const auto sM = Set(df, scale[1]);
+		const auto sY = Set(df, scale[2]);
+		const auto sK = Set(df, scale[3]);
+		uint32_t x = 0;
+		for(; x + N <= w; x += N)
+		{
+			auto C = Sub(one, Mul(ConvertTo(df, LoadU(di, c + x)), sC));
+			auto M = Sub(one, Mul(ConvertTo(df, LoadU(di, m + x)), sM));
+			auto Y = Sub(one, Mul(ConvertTo(df, LoadU(di, y + x)), sY));
+			auto K = Sub(one, Mul(ConvertTo(df, LoadU(di, k + x)), sK));
+			StoreU(ConvertTo(di, Mul(Mul(max, C), K)), di, c + x);
+			StoreU(ConvertTo(di, Mul(Mul(max, M), K)), di, m + x);
+			StoreU(ConvertTo(di, Mul(Mul(max, Y), K)), di, y + x);
+		}
+		for(; x < w; ++x)
+		{
+			float C = 1.0F - (float)c[x] * scale[0];
+			float M = 1.0F - (float)m[x] * scale[1];
+			float Y = 1.0F - (float)y[x] * scale[2];
+			float K = 1.0F - (float)k[x] * scale[3];
+			c[x] = (int32_t)(255.0F * C * K);
+			m[x] = (int32_t)(255.0F * M * K);
+			y[x] = (int32_t)(255.0F * Y * K);
+		}
+	}
+
+	void hwy_lab_scale_row(const int32_t* L, const int32_t* a, const int32_t* b, double* dest,
+						   uint32_t w, const double* min, const double* range,
+						   const double* denom)
+	{
+		const int32_t* src[3] = {L, a, b};
+		for(uint32_t i = 0; i < 3; ++i)
+		{
+			auto s = src[i];
+			auto d = dest + (size_t)i * w;
+			uint32_t x = 0;
+#if HWY_HAVE_FLOAT64
+			const HWY_FULL(double) df;
+			const Rebind<int32_t, decltype(df)> di;
+			const size_t N = Lanes(df);
+			const auto vmin = Set(df, min[i]);
+			const auto vrange = Set(df, range[i]);
+			const auto vdenom = Set(df, denom[i]);
+			for(; x + N <= w; x += N)
+				StoreU(Add(vmin, Div(Mul(PromoteTo(df, LoadU(di, s + x)), vrange), vdenom)), df,
+					   d + x);
+#endif
+			for(; x < w; ++x)
+				d[x] = min[i] + (double)s[x] * range[i] / denom[i];
+		}
+	}
+
+	void hwy_widen_row(const uint16_t* src, int32_t* dest, uint32_t w)
+	{
+		const HWY_FULL(int32_t) di;
+		const Rebind<uint16_t, decltype(di)> du;
+		const size_t N = Lanes(di);
+		uint32_t x = 0;
+		for(; x + N <= w; x += N)
+			StoreU(PromoteTo(di, LoadU(du, src + x)), di, dest + x);
+		for(; x < w; ++x)
+			dest[x] = src[x];
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_sycc_to_rgb_row);
+HWY_EXPORT(hwy_esycc_to_rgb_row);
+HWY_EXPORT(hwy_cmyk_to_rgb_row);
+HWY_EXPORT(hwy_lab_scale_row);
+HWY_EXPORT(hwy_widen_row);
+
+void colourStrips(uint32_t numRows, const std::function<void(uint32_t, uint32_t)>& strip)
+{
+	// strips below this height are not worth a task
+	const uint32_t minRowsPerStrip = 16;
+	uint32_t numStrips = std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(),
+											(numRows + minRowsPerStrip - 1) / minRowsPerStrip);
+	if(numStrips <= 1)
+	{
+		if(numRows)
+			strip(0, numRows);
+		return;
+	}
+	uint32_t rowsPerStrip = (numRows + numStrips - 1) / numStrips;
+	tf::Taskflow taskflow;
+	for(uint32_t begin = 0; begin < numRows; begin += rowsPerStrip)
+	{
+		uint32_t end = std::min(begin + rowsPerStrip, numRows);
+		taskflow.emplace([&strip, begin, end] { strip(begin, end); });
+	}
+	ExecSingleton::run(taskflow);
+}
+void colourSyccToRgbRow(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+						int32_t* g, int32_t* b, uint32_t w, uint32_t chromaW, bool subsampled,
+						bool oddFirstX, bool zeroFirst, uint8_t prec)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_sycc_to_rgb_row)
+	(y, cb, cr, r, g, b, w, chromaW, subsampled, oddFirstX, zeroFirst, prec);
+}
+void colourEsyccToRgbRow(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t cbOffset,
+						 int32_t crOffset, int32_t upb)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_esycc_to_rgb_row)(y, cb, cr, w, cbOffset, crOffset, upb);
+}
+void colourCmykToRgbRow(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+						const float* scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_cmyk_to_rgb_row)(c, m, y, k, w, scale);
+}
+void colourLabScaleRow(const int32_t* L, const int32_t* a, const int32_t* b, double* dest,
+					   uint32_t w, const double* min, const double* range, const double* denom)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_lab_scale_row)(L, a, b, dest, w, min, range, denom);
+}
+void colourWidenRow(const uint16_t* src, int32_t* dest, uint32_t w)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_widen_row)(src, dest, w);
+}
+
+} // namespace grk
+#endif
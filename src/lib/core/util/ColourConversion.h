@@ -0,0 +1,86 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+
+namespace grk
+{
+/**
+ * Run strip(rowBegin, rowEnd) over rows [0, numRows),
+ * in parallel strips on the shared executor
+ *
+ * @param numRows number of rows
+ * @param strip strip function
+ */
+void colourStrips(uint32_t numRows, const std::function<void(uint32_t, uint32_t)>& strip);
+
+/**
+ * Vectorized colour conversion rows, dispatched to the best available SIMD target.
+ * Results are identical to the scalar conversions they replace.
+ */
+
+/**
+ * Convert a row of sYCC to RGB, upsampling chroma horizontally if it is sub-sampled.
+ * Luma sample x uses chroma sample x, or (x - oddFirstX) / 2 if sub-sampled.
+ *
+ * @param y luma row
+ * @param cb blue chroma row, or nullptr if chroma is zero for the whole row
+ * @param cr red chroma row, or nullptr if chroma is zero for the whole row
+ * @param r red destination
+ * @param g green destination
+ * @param b blue destination
+ * @param w luma width
+ * @param chromaW chroma width
+ * @param subsampled true if chroma is sub-sampled horizontally
+ * @param oddFirstX true if the first luma column precedes the first chroma column
+ * @param zeroFirst true if the first luma column uses zero chroma when oddFirstX is true,
+ * otherwise it uses the first chroma sample
+ * @param prec precision
+ */
+void colourSyccToRgbRow(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+						int32_t* g, int32_t* b, uint32_t w, uint32_t chromaW, bool subsampled,
+						bool oddFirstX, bool zeroFirst, uint8_t prec);
+/**
+ * Convert a row of eYCC to RGB, in place
+ *
+ * @param cbOffset offset subtracted from blue chroma
+ * @param crOffset offset subtracted from red chroma
+ * @param upb upper bound of output
+ */
+void colourEsyccToRgbRow(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t cbOffset,
+						 int32_t crOffset, int32_t upb);
+/**
+ * Convert a row of CMYK to 8 bit RGB, in place
+ *
+ * @param scale reciprocal of maximum value, for each of the four components
+ */
+void colourCmykToRgbRow(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+						const float* scale);
+/**
+ * Scale a row of integer CIELab to planar L, a and b doubles,
+ * each plane holding w values : min + sample * range / denom
+ */
+void colourLabScaleRow(const int32_t* L, const int32_t* a, const int32_t* b, double* dest,
+					   uint32_t w, const double* min, const double* range, const double* denom);
+/**
+ * Widen a row of 16 bit samples to 32 bits
+ */
+void colourWidenRow(const uint16_t* src, int32_t* dest, uint32_t w);
+
+} // namespace grk
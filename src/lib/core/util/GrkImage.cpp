@@ -243,7 +243,7 @@ void GrkImage::copyHeader(GrkImage* dest)
 
 	if(dest->comps)
 	{
-		all_components_data_free();
+		dest->all_components_data_free();
 		delete[] dest->comps;
 		dest->comps = nullptr;
 	}
@@ -270,6 +270,8 @@ void GrkImage::copyHeader(GrkImage* dest)
 	{
 		GrkImageMeta* temp = (GrkImageMeta*)meta;
 		grk_object_ref(&temp->obj);
+		if(dest->meta)
+			grk_object_unref(&dest->meta->obj);
 		dest->meta = meta;
 	}
 	dest->decompressFormat = decompressFormat;
@@ -342,10 +344,15 @@ bool GrkImage::supportsStripCache(CodingParams* cp)
 	bool supportedFileFormat =
 		decompressFormat == GRK_FMT_TIF || (decompressFormat == GRK_FMT_PXM && !splitByComponent);
 	if(isSubsampled() || precision || upsample || needsConversionToRGB() || !supportedFileFormat ||
-	   (meta && (meta->color.palette || meta->color.icc_profile_buf)))
+	   (meta && meta->color.palette))
 	{
 		return false;
 	}
+	// an ICC profile that is stored in the output file needs no processing, and
+	// a validated (RGB or grey) profile is applied to tiles or strips in place,
+	// while they are ingested. Any other colour management needs the whole image
+	if(needsColourManagement() && color_space != GRK_CLRSPC_ICC)
+		return false;
 
 	return componentsEqual(true);
 }
@@ -949,6 +956,39 @@ GrkImage* GrkImage::duplicate(const Tile* src)
 	return destImage;
 }
 
+/**
+ * Create new image with copy of this image's data
+ *
+ * @return new GrkImage if successful
+ */
+GrkImage* GrkImage::duplicate(void)
+{
+	auto destImage = new GrkImage();
+	copyHeader(destImage);
+	for(uint16_t compno = 0; compno < numcomps; ++compno)
+	{
+		auto srcComp = comps + compno;
+		auto destComp = destImage->comps + compno;
+		if(!srcComp->data)
+			continue;
+		if(!allocData(destComp))
+		{
+			grk_object_unref(&destImage->obj);
+			return nullptr;
+		}
+		auto src = srcComp->data;
+		auto dest = destComp->data;
+		for(uint32_t j = 0; j < srcComp->h; ++j)
+		{
+			memcpy(dest, src, srcComp->w * sizeof(int32_t));
+			src += srcComp->stride;
+			dest += destComp->stride;
+		}
+	}
+
+	return destImage;
+}
+
 void GrkImage::transferDataFrom(const Tile* tile_src_data)
 {
 	for(uint16_t compno = 0; compno < numcomps; compno++)
@@ -1080,7 +1120,8 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 	auto destx0 =
 		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, destWin.x0, prec);
 	auto destIndex = (uint64_t)destWin.y0 * destStride + (uint64_t)destx0;
-	auto iter = InterleaverFactory<int32_t>::makeInterleaver(prec == 16 ? packer16BitBE : prec);
+	auto iter = InterleaverFactory<int32_t>::makeInterleaver(
+		prec == 16 && decompressFormat != GRK_FMT_TIF ? packer16BitBE : prec);
 	if(!iter)
 		return false;
 	int32_t const* planes[grk::maxNumPackComponents];
@@ -8,6 +8,7 @@ namespace grk
 struct Tile;
 struct CodingParams;
 struct TileComponent;
+class ICCTransform;
 
 const uint32_t singleTileRowsPerStrip = 32;
 
@@ -73,6 +74,7 @@ class GrkImage : public grk_image
 	void transferDataTo(GrkImage* dest);
 	void transferDataFrom(const Tile* tile_src_data);
 	GrkImage* duplicate(const Tile* tile_src);
+	GrkImage* duplicate(void);
 	bool composite(const GrkImage* src);
 	bool compositeInterleaved(const GrkImage* src);
 	bool compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t yEnd);
@@ -81,6 +83,15 @@ class GrkImage : public grk_image
 	bool applyColourManagement(void);
 	bool applyICC(void);
 	bool validateICC(void);
+	/**
+	 * Hand over the ICC transform to a caller that applies it to tiles or strips
+	 * as they are decompressed. The image then no longer carries the profile,
+	 * exactly as if applyICC() had been called.
+	 *
+	 * @return transform, or nullptr if colour management does not apply the profile
+	 * or the transform could not be created
+	 */
+	std::shared_ptr<ICCTransform> detachICCTransform(void);
 	void convertPrecision(void);
 	bool execUpsample(void);
 	void all_components_data_free(void);
@@ -106,6 +117,9 @@ class GrkImage : public grk_image
 	std::string getICCColourSpaceString(cmsColorSpaceSignature color_space);
 	bool isValidICCColourSpace(uint32_t signature);
 	bool needsConversionToRGB(void);
+	bool needsColourManagement(void);
+	std::shared_ptr<ICCTransform> getICCTransform(GRK_COLOR_SPACE* transformedSpace);
+	void releaseICC(GRK_COLOR_SPACE transformedSpace);
 	bool isOpacity(uint16_t compno);
 	bool compositePlanar(const GrkImage* srcImg);
 	bool generateCompositeBounds(const grk_image_comp* srcComp, uint16_t destCompno,
@@ -113,8 +127,6 @@ class GrkImage : public grk_image
 	bool generateCompositeBounds(grk_rect32 src, uint16_t destCompno, grk_rect32* destWin);
 	bool allComponentsSanityCheck(bool equalPrecision);
 	grk_image* createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_t prec);
-	void sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr, int32_t* out_r,
-					 int32_t* out_g, int32_t* out_b);
 	bool sycc444_to_rgb(void);
 	bool sycc422_to_rgb(bool oddFirstX);
 	bool sycc420_to_rgb(bool oddFirstX, bool oddFirstY);
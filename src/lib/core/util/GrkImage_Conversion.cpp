@@ -1,5 +1,7 @@
 #include <grk_includes.h>
 #include "lcms2.h"
+#include "ColourConversion.h"
+#include "ICCTransformCache.h"
 
 namespace grk
 {
@@ -487,82 +489,36 @@ grk_image* GrkImage::createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_
  B   |0.999823  1.77204       -8.04142e-06 |    Cr - 2^(prec - 1)
 
  -----------------------------------------------------------*/
-void GrkImage::sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr,
-						   int32_t* out_r, int32_t* out_g, int32_t* out_b)
-{
-	int32_t r, g, b;
-
-	cb -= offset;
-	cr -= offset;
-	r = y + (int32_t)(1.402 * cr);
-	if(r < 0)
-		r = 0;
-	else if(r > upb)
-		r = upb;
-	*out_r = r;
-
-	g = y - (int32_t)(0.344 * cb + 0.714 * cr);
-	if(g < 0)
-		g = 0;
-	else if(g > upb)
-		g = upb;
-	*out_g = g;
-
-	b = y + (int32_t)(1.772 * cb);
-	if(b < 0)
-		b = 0;
-	else if(b > upb)
-		b = upb;
-	*out_b = b;
-}
-
 bool GrkImage::sycc444_to_rgb(void)
 {
-	int32_t *d0, *d1, *d2, *r, *g, *b;
 	auto dst = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
 	if(!dst)
 		return false;
 
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
 	uint32_t w = comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
 	uint32_t h = comps[0].h;
+	uint8_t prec = comps[0].prec;
+	auto src = comps;
+	auto dest = dst->comps;
+	colourStrips(h, [src, dest, w, prec](uint32_t rowBegin, uint32_t rowEnd) {
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
+			colourSyccToRgbRow(src[0].data + (size_t)j * src[0].stride,
+							   src[1].data + (size_t)j * src[1].stride,
+							   src[2].data + (size_t)j * src[2].stride,
+							   dest[0].data + (size_t)j * dest[0].stride,
+							   dest[1].data + (size_t)j * dest[1].stride,
+							   dest[2].data + (size_t)j * dest[2].stride, w, w, false, false, false,
+							   prec);
+	});
 
-	auto y = comps[0].data;
-	auto cb = comps[1].data;
-	auto cr = comps[2].data;
-
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
-
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
-
-	for(uint32_t j = 0; j < h; ++j)
+	all_components_data_free();
+	for(uint32_t i = 0; i < 3; ++i)
 	{
-		for(uint32_t i = 0; i < w; ++i)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-		y += src_stride_diff;
-		cb += src_stride_diff;
-		cr += src_stride_diff;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
+		comps[i].data = dst->comps[i].data;
+		comps[i].stride = dst->comps[i].stride;
+		dst->comps[i].data = nullptr;
 	}
-
-	all_components_data_free();
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
 	color_space = GRK_CLRSPC_SRGB;
-
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
 	grk_object_unref(&dst->obj);
 
 	return true;
@@ -582,77 +538,47 @@ bool GrkImage::sycc422_to_rgb(bool oddFirstX)
 		Logger::logger_.warn("incorrect subsampled width %u", comps[1].w);
 		return false;
 	}
-
-	auto dst = createRGB(3, w, h, comps[0].prec);
-	if(!dst)
-		return false;
-
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t src_stride_diff_chroma = comps[1].stride - comps[1].w;
-
-	int32_t *d0, *d1, *d2, *r, *g, *b;
-
-	auto y = comps[0].data;
-	if(!y)
+	if(!comps[0].data)
 	{
 		Logger::logger_.warn("sycc422_to_rgb: null luma channel");
 		return false;
 	}
-	auto cb = comps[1].data;
-	auto cr = comps[2].data;
-	if(!cb || !cr)
+	if(!comps[1].data || !comps[2].data)
 	{
 		Logger::logger_.warn("sycc422_to_rgb: null chroma channel");
 		return false;
 	}
 
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
+	auto dst = createRGB(3, w, h, comps[0].prec);
+	if(!dst)
+		return false;
 
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
+	uint8_t prec = comps[0].prec;
+	auto src = comps;
+	auto dest = dst->comps;
+	colourStrips(h, [src, dest, w, prec, oddFirstX](uint32_t rowBegin, uint32_t rowEnd) {
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
+			colourSyccToRgbRow(src[0].data + (size_t)j * src[0].stride,
+							   src[1].data + (size_t)j * src[1].stride,
+							   src[2].data + (size_t)j * src[2].stride,
+							   dest[0].data + (size_t)j * dest[0].stride,
+							   dest[1].data + (size_t)j * dest[1].stride,
+							   dest[2].data + (size_t)j * dest[2].stride, w, src[1].w, true,
+							   oddFirstX, true, prec);
+	});
 
-	for(uint32_t i = 0U; i < h; ++i)
+	all_components_data_free();
+	for(uint32_t i = 0; i < 3; ++i)
 	{
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *y++, 0, 0, r++, g++, b++);
-
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *y++, *cb, *cr, r++, g++, b++);
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-
-		y += src_stride_diff;
-		cb += src_stride_diff_chroma;
-		cr += src_stride_diff_chroma;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
+		comps[i].data = dst->comps[i].data;
+		comps[i].stride = dst->comps[i].stride;
+		dst->comps[i].data = nullptr;
 	}
-	all_components_data_free();
-
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
-
 	comps[1].w = comps[2].w = w;
 	comps[1].h = comps[2].h = h;
 	comps[1].dx = comps[2].dx = comps[0].dx;
 	comps[1].dy = comps[2].dy = comps[0].dy;
 	color_space = GRK_CLRSPC_SRGB;
-
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
 	grk_object_unref(&dst->obj);
 
 	return true;
@@ -689,103 +615,41 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 	if(!dst)
 		return false;
 
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
-	int32_t* src[3];
-	int32_t* dest[3];
-	int32_t* dest_ptr[3];
-	uint32_t stride_src[3];
-	uint32_t stride_src_diff[3];
-
-	uint32_t stride_dest = dst->comps[0].stride;
-	uint32_t stride_dest_diff = dst->comps[0].stride - w;
-
-	for(uint32_t i = 0; i < 3; ++i)
-	{
-		auto srcComp = comps + i;
-		src[i] = srcComp->data;
-		stride_src[i] = srcComp->stride;
-		stride_src_diff[i] = srcComp->stride - srcComp->w;
-
-		dest[i] = dest_ptr[i] = dst->comps[i].data;
-		dst->comps[i].data = nullptr;
-	}
-	// if img->y0 is odd, then first line shall use Cb/Cr = 0
-	if(oddFirstY)
-	{
-		for(size_t j = 0U; j < w; ++j)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		src[0] += stride_src_diff[0];
-		for(uint32_t i = 0; i < 3; ++i)
-			dest_ptr[i] += stride_dest_diff;
-	}
-
-	size_t i;
-	for(i = 0U; i < (loopHeight & ~(size_t)1U); i += 2U)
-	{
-		auto nextY = src[0] + stride_src[0];
-		auto nextRed = dest_ptr[0] + stride_dest;
-		auto nextGreen = dest_ptr[1] + stride_dest;
-		auto nextBlue = dest_ptr[2] + stride_dest;
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		if(j < loopWidth)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		for(uint32_t k = 0; k < 3; ++k)
-		{
-			dest_ptr[k] += stride_dest_diff + stride_dest;
-			src[k] += stride_src_diff[k];
-		}
-		src[0] += stride_src[0];
-	}
-	// final odd row has no sub-sampling
-	if(i < loopHeight)
-	{
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
+	// Chroma is upsampled in the same pass as the conversion : luma row j uses chroma
+	// row (j - oddFirstY) / 2. In the second luma row of each pair, the first column
+	// uses the first chroma sample even if oddFirstX is true
+	uint8_t prec = comps[0].prec;
+	auto src = comps;
+	auto dest = dst->comps;
+	colourStrips(h, [src, dest, w, prec, oddFirstX, oddFirstY](uint32_t rowBegin,
+															   uint32_t rowEnd) {
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
 		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1]++, *src[2]++, dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
+			const int32_t* cb = nullptr;
+			const int32_t* cr = nullptr;
+			bool zeroFirst = true;
+			// if img->y0 is odd, then first line shall use Cb/Cr = 0
+			if(!oddFirstY || j > 0)
+			{
+				uint32_t q = j - (oddFirstY ? 1 : 0);
+				cb = src[1].data + (size_t)(q >> 1) * src[1].stride;
+				cr = src[2].data + (size_t)(q >> 1) * src[2].stride;
+				zeroFirst = !(q & 1);
+			}
+			colourSyccToRgbRow(src[0].data + (size_t)j * src[0].stride, cb, cr,
+							   dest[0].data + (size_t)j * dest[0].stride,
+							   dest[1].data + (size_t)j * dest[1].stride,
+							   dest[2].data + (size_t)j * dest[2].stride, w, src[1].w, true,
+							   oddFirstX, zeroFirst, prec);
 		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *src[0], *src[1], *src[2], dest_ptr[0], dest_ptr[1],
-						dest_ptr[2]);
-	}
+	});
 
 	all_components_data_free();
 	for(uint32_t k = 0; k < 3; ++k)
 	{
-		comps[k].data = dest[k];
+		comps[k].data = dst->comps[k].data;
 		comps[k].stride = dst->comps[k].stride;
+		dst->comps[k].data = nullptr;
 	}
 	comps[1].w = comps[2].w = comps[0].w;
 	comps[1].h = comps[2].h = comps[0].h;
@@ -848,37 +712,19 @@ bool GrkImage::color_cmyk_to_rgb(void)
 	if((numcomps < 4) || !allComponentsSanityCheck(true))
 		return false;
 
-	float sC = 1.0F / (float)((1 << comps[0].prec) - 1);
-	float sM = 1.0F / (float)((1 << comps[1].prec) - 1);
-	float sY = 1.0F / (float)((1 << comps[2].prec) - 1);
-	float sK = 1.0F / (float)((1 << comps[3].prec) - 1);
+	float scale[4];
+	for(uint32_t i = 0; i < 4; ++i)
+		scale[i] = 1.0F / (float)((1 << comps[i].prec) - 1);
 
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
+	auto src = comps;
+	colourStrips(h, [src, w, &scale](uint32_t rowBegin, uint32_t rowEnd) {
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
 		{
-			/* CMYK values from 0 to 1 */
-			float C = (float)(comps[0].data[dest_index]) * sC;
-			float M = (float)(comps[1].data[dest_index]) * sM;
-			float Y = (float)(comps[2].data[dest_index]) * sY;
-			float K = (float)(comps[3].data[dest_index]) * sK;
-
-			/* Invert all CMYK values */
-			C = 1.0F - C;
-			M = 1.0F - M;
-			Y = 1.0F - Y;
-			K = 1.0F - K;
-
-			/* CMYK -> RGB : RGB results from 0 to 255 */
-			comps[0].data[dest_index] = (int32_t)(255.0F * C * K); /* R */
-			comps[1].data[dest_index] = (int32_t)(255.0F * M * K); /* G */
-			comps[2].data[dest_index] = (int32_t)(255.0F * Y * K); /* B */
-			dest_index++;
+			size_t index = (size_t)j * src[0].stride;
+			colourCmykToRgbRow(src[0].data + index, src[1].data + index, src[2].data + index,
+							   src[3].data + index, w, scale);
 		}
-		dest_index += stride_diff;
-	}
+	});
 
 	single_component_data_free(comps + 3);
 	comps[0].prec = 8;
@@ -906,51 +752,18 @@ bool GrkImage::color_esycc_to_rgb(void)
 	uint32_t w = comps[0].w;
 	uint32_t h = comps[0].h;
 
-	bool sign1 = comps[1].sgnd;
-	bool sign2 = comps[2].sgnd;
+	int32_t cbOffset = comps[1].sgnd ? 0 : flip_value;
+	int32_t crOffset = comps[2].sgnd ? 0 : flip_value;
 
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
+	auto src = comps;
+	colourStrips(h, [src, w, cbOffset, crOffset, max_value](uint32_t rowBegin, uint32_t rowEnd) {
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
 		{
-			int32_t y = comps[0].data[dest_index];
-			int32_t cb = comps[1].data[dest_index];
-			int32_t cr = comps[2].data[dest_index];
-
-			if(!sign1)
-				cb -= flip_value;
-			if(!sign2)
-				cr -= flip_value;
-
-			int32_t val = (int32_t)(y - 0.0000368 * cb + 1.40199 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[0].data[dest_index] = val;
-
-			val = (int32_t)(1.0003 * y - 0.344125 * cb - 0.7141128 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[1].data[dest_index] = val;
-
-			val = (int32_t)(0.999823 * y + 1.77204 * cb - 0.000008 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[2].data[dest_index] = val;
-			dest_index++;
+			size_t index = (size_t)j * src[0].stride;
+			colourEsyccToRgbRow(src[0].data + index, src[1].data + index, src[2].data + index, w,
+								cbOffset, crOffset, max_value);
 		}
-		dest_index += stride_diff;
-	}
+	});
 	color_space = GRK_CLRSPC_SRGB;
 
 	return true;
@@ -1145,13 +958,10 @@ bool GrkImage::validateICC(void)
 	return imagePropertiesMatchICCColourSpace;
 }
 
-/**
- * Convert to sRGB
- */
-bool GrkImage::applyColourManagement(void)
+bool GrkImage::needsColourManagement(void)
 {
 	if(!meta || !meta->color.icc_profile_buf)
-		return true;
+		return false;
 
 	bool isTiff = decompressFormat == GRK_FMT_TIF;
 	bool canStoreCIE = isTiff && color_space == GRK_CLRSPC_DEFAULT_CIE;
@@ -1163,12 +973,19 @@ bool GrkImage::applyColourManagement(void)
 	bool canStoreICC = (decompressFormat == GRK_FMT_TIF || decompressFormat == GRK_FMT_PNG ||
 						decompressFormat == GRK_FMT_JPG || decompressFormat == GRK_FMT_BMP);
 
-	bool shouldApplyColourManagement =
-		forceRGB || (decompressFormat != GRK_FMT_UNK && meta && meta->color.icc_profile_buf &&
-					 ((isCIE && !canStoreCIE) || !canStoreICC));
-	if(!shouldApplyColourManagement)
+	return forceRGB ||
+		   (decompressFormat != GRK_FMT_UNK && ((isCIE && !canStoreCIE) || !canStoreICC));
+}
+
+/**
+ * Convert to sRGB
+ */
+bool GrkImage::applyColourManagement(void)
+{
+	if(!needsColourManagement())
 		return true;
 
+	bool isCIE = color_space == GRK_CLRSPC_DEFAULT_CIE || color_space == GRK_CLRSPC_CUSTOM_CIE;
 	if(isCIE)
 	{
 		if(!forceRGB)
@@ -1208,45 +1025,25 @@ bool GrkImage::applyColourManagement(void)
 	return true;
 }
 
-/*#define DEBUG_PROFILE*/
-bool GrkImage::applyICC(void)
+/**
+ * Get the cached transform from the ICC profile to sRGB
+ *
+ * @param transformedSpace colour space of the image after the transform
+ *
+ * @return transform, or nullptr if the profile is not supported
+ */
+std::shared_ptr<ICCTransform> GrkImage::getICCTransform(GRK_COLOR_SPACE* transformedSpace)
 {
-	cmsUInt32Number out_space;
-	cmsUInt32Number intent = 0;
-	cmsHTRANSFORM transform = nullptr;
-	cmsHPROFILE in_prof = nullptr;
-	cmsHPROFILE out_prof = nullptr;
-	cmsUInt32Number in_type, out_type;
-	size_t nr_samples, componentSize;
-	uint32_t prec, w, stride_diff, h;
-	GRK_COLOR_SPACE oldspace;
-	bool rc = false;
-
-	if(!validateICC())
-		return false;
-
-	if(numcomps == 0 || !allComponentsSanityCheck(true))
-		return false;
-	if(!meta || !meta->color.icc_profile_buf || !meta->color.icc_profile_len)
-		return false;
-	in_prof = cmsOpenProfileFromMem(meta->color.icc_profile_buf, meta->color.icc_profile_len);
+	auto in_prof = cmsOpenProfileFromMem(meta->color.icc_profile_buf, meta->color.icc_profile_len);
 	if(!in_prof)
-		goto cleanup;
-
+		return nullptr;
 	// auto in_space = cmsGetPCS(in_prof);
-	out_space = cmsGetColorSpace(in_prof);
-	intent = cmsGetHeaderRenderingIntent(in_prof);
-
-	w = comps[0].w;
-	stride_diff = comps[0].stride - w;
-	h = comps[0].h;
-	if(!w || !h)
-		goto cleanup;
-	componentSize = (size_t)w * h;
-
-	prec = comps[0].prec;
-	oldspace = color_space;
+	auto out_space = cmsGetColorSpace(in_prof);
+	auto intent = cmsGetHeaderRenderingIntent(in_prof);
+	cmsCloseProfile(in_prof);
 
+	// samples are transformed a planar row at a time
+	cmsUInt32Number in_type, out_type;
 	if(out_space == cmsSigRgbData)
 	{ /* enumCS 16 */
 		uint32_t i, nr_comp = numcomps;
@@ -1265,154 +1062,129 @@ bool GrkImage::applyICC(void)
 				break;
 		}
 		if(i != nr_comp)
-			goto cleanup;
+			return nullptr;
 
-		if(prec <= 8)
+		if(comps[0].prec <= 8)
 		{
-			in_type = TYPE_RGB_8;
-			out_type = TYPE_RGB_8;
+			in_type = TYPE_RGB_8_PLANAR;
+			out_type = TYPE_RGB_8_PLANAR;
 		}
 		else
 		{
-			in_type = TYPE_RGB_16;
-			out_type = TYPE_RGB_16;
+			in_type = TYPE_RGB_16_PLANAR;
+			out_type = TYPE_RGB_16_PLANAR;
 		}
-		out_prof = cmsCreate_sRGBProfile();
-		color_space = GRK_CLRSPC_SRGB;
+		*transformedSpace = GRK_CLRSPC_SRGB;
 	}
 	else if(out_space == cmsSigGrayData)
 	{ /* enumCS 17 */
 		in_type = TYPE_GRAY_8;
-		out_type = TYPE_RGB_8;
-		out_prof = cmsCreate_sRGBProfile();
-		if(forceRGB)
-			color_space = GRK_CLRSPC_SRGB;
-		else
-			color_space = GRK_CLRSPC_GRAY;
+		out_type = TYPE_RGB_8_PLANAR;
+		*transformedSpace = forceRGB ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
 	}
 	else if(out_space == cmsSigYCbCrData)
 	{ /* enumCS 18 */
-		in_type = TYPE_YCbCr_16;
-		out_type = TYPE_RGB_16;
-		out_prof = cmsCreate_sRGBProfile();
-		color_space = GRK_CLRSPC_SRGB;
+		in_type = TYPE_YCbCr_16_PLANAR;
+		out_type = TYPE_RGB_16_PLANAR;
+		*transformedSpace = GRK_CLRSPC_SRGB;
 	}
 	else
 	{
 		Logger::logger_.warn("Apply ICC profile has unknown "
 							 "output color space (%#x)\nICC profile ignored.",
 							 out_space);
-		goto cleanup;
+		return nullptr;
 	}
-	transform = cmsCreateTransform(in_prof, in_type, out_prof, out_type, intent, 0);
+	auto profile = meta->color.icc_profile_buf;
+	auto profileLen = meta->color.icc_profile_len;
+
+	return ICCTransformCache::instance()->get(
+		profile, profileLen, in_type, out_type, intent, [=]() -> cmsHTRANSFORM {
+			auto in = cmsOpenProfileFromMem(profile, profileLen);
+			if(!in)
+				return nullptr;
+			auto out = cmsCreate_sRGBProfile();
+			auto transform = cmsCreateTransform(in, in_type, out, out_type, intent, 0);
+			cmsCloseProfile(in);
+			cmsCloseProfile(out);
+
+			return transform;
+		});
+}
+
+/**
+ * Release ICC profile once it has been applied
+ *
+ * @param transformedSpace colour space of the transformed image
+ */
+void GrkImage::releaseICC(GRK_COLOR_SPACE transformedSpace)
+{
+	color_space = transformedSpace;
+	delete[] meta->color.icc_profile_buf;
+	meta->color.icc_profile_buf = nullptr;
+	meta->color.icc_profile_len = 0;
+}
+
+std::shared_ptr<ICCTransform> GrkImage::detachICCTransform(void)
+{
+	if(!needsColourManagement() || !validateICC())
+		return nullptr;
+	GRK_COLOR_SPACE transformedSpace;
+	auto transform = getICCTransform(&transformedSpace);
 	if(!transform)
 	{
-		color_space = oldspace;
-		goto cleanup;
+		Logger::logger_.warn("Unable to apply ICC profile");
+		return nullptr;
 	}
+	releaseICC(transformedSpace);
 
-	if(numcomps > 2)
-	{ /* RGB, RGBA */
-		if(prec <= 8)
-		{
-			nr_samples = componentSize * 3U;
-			auto inbuf = new uint8_t[nr_samples];
-			auto outbuf = new uint8_t[nr_samples];
-
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
+	return transform;
+}
 
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint8_t)r[src_index];
-					inbuf[dest_index++] = (uint8_t)g[src_index];
-					inbuf[dest_index++] = (uint8_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
+/*#define DEBUG_PROFILE*/
+bool GrkImage::applyICC(void)
+{
+	if(!validateICC())
+		return false;
 
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
+	if(numcomps == 0 || !allComponentsSanityCheck(true))
+		return false;
+	if(!meta || !meta->color.icc_profile_buf || !meta->color.icc_profile_len)
+		return false;
 
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
-		else
-		{
-			nr_samples = componentSize * 3U * sizeof(uint16_t);
-			auto inbuf = new uint16_t[nr_samples];
-			auto outbuf = new uint16_t[nr_samples];
+	uint32_t w = comps[0].w;
+	uint32_t h = comps[0].h;
+	if(!w || !h)
+		return false;
 
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
+	GRK_COLOR_SPACE transformedSpace;
+	auto transform = getICCTransform(&transformedSpace);
+	if(!transform)
+		return false;
 
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint16_t)r[src_index];
-					inbuf[dest_index++] = (uint16_t)g[src_index];
-					inbuf[dest_index++] = (uint16_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
+	int32_t* planes[3];
+	uint16_t numPlanes;
+	if(numcomps > 2)
+	{ /* RGB, RGBA */
+		planes[0] = comps[0].data;
+		planes[1] = comps[1].data;
+		planes[2] = comps[2].data;
+		numPlanes = 3;
 	}
 	else
 	{ /* GRAY, GRAYA */
-		nr_samples = componentSize * 3U;
-		auto newComps = new grk_image_comp[numcomps + 2U];
-		for(uint32_t i = 0; i < numcomps + 2U; ++i)
-		{
-			if(i < numcomps)
-				newComps[i] = comps[i];
-			else
-				memset(newComps + i, 0, sizeof(grk_image_comp));
-		}
-		delete[] comps;
-		comps = newComps;
-		auto inbuf = new uint8_t[nr_samples];
-		auto outbuf = new uint8_t[nr_samples];
 		if(forceRGB)
 		{
+			auto newComps = new grk_image_comp[numcomps + 2U];
+			for(uint32_t i = 0; i < numcomps + 2U; ++i)
+			{
+				if(i < numcomps)
+					newComps[i] = comps[i];
+				else
+					memset(newComps + i, 0, sizeof(grk_image_comp));
+			}
+			delete[] comps;
+			comps = newComps;
 			if(numcomps == 2)
 				comps[3] = comps[1];
 			comps[1] = comps[0];
@@ -1422,59 +1194,24 @@ bool GrkImage::applyICC(void)
 			comps[2].data = nullptr;
 			allocData(comps + 2);
 			numcomps = (uint16_t)(2 + numcomps);
+			planes[1] = comps[1].data;
+			planes[2] = comps[2].data;
+			numPlanes = 3;
 		}
-		auto r = comps[0].data;
-		size_t src_index = 0;
-		size_t dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
-		{
-			for(uint32_t i = 0; i < w; ++i)
-				inbuf[dest_index++] = (uint8_t)r[src_index++];
-			src_index += stride_diff;
-		}
-		cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-		int32_t *g = nullptr, *b = nullptr;
-		if(forceRGB)
-		{
-			g = comps[1].data;
-			b = comps[2].data;
-		}
-		src_index = 0;
-		dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
+		else
 		{
-			for(uint32_t i = 0; i < w; ++i)
-			{
-				r[dest_index] = (int32_t)outbuf[src_index++];
-				if(forceRGB)
-				{
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-				}
-				else
-				{
-					src_index += 2;
-				}
-				dest_index++;
-			}
-			dest_index += stride_diff;
+			numPlanes = 1;
 		}
-		delete[] inbuf;
-		delete[] outbuf;
-	} /* if(image->numcomps */
-	rc = true;
-	delete[] meta->color.icc_profile_buf;
-	meta->color.icc_profile_buf = nullptr;
-	meta->color.icc_profile_len = 0;
-cleanup:
-	if(in_prof)
-		cmsCloseProfile(in_prof);
-	if(out_prof)
-		cmsCloseProfile(out_prof);
-	if(transform)
-		cmsDeleteTransform(transform);
+		planes[0] = comps[0].data;
+	}
+	// pixels are independent, so strips of rows are transformed concurrently
+	uint32_t stride = comps[0].stride;
+	colourStrips(h, [&planes, numPlanes, stride, w, &transform](uint32_t rowBegin, uint32_t rowEnd) {
+		transform->transformRows(planes, numPlanes, stride, w, rowBegin, rowEnd);
+	});
+	releaseICC(transformedSpace);
 
-	return rc;
+	return true;
 } /* applyICC() */
 
 // transform LAB colour space to sRGB @ 16 bit precision
@@ -1527,11 +1264,9 @@ bool GrkImage::cieLabToRGB(void)
 	bool defaultType = true;
 	color_space = GRK_CLRSPC_SRGB;
 	defaultType = row[1] == GRK_DEFAULT_CIELAB_SPACE;
-	int32_t *L, *a, *b, *red, *green, *blue;
 	// range, offset and precision for L,a and b coordinates
 	double r_L, o_L, r_a, o_a, r_b, o_b, prec_L, prec_a, prec_b;
 	double minL, maxL, mina, maxa, minb, maxb;
-	cmsUInt16Number RGB[3];
 	prec_L = (double)comps[0].prec;
 	prec_a = (double)comps[1].prec;
 	prec_b = (double)comps[2].prec;
@@ -1590,22 +1325,27 @@ bool GrkImage::cieLabToRGB(void)
 			break;
 	}
 
-	// Lab input profile
-	auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
-	// sRGB output profile
-	auto out = cmsCreate_sRGBProfile();
-	auto transform = cmsCreateTransform(in, TYPE_Lab_DBL, out, TYPE_RGB_16, INTENT_PERCEPTUAL, 0);
-
-	cmsCloseProfile(in);
-	cmsCloseProfile(out);
-	if(transform == nullptr)
+	// transforms are cached by illuminant
+	auto transform = ICCTransformCache::instance()->get(
+		(const uint8_t*)&illuminant, sizeof(illuminant), TYPE_Lab_DBL | PLANAR_SH(1),
+		TYPE_RGB_16_PLANAR, INTENT_PERCEPTUAL, [illuminant, &WhitePoint]() {
+			// Lab input profile
+			auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
+			// sRGB output profile
+			auto out = cmsCreate_sRGBProfile();
+			// rows are transformed concurrently, so the transform's pixel cache is disabled
+			auto transform = cmsCreateTransform(in, TYPE_Lab_DBL | PLANAR_SH(1), out,
+												TYPE_RGB_16_PLANAR, INTENT_PERCEPTUAL,
+												cmsFLAGS_NOCACHE);
+			cmsCloseProfile(in);
+			cmsCloseProfile(out);
+
+			return transform;
+		});
+	if(!transform)
 		return false;
 
-	L = comps[0].data;
-	a = comps[1].data;
-	b = comps[2].data;
-
-	if(!L || !a || !b)
+	if(!comps[0].data || !comps[1].data || !comps[2].data)
 	{
 		Logger::logger_.warn("color_cielab_to_rgb: null L*a*b component");
 		return false;
@@ -1615,13 +1355,6 @@ bool GrkImage::cieLabToRGB(void)
 	if(!dest_img)
 		return false;
 
-	red = dest_img->comps[0].data;
-	green = dest_img->comps[1].data;
-	blue = dest_img->comps[2].data;
-
-	uint32_t src_stride_diff = comps[0].stride - comps[0].w;
-	uint32_t dest_stride_diff = dest_img->comps[0].stride - dest_img->comps[0].w;
-
 	minL = -(r_L * o_L) / (pow(2, prec_L) - 1);
 	maxL = minL + r_L;
 
@@ -1631,32 +1364,31 @@ bool GrkImage::cieLabToRGB(void)
 	minb = -(r_b * o_b) / (pow(2, prec_b) - 1);
 	maxb = minb + r_b;
 
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < comps[0].h; ++j)
-	{
-		for(uint32_t k = 0; k < comps[0].w; ++k)
+	const double min[3] = {minL, mina, minb};
+	const double range[3] = {maxL - minL, maxa - mina, maxb - minb};
+	const double denom[3] = {pow(2, prec_L) - 1, pow(2, prec_a) - 1, pow(2, prec_b) - 1};
+
+	// each row is scaled to planar L*a*b doubles, transformed in one call,
+	// and widened to the destination planes
+	uint32_t w = comps[0].w;
+	auto src = comps;
+	auto dest = dest_img->comps;
+	auto handle = transform->handle();
+	colourStrips(comps[0].h, [src, dest, w, handle, &min, &range, &denom](uint32_t rowBegin,
+																		 uint32_t rowEnd) {
+		std::vector<double> Lab((size_t)w * 3);
+		std::vector<uint16_t> RGB((size_t)w * 3);
+		for(uint32_t j = rowBegin; j < rowEnd; ++j)
 		{
-			cmsCIELab Lab;
-			Lab.L = minL + (double)(*L) * (maxL - minL) / (pow(2, prec_L) - 1);
-			++L;
-			Lab.a = mina + (double)(*a) * (maxa - mina) / (pow(2, prec_a) - 1);
-			++a;
-			Lab.b = minb + (double)(*b) * (maxb - minb) / (pow(2, prec_b) - 1);
-			++b;
-
-			cmsDoTransform(transform, &Lab, RGB, 1);
-
-			red[dest_index] = RGB[0];
-			green[dest_index] = RGB[1];
-			blue[dest_index] = RGB[2];
-			dest_index++;
+			size_t srcIndex = (size_t)j * src[0].stride;
+			colourLabScaleRow(src[0].data + srcIndex, src[1].data + srcIndex,
+							  src[2].data + srcIndex, Lab.data(), w, min, range, denom);
+			cmsDoTransform(handle, Lab.data(), RGB.data(), w);
+			for(uint32_t k = 0; k < 3; ++k)
+				colourWidenRow(RGB.data() + (size_t)k * w, dest[k].data + (size_t)j * dest[k].stride,
+							   w);
 		}
-		dest_index += dest_stride_diff;
-		L += src_stride_diff;
-		a += src_stride_diff;
-		b += src_stride_diff;
-	}
-	cmsDeleteTransform(transform);
+	});
 
 	for(i = 0; i < numcomps; ++i)
 		single_component_data_free(comps + i);
@@ -0,0 +1,156 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+#include "ICCTransformCache.h"
+
+namespace grk
+{
+ICCTransform::ICCTransform(cmsHTRANSFORM transform, cmsUInt32Number inType,
+						   cmsUInt32Number outType)
+	: transform_(transform), inChannels_(T_CHANNELS(inType) + T_EXTRA(inType)),
+	  inBytes_(T_BYTES(inType)), outChannels_(T_CHANNELS(outType) + T_EXTRA(outType)),
+	  outBytes_(T_BYTES(outType))
+{
+	assert(inBytes_ == 1 || inBytes_ == 2);
+	assert(outBytes_ == 1 || outBytes_ == 2);
+}
+ICCTransform::~ICCTransform()
+{
+	cmsDeleteTransform(transform_);
+}
+cmsHTRANSFORM ICCTransform::handle(void) const
+{
+	return transform_;
+}
+uint32_t ICCTransform::numInputChannels(void) const
+{
+	return inChannels_;
+}
+template<typename T>
+static void narrowRow(const int32_t* src, uint8_t* dest, uint32_t w)
+{
+	auto d = (T*)dest;
+	for(uint32_t i = 0; i < w; ++i)
+		d[i] = (T)src[i];
+}
+template<typename T>
+static void widenRow(const uint8_t* src, int32_t* dest, uint32_t w)
+{
+	auto s = (const T*)src;
+	for(uint32_t i = 0; i < w; ++i)
+		dest[i] = (int32_t)s[i];
+}
+void ICCTransform::transformRows(int32_t* const* planes, uint16_t numPlanes, uint32_t stride,
+								 uint32_t w, uint32_t rowBegin, uint32_t rowEnd) const
+{
+	// planar single row buffers : a channel's samples are w samples apart
+	size_t inPlaneBytes = (size_t)w * inBytes_;
+	size_t outPlaneBytes = (size_t)w * outBytes_;
+	std::vector<uint8_t> in(inPlaneBytes * inChannels_);
+	std::vector<uint8_t> out(outPlaneBytes * outChannels_);
+	uint32_t numOut = std::min<uint32_t>(numPlanes, outChannels_);
+	for(uint32_t j = rowBegin; j < rowEnd; ++j)
+	{
+		size_t offset = (size_t)j * stride;
+		for(uint32_t k = 0; k < inChannels_; ++k)
+		{
+			if(inBytes_ == 1)
+				narrowRow<uint8_t>(planes[k] + offset, in.data() + k * inPlaneBytes, w);
+			else
+				narrowRow<uint16_t>(planes[k] + offset, in.data() + k * inPlaneBytes, w);
+		}
+		cmsDoTransform(transform_, in.data(), out.data(), w);
+		for(uint32_t k = 0; k < numOut; ++k)
+		{
+			if(outBytes_ == 1)
+				widenRow<uint8_t>(out.data() + k * outPlaneBytes, planes[k] + offset, w);
+			else
+				widenRow<uint16_t>(out.data() + k * outPlaneBytes, planes[k] + offset, w);
+		}
+	}
+}
+
+ICCTransformCache* ICCTransformCache::instance(void)
+{
+	static ICCTransformCache singleton;
+
+	return &singleton;
+}
+static uint64_t hashProfile(const uint8_t* profile, uint32_t profileLen)
+{
+	// FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(uint32_t i = 0; i < profileLen; ++i)
+	{
+		hash ^= profile[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+std::shared_ptr<ICCTransform> ICCTransformCache::find(uint64_t hash, const uint8_t* profile,
+													  uint32_t profileLen, cmsUInt32Number inType,
+													  cmsUInt32Number outType,
+													  cmsUInt32Number intent)
+{
+	for(auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+	{
+		if(iter->hash == hash && iter->inType == inType && iter->outType == outType &&
+		   iter->intent == intent && iter->profile.size() == profileLen &&
+		   !memcmp(iter->profile.data(), profile, profileLen))
+		{
+			entries_.splice(entries_.begin(), entries_, iter);
+			return entries_.front().transform;
+		}
+	}
+
+	return nullptr;
+}
+std::shared_ptr<ICCTransform>
+	ICCTransformCache::get(const uint8_t* profile, uint32_t profileLen, cmsUInt32Number inType,
+						   cmsUInt32Number outType, cmsUInt32Number intent,
+						   const std::function<cmsHTRANSFORM(void)>& create)
+{
+	auto hash = hashProfile(profile, profileLen);
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		auto transform = find(hash, profile, profileLen, inType, outType, intent);
+		if(transform)
+			return transform;
+	}
+	// build outside of the lock, so that a slow build does not stall
+	// decompressions with other profiles
+	auto handle = create();
+	if(!handle)
+		return nullptr;
+	auto transform = std::make_shared<ICCTransform>(handle, inType, outType);
+
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto cached = find(hash, profile, profileLen, inType, outType, intent);
+	if(cached)
+		return cached;
+	entries_.push_front(Entry{hash, std::vector<uint8_t>(profile, profile + profileLen), inType,
+							  outType, intent, transform});
+	// transforms still in use are released by their last user
+	if(entries_.size() > maxEntries_)
+		entries_.pop_back();
+
+	return transform;
+}
+
+} // namespace grk
@@ -0,0 +1,109 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "lcms2.h"
+
+namespace grk
+{
+/**
+ * lcms transform, which may be shared by any number of threads
+ * and decompressions. Pixel formats are planar.
+ */
+class ICCTransform
+{
+  public:
+	ICCTransform(cmsHTRANSFORM transform, cmsUInt32Number inType, cmsUInt32Number outType);
+	~ICCTransform();
+	cmsHTRANSFORM handle(void) const;
+	uint32_t numInputChannels(void) const;
+	/**
+	 * Transform rows of planar component samples in place.
+	 * Samples are narrowed to the transform's 8 or 16 bit input format a row at a time,
+	 * and widened back after the transform.
+	 *
+	 * @param planes component planes : the first planes are read, one for each input channel
+	 * of the transform, and the first numPlanes planes are written
+	 * @param numPlanes number of planes to write; remaining output channels are discarded
+	 * @param stride plane stride
+	 * @param w row width
+	 * @param rowBegin first row
+	 * @param rowEnd one past last row
+	 */
+	void transformRows(int32_t* const* planes, uint16_t numPlanes, uint32_t stride, uint32_t w,
+					   uint32_t rowBegin, uint32_t rowEnd) const;
+
+  private:
+	cmsHTRANSFORM transform_;
+	uint32_t inChannels_;
+	uint32_t inBytes_;
+	uint32_t outChannels_;
+	uint32_t outBytes_;
+};
+
+/**
+ * Process-wide cache of lcms transforms, keyed by profile, pixel formats and intent,
+ * so that images sharing a profile only build their transform once
+ */
+class ICCTransformCache
+{
+  public:
+	static ICCTransformCache* instance(void);
+	/**
+	 * Get a cached transform, creating it on a miss
+	 *
+	 * @param profile profile bytes, or any bytes that identify how create() builds the transform
+	 * @param profileLen number of profile bytes
+	 * @param inType input pixel format
+	 * @param outType output pixel format
+	 * @param intent rendering intent
+	 * @param create creates the transform with these formats and intent
+	 *
+	 * @return transform, or nullptr if it could not be created
+	 */
+	std::shared_ptr<ICCTransform> get(const uint8_t* profile, uint32_t profileLen,
+									  cmsUInt32Number inType, cmsUInt32Number outType,
+									  cmsUInt32Number intent,
+									  const std::function<cmsHTRANSFORM(void)>& create);
+
+  private:
+	ICCTransformCache() = default;
+	struct Entry
+	{
+		uint64_t hash;
+		std::vector<uint8_t> profile;
+		cmsUInt32Number inType;
+		cmsUInt32Number outType;
+		cmsUInt32Number intent;
+		std::shared_ptr<ICCTransform> transform;
+	};
+	std::shared_ptr<ICCTransform> find(uint64_t hash, const uint8_t* profile,
+									   uint32_t profileLen, cmsUInt32Number inType,
+									   cmsUInt32Number outType, cmsUInt32Number intent);
+	// most recently used first
+	std::list<Entry> entries_;
+	std::mutex mutex_;
+	static const size_t maxEntries_ = 16;
+};
+
+} // namespace grk
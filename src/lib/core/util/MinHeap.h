@@ -89,6 +89,18 @@ class MinHeapPtr
 		nextIndex++;
 		return val;
 	}
+	/**
+	 * Pop top element, whether or not it is next in sequence
+	 */
+	T* popAny(void)
+	{
+		L locker(queue_mutex);
+		if(queue.empty())
+			return nullptr;
+		auto val = queue.top();
+		queue.pop();
+		return val;
+	}
 	size_t size(void)
 	{
 		return queue.size();
@@ -112,6 +112,27 @@ grk_buf8* SparseBuffer::pushBack(uint8_t* buf, size_t len, bool ownsData)
 	pushBack(new_chunk);
 	return new_chunk;
 }
+void SparseBuffer::deferRead(uint8_t* dest, size_t len, uint64_t streamOffset)
+{
+	deferredReads_.push_back({dest, len, streamOffset});
+}
+bool SparseBuffer::readDeferred(BufferedStream* stream)
+{
+	bool rc = true;
+	for(auto& deferred : deferredReads_)
+	{
+		if(stream->readAt(deferred.dest, deferred.len, deferred.streamOffset) != deferred.len)
+		{
+			Logger::logger_.error("Unable to read %" PRIu64 " bytes at stream offset %" PRIu64,
+								  (uint64_t)deferred.len, deferred.streamOffset);
+			rc = false;
+			break;
+		}
+	}
+	deferredReads_.clear();
+
+	return rc;
+}
 void SparseBuffer::pushBack(grk_buf8* chunk)
 {
 	if(!chunk)
@@ -125,6 +146,7 @@ void SparseBuffer::cleanup(void)
 	for(size_t i = 0; i < chunks.size(); ++i)
 		delete chunks[i];
 	chunks.clear();
+	deferredReads_.clear();
 }
 void SparseBuffer::rewind(void)
 {
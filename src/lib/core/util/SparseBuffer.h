@@ -19,6 +19,8 @@
 #pragma once
 namespace grk
 {
+struct BufferedStream;
+
 /*  SparseBuffer
 
  Manage a list of buffers, which can be treated as one single
@@ -29,6 +31,22 @@ struct SparseBuffer
 	SparseBuffer();
 	~SparseBuffer();
 	grk_buf8* pushBack(uint8_t* buf, size_t len, bool ownsData);
+	/**
+	 * Defer reading part of a chunk's data from the stream, so that it can
+	 * later be read with a positional read, independently of the stream position
+	 *
+	 * @param dest destination in chunk
+	 * @param len number of bytes to read
+	 * @param streamOffset absolute stream offset of data
+	 */
+	void deferRead(uint8_t* dest, size_t len, uint64_t streamOffset);
+	/**
+	 * Perform all deferred reads
+	 *
+	 * @param stream stream supporting positional reads
+	 * @return true if all deferred data was read
+	 */
+	bool readDeferred(BufferedStream* stream);
 	void incrementCurrentChunkOffset(size_t offset);
 	size_t getCurrentChunkLength(void);
 	// Treat segmented buffer as single contiguous buffer, and get current pointer
@@ -53,6 +71,13 @@ struct SparseBuffer
 	size_t currentChunkId; /* current index into chunk vector */
 	std::vector<grk_buf8*> chunks;
 	bool reachedEnd_;
+	struct DeferredRead
+	{
+		uint8_t* dest;
+		size_t len;
+		uint64_t streamOffset;
+	};
+	std::vector<DeferredRead> deferredReads_;
 };
 
 } // namespace grk
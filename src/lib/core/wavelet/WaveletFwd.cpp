@@ -22,8 +22,182 @@
 #include <algorithm>
 #include <limits>
 #include <sstream>
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "wavelet/WaveletFwd.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
 namespace grk
 {
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	static size_t hwy_num_lanes(void)
+	{
+		const HWY_FULL(int32_t) di;
+		return Lanes(di);
+	}
+
+/* number of columns in vertical pass buffer : two full vectors */
+#define HWY_PLL_COLS_FWD (2 * Lanes(di))
+
+	/** Vertical forward 5x3 wavelet transform, in place, for 8 columns in SSE2,
+	 * 16 in AVX2 or 32 in AVX-512. buf holds HWY_PLL_COLS_FWD interleaved columns */
+	static void hwy_encode_v_mcols_53(int32_t* buf, const uint32_t height, const bool even)
+	{
+		const HWY_FULL(int32_t) di;
+		const size_t numCols = HWY_PLL_COLS_FWD;
+		const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
+		const uint32_t dn = height - sn;
+		const auto two = Set(di, 2);
+		assert((size_t)buf % (sizeof(int32_t) * Lanes(di)) == 0);
+
+		for(size_t k = 0; k < numCols; k += Lanes(di))
+		{
+			int32_t* GRK_RESTRICT evenPtr = buf + k;
+			int32_t* GRK_RESTRICT oddPtr = buf + numCols + k;
+#define HWY_S(i) (evenPtr + ((size_t)(i) << 1) * numCols)
+#define HWY_D(i) (oddPtr + ((size_t)(i) << 1) * numCols)
+			if(height == 1)
+			{
+				if(!even)
+				{
+					auto s0 = Load(di, HWY_S(0));
+					Store(s0 + s0, di, HWY_S(0));
+				}
+				continue;
+			}
+			uint32_t i;
+			if(even)
+			{
+				auto si = Load(di, HWY_S(0));
+				for(i = 0; i + 1 < sn; i++)
+				{
+					auto sip1 = Load(di, HWY_S(i + 1));
+					Store(Load(di, HWY_D(i)) - ShiftRight<1>(si + sip1), di, HWY_D(i));
+					si = sip1;
+				}
+				if((height & 1) == 0)
+					Store(Load(di, HWY_D(i)) - si, di, HWY_D(i));
+				auto dim1 = Load(di, HWY_D(0));
+				Store(Load(di, HWY_S(0)) + ShiftRight<2>(dim1 + dim1 + two), di, HWY_S(0));
+				for(i = 1; i < dn; i++)
+				{
+					auto di_ = Load(di, HWY_D(i));
+					Store(Load(di, HWY_S(i)) + ShiftRight<2>(dim1 + di_ + two), di, HWY_S(i));
+					dim1 = di_;
+				}
+				if((height & 1) == 1)
+					Store(Load(di, HWY_S(i)) + ShiftRight<2>(dim1 + dim1 + two), di, HWY_S(i));
+			}
+			else
+			{
+				auto dim1 = Load(di, HWY_D(0));
+				Store(Load(di, HWY_S(0)) - dim1, di, HWY_S(0));
+				for(i = 1; i < sn; i++)
+				{
+					auto di_ = Load(di, HWY_D(i));
+					Store(Load(di, HWY_S(i)) - ShiftRight<1>(di_ + dim1), di, HWY_S(i));
+					dim1 = di_;
+				}
+				if((height & 1) == 1)
+					Store(Load(di, HWY_S(i)) - dim1, di, HWY_S(i));
+				auto si = Load(di, HWY_S(0));
+				for(i = 0; i + 1 < dn; i++)
+				{
+					auto sip1 = Load(di, HWY_S(i + 1));
+					Store(Load(di, HWY_D(i)) + ShiftRight<2>(si + sip1 + two), di, HWY_D(i));
+					si = sip1;
+				}
+				if((height & 1) == 0)
+					Store(Load(di, HWY_D(i)) + ShiftRight<2>(si + si + two), di, HWY_D(i));
+			}
+#undef HWY_S
+#undef HWY_D
+		}
+	}
+	/** Multiply every other element of vertical forward 9x7 buffer by constant */
+	static void hwy_encode_v_step1_97(float* fw, const uint32_t end, const float c)
+	{
+		const HWY_FULL(float) df;
+		const HWY_FULL(int32_t) di;
+		const size_t numCols = HWY_PLL_COLS_FWD;
+		const auto vc = Set(df, c);
+		for(uint32_t i = 0; i < end; ++i, fw += 2 * numCols)
+		{
+			for(size_t k = 0; k < numCols; k += Lanes(df))
+				Store(Mul(Load(df, fw + k), vc), df, fw + k);
+		}
+	}
+	/** Vertical forward 9x7 lifting step */
+	static void hwy_encode_v_step2_97(const float* fl, float* fw, const uint32_t end,
+									  const uint32_t m, const float c)
+	{
+		const HWY_FULL(float) df;
+		const HWY_FULL(int32_t) di;
+		const size_t numCols = HWY_PLL_COLS_FWD;
+		const uint32_t imax = std::min<uint32_t>(end, m);
+		auto vc = Set(df, c);
+		for(uint32_t i = 0; i < imax; ++i)
+		{
+			for(size_t k = 0; k < numCols; k += Lanes(df))
+			{
+				auto dest = fw - numCols + k;
+				Store(Add(Load(df, dest), Mul(Add(Load(df, fl + k), Load(df, fw + k)), vc)), df,
+					  dest);
+			}
+			fl = fw;
+			fw += 2 * numCols;
+		}
+		if(m < end)
+		{
+			assert(m + 1 == end);
+			vc = Add(vc, vc);
+			for(size_t k = 0; k < numCols; k += Lanes(df))
+			{
+				auto dest = fw - numCols + k;
+				Store(Add(Load(df, dest), Mul(Load(df, fw - 2 * numCols + k), vc)), df, dest);
+			}
+		}
+	}
+	/** Scale numPairs interleaved (low, high) pass sample pairs of a row by c1 and c2 */
+	static void hwy_encode_step1_combined_97(float* fw, const uint32_t numPairs, const float c1,
+											 const float c2)
+	{
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const size_t len = (size_t)numPairs * 2;
+		size_t i = 0;
+		if(N >= 2)
+		{
+			const auto vc = OddEven(Set(df, c2), Set(df, c1));
+			for(; i + N <= len; i += N)
+				StoreU(Mul(LoadU(df, fw + i), vc), df, fw + i);
+		}
+		for(; i < len; i += 2)
+		{
+			fw[i] *= c1;
+			fw[i + 1] *= c2;
+		}
+	}
+
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_num_lanes);
+HWY_EXPORT(hwy_encode_v_mcols_53);
+HWY_EXPORT(hwy_encode_v_step1_97);
+HWY_EXPORT(hwy_encode_v_step2_97);
+HWY_EXPORT(hwy_encode_step1_combined_97);
+
+#define PLL_COLS_FWD (2 * uint32_t(HWY_DYNAMIC_DISPATCH(hwy_num_lanes)()))
+
 template<typename T>
 struct dwt_line
 {
@@ -33,8 +207,6 @@ struct dwt_line
 	uint32_t parity; /* 0 = start on even coord, 1 = start on odd coord */
 };
 
-const uint32_t NB_ELTS_V8 = 8;
-
 /* From table F.4 from the standard */
 static const float alpha = -1.586134342f;
 static const float beta = -0.052980118f;
@@ -79,37 +251,14 @@ void deinterleave_h(const T* GRK_RESTRICT a, T* GRK_RESTRICT b, int32_t dn, int3
 void dwt97::encode_step1_combined(float* fw, uint32_t iters_c1, uint32_t iters_c2, const float c1,
 								  const float c2)
 {
-	uint32_t i = 0;
 	const uint32_t iters_common = std::min<uint32_t>(iters_c1, iters_c2);
 	assert((((size_t)fw) & 0xf) == 0);
 	assert(abs((int32_t)iters_c1 - (int32_t)iters_c2) <= 1);
-	for(; i + 3 < iters_common; i += 4)
-	{
-#ifdef __SSE__
-		const __m128 vcst = _mm_set_ps(c2, c1, c2, c1);
-		*(__m128*)fw = _mm_mul_ps(*(__m128*)fw, vcst);
-		*(__m128*)(fw + 4) = _mm_mul_ps(*(__m128*)(fw + 4), vcst);
-#else
+	HWY_DYNAMIC_DISPATCH(hwy_encode_step1_combined_97)(fw, iters_common, c1, c2);
+	fw += 2 * iters_common;
+	if(iters_common < iters_c1)
 		fw[0] *= c1;
-		fw[1] *= c2;
-		fw[2] *= c1;
-		fw[3] *= c2;
-		fw[4] *= c1;
-		fw[5] *= c2;
-		fw[6] *= c1;
-		fw[7] *= c2;
-#endif
-		fw += 8;
-	}
-	for(; i < iters_common; i++)
-	{
-		fw[0] *= c1;
-		fw[1] *= c2;
-		fw += 2;
-	}
-	if(i < iters_c1)
-		fw[0] *= c1;
-	else if(i < iters_c2)
+	else if(iters_common < iters_c2)
 		fw[1] *= c2;
 }
 
@@ -206,10 +355,11 @@ struct encode_v_job
 template<typename T, typename DWT>
 void encode_v_func(encode_v_job<T, DWT>* job)
 {
+	const uint32_t numCols = PLL_COLS_FWD;
 	uint32_t j;
-	for(j = job->min_j; j + NB_ELTS_V8 - 1 < job->max_j; j += NB_ELTS_V8)
+	for(j = job->min_j; j + numCols - 1 < job->max_j; j += numCols)
 		job->dwt.encode_and_deinterleave_v((T*)job->tiledp + j, (T*)job->v.mem, job->rh,
-										   job->v.parity == 0, job->w, NB_ELTS_V8);
+										   job->v.parity == 0, job->w, numCols);
 	if(j < job->max_j)
 		job->dwt.encode_and_deinterleave_v((T*)job->tiledp + j, (T*)job->v.mem, job->rh,
 										   job->v.parity == 0, job->w, job->max_j - j);
@@ -217,17 +367,17 @@ void encode_v_func(encode_v_job<T, DWT>* job)
 	delete job;
 }
 
-/** Fetch up to cols <= NB_ELTS_V8 for each line, and put them in tmpOut */
-/* that has a NB_ELTS_V8 interleave factor. */
+/** Fetch up to cols <= numCols for each line, and put them in tmpOut */
+/* that has a numCols interleave factor. */
 template<typename T>
 void fetch_cols_vertical_pass(const T* array, T* tmp, uint32_t height, uint32_t stride_width,
-							  uint32_t cols)
+							  uint32_t numCols, uint32_t cols)
 {
-	if(cols == NB_ELTS_V8)
+	if(cols == numCols)
 	{
 		uint32_t k;
 		for(k = 0; k < height; ++k)
-			memcpy(tmp + NB_ELTS_V8 * k, array + k * stride_width, NB_ELTS_V8 * sizeof(T));
+			memcpy(tmp + numCols * k, array + (size_t)k * stride_width, numCols * sizeof(T));
 	}
 	else
 	{
@@ -236,145 +386,38 @@ void fetch_cols_vertical_pass(const T* array, T* tmp, uint32_t height, uint32_t
 		{
 			uint32_t c;
 			for(c = 0; c < cols; c++)
-				tmp[NB_ELTS_V8 * k + c] = array[c + k * stride_width];
-			for(; c < NB_ELTS_V8; c++)
-				tmp[NB_ELTS_V8 * k + c] = 0;
+				tmp[numCols * k + c] = array[c + (size_t)k * stride_width];
+			for(; c < numCols; c++)
+				tmp[numCols * k + c] = 0;
 		}
 	}
 }
 
-/* Deinterleave result of forward transform, where cols <= NB_ELTS_V8 */
-/* and src contains NB_ELTS_V8 consecutive values for up to NB_ELTS_V8 */
+/* Deinterleave result of forward transform, where cols <= numCols */
+/* and src contains numCols consecutive values for up to numCols */
 /* columns. */
 template<typename T>
 void deinterleave_v_cols(const T* GRK_RESTRICT src, T* GRK_RESTRICT dst, uint32_t dn, uint32_t sn,
-						 uint32_t stride_width, uint32_t parity, uint32_t cols)
+						 uint32_t stride_width, uint32_t parity, uint32_t numCols, uint32_t cols)
 {
 	int64_t i = sn;
 	T* GRK_RESTRICT destPtr = dst;
-	const T* GRK_RESTRICT srcPtr = src + parity * NB_ELTS_V8;
-	uint32_t c;
+	const T* GRK_RESTRICT srcPtr = src + parity * numCols;
 
 	for(uint32_t k = 0; k < 2; k++)
 	{
 		while(i--)
 		{
-			if(cols == NB_ELTS_V8)
-			{
-				memcpy(destPtr, srcPtr, NB_ELTS_V8 * sizeof(T));
-			}
-			else
-			{
-				c = 0;
-				switch(cols)
-				{
-					case 7:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 6:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 5:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 4:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 3:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 2:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					default:
-						destPtr[c] = srcPtr[c];
-						break;
-				}
-			}
+			memcpy(destPtr, srcPtr, cols * sizeof(T));
 			destPtr += stride_width;
-			srcPtr += 2 * NB_ELTS_V8;
+			srcPtr += 2 * numCols;
 		}
 
 		destPtr = dst + (size_t)sn * (size_t)stride_width;
-		srcPtr = src + (1 - parity) * NB_ELTS_V8;
+		srcPtr = src + (1 - parity) * numCols;
 		i = dn;
 	}
 }
-void dwt97::grk_v8dwt_encode_step1(float* fw, uint32_t end, const float cst)
-{
-	uint32_t i;
-#ifdef __SSE__
-	__m128* vw = (__m128*)fw;
-	const __m128 vcst = _mm_set1_ps(cst);
-	for(i = 0; i < end; ++i)
-	{
-		vw[0] = _mm_mul_ps(vw[0], vcst);
-		vw[1] = _mm_mul_ps(vw[1], vcst);
-		vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-	}
-#else
-	uint32_t c;
-	for(i = 0; i < end; ++i)
-	{
-		for(c = 0; c < NB_ELTS_V8; c++)
-			fw[i * 2 * NB_ELTS_V8 + c] *= cst;
-	}
-#endif
-}
-
-void dwt97::grk_v8dwt_encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float cst)
-{
-	uint32_t i;
-	uint32_t imax = std::min<uint32_t>(end, m);
-#ifdef __SSE__
-	__m128* vw = (__m128*)fw;
-	__m128 vcst = _mm_set1_ps(cst);
-	if(imax > 0)
-	{
-		__m128* vl = (__m128*)fl;
-		vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(_mm_add_ps(vl[0], vw[0]), vcst));
-		vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(_mm_add_ps(vl[1], vw[1]), vcst));
-		vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-		i = 1;
-
-		for(; i < imax; ++i)
-		{
-			vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(_mm_add_ps(vw[-4], vw[0]), vcst));
-			vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(_mm_add_ps(vw[-3], vw[1]), vcst));
-			vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-		}
-	}
-	if(m < end)
-	{
-		assert(m + 1 == end);
-		vcst = _mm_add_ps(vcst, vcst);
-		vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(vw[-4], vcst));
-		vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(vw[-3], vcst));
-	}
-#else
-	uint32_t c;
-	const int64_t NB_ELTS = (int64_t)NB_ELTS_V8;
-	if(imax > 0)
-	{
-		for(c = 0; c < NB_ELTS; c++)
-			fw[-1 * NB_ELTS + c] += (fl[0 * NB_ELTS + c] + fw[0 * NB_ELTS + c]) * cst;
-		fw += 2 * NB_ELTS;
-		i = 1;
-		for(; i < imax; ++i)
-		{
-			for(c = 0; c < NB_ELTS; c++)
-				fw[-1 * NB_ELTS + c] += (fw[-2 * NB_ELTS + c] + fw[0 * NB_ELTS + c]) * cst;
-			fw += 2 * NB_ELTS;
-		}
-	}
-	if(m < end)
-	{
-		assert(m + 1 == end);
-		for(c = 0; c < NB_ELTS; c++)
-			fw[-1 * NB_ELTS + c] += (2 * fw[-2 * NB_ELTS + c]) * cst;
-	}
-#endif
-}
 /* <summary>                            */
 /* Forward 5-3 wavelet transform in 2-D. */
 /* </summary>                           */
@@ -392,14 +435,16 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 	auto currentRes = tilec->resolutions_ + maxNumResolutions;
 	auto lastRes = currentRes - 1;
 
+	/* vertical pass processes numCols columns at a time */
+	const uint32_t numCols = PLL_COLS_FWD;
 	size_t dataSize = max_resolution(tilec->resolutions_, tilec->numresolutions);
 	/* overflow check */
-	if(dataSize > (SIZE_MAX / (NB_ELTS_V8 * sizeof(int32_t))))
+	if(dataSize > (SIZE_MAX / (numCols * sizeof(int32_t))))
 	{
 		Logger::logger_.error("Forward wavelet overflow");
 		return false;
 	}
-	dataSize *= NB_ELTS_V8 * sizeof(int32_t);
+	dataSize *= numCols * sizeof(int32_t);
 	auto bj = (T*)grk_aligned_malloc(dataSize);
 	/* dataSize is equal to 0 when numresolutions == 1 but bj is not used */
 	/* in that case, so do not error out */
@@ -432,12 +477,12 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 		bool rc = true;
 
 		/* Perform vertical pass */
-		if(num_threads <= 1 || rw < 2 * NB_ELTS_V8)
+		if(num_threads <= 1 || rw < 2 * numCols)
 		{
 			uint32_t j;
-			for(j = 0; j + NB_ELTS_V8 - 1 < rw; j += NB_ELTS_V8)
+			for(j = 0; j + numCols - 1 < rw; j += numCols)
 				dwt.encode_and_deinterleave_v((T*)tiledp + j, bj, rh, parity_col == 0, stride,
-											  NB_ELTS_V8);
+											  numCols);
 			if(j < rw)
 				dwt.encode_and_deinterleave_v((T*)tiledp + j, bj, rh, parity_col == 0, stride,
 											  rw - j);
@@ -449,7 +494,7 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 
 			if(rw < num_jobs)
 				num_jobs = rw;
-			step_j = ((rw / num_jobs) / NB_ELTS_V8) * NB_ELTS_V8;
+			step_j = ((rw / num_jobs) / numCols) * numCols;
 			tf::Taskflow taskflow;
 			tf::Task* node = nullptr;
 			if(num_jobs > 1)
@@ -491,7 +536,7 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 			}
 			if(node)
 			{
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] node;
 			}
 			if(!rc)
@@ -557,7 +602,7 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 			}
 			if(node)
 			{
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] node;
 			}
 			if(!rc)
@@ -580,228 +625,17 @@ bool WaveletFwdImpl::compress(TileComponent* tile_comp, uint8_t qmfbid)
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 /* Forward 5-3 transform, for the vertical pass, processing cols columns */
-/* where cols <= NB_ELTS_V8 */
+/* where cols <= PLL_COLS_FWD */
 void dwt53::encode_and_deinterleave_v(int32_t* arrayIn, int32_t* tmpIn, uint32_t height, bool even,
 									  uint32_t stride_width, uint32_t cols)
 {
-	int32_t* GRK_RESTRICT array = (int32_t * GRK_RESTRICT) arrayIn;
-	int32_t* GRK_RESTRICT tmp = (int32_t * GRK_RESTRICT) tmpIn;
+	const uint32_t numCols = PLL_COLS_FWD;
 	const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
 	const uint32_t dn = height - sn;
 
-	fetch_cols_vertical_pass<int32_t>(arrayIn, tmpIn, height, stride_width, cols);
-
-#define GRK_Sc(i) tmp[((i) << 1) * NB_ELTS_V8 + c]
-#define GRK_Dc(i) tmp[((1 + ((i) << 1))) * NB_ELTS_V8 + c]
-
-#ifdef __SSE2__
-	if(height == 1)
-	{
-		if(!even)
-		{
-			uint32_t c;
-			for(c = 0; c < NB_ELTS_V8; c++)
-				tmp[c] *= 2;
-		}
-	}
-	else if(even)
-	{
-		uint32_t c;
-		uint32_t i;
-		i = 0;
-		if(i + 1 < sn)
-		{
-			__m128i xmm_Si_0 = *(const __m128i*)(tmp + 4 * 0);
-			__m128i xmm_Si_1 = *(const __m128i*)(tmp + 4 * 1);
-			for(; i + 1 < sn; i++)
-			{
-				__m128i xmm_Sip1_0 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Sip1_1 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				xmm_Di_0 =
-					_mm_sub_epi32(xmm_Di_0, _mm_srai_epi32(_mm_add_epi32(xmm_Si_0, xmm_Sip1_0), 1));
-				xmm_Di_1 =
-					_mm_sub_epi32(xmm_Di_1, _mm_srai_epi32(_mm_add_epi32(xmm_Si_1, xmm_Sip1_1), 1));
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0) = xmm_Di_0;
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1) = xmm_Di_1;
-				xmm_Si_0 = xmm_Sip1_0;
-				xmm_Si_1 = xmm_Sip1_1;
-			}
-		}
-		if(((height)&1) == 0)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Dc(i) -= GRK_Sc(i);
-		}
-		for(c = 0; c < NB_ELTS_V8; c++)
-			GRK_Sc(0) += (GRK_Dc(0) + GRK_Dc(0) + 2) >> 2;
-		i = 1;
-		if(i < dn)
-		{
-			__m128i xmm_Dim1_0 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 0);
-			__m128i xmm_Dim1_1 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 1);
-			const __m128i xmm_two = _mm_set1_epi32(2);
-			for(; i < dn; i++)
-			{
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Si_0 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Si_1 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1);
-				xmm_Si_0 = _mm_add_epi32(
-					xmm_Si_0,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Dim1_0, xmm_Di_0), xmm_two), 2));
-				xmm_Si_1 = _mm_add_epi32(
-					xmm_Si_1,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Dim1_1, xmm_Di_1), xmm_two), 2));
-				*(__m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0) = xmm_Si_0;
-				*(__m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1) = xmm_Si_1;
-				xmm_Dim1_0 = xmm_Di_0;
-				xmm_Dim1_1 = xmm_Di_1;
-			}
-		}
-		if(((height)&1) == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i - 1) + 2) >> 2;
-		}
-	}
-	else
-	{
-		uint32_t c;
-		uint32_t i;
-		for(c = 0; c < NB_ELTS_V8; c++)
-		{
-			GRK_Sc(0) -= GRK_Dc(0);
-		}
-		i = 1;
-		if(i < sn)
-		{
-			__m128i xmm_Dim1_0 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 0);
-			__m128i xmm_Dim1_1 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 1);
-			for(; i < sn; i++)
-			{
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Si_0 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Si_1 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1);
-				xmm_Si_0 =
-					_mm_sub_epi32(xmm_Si_0, _mm_srai_epi32(_mm_add_epi32(xmm_Di_0, xmm_Dim1_0), 1));
-				xmm_Si_1 =
-					_mm_sub_epi32(xmm_Si_1, _mm_srai_epi32(_mm_add_epi32(xmm_Di_1, xmm_Dim1_1), 1));
-				*(__m128i*)(tmp + (i * 2) * NB_ELTS_V8 + 4 * 0) = xmm_Si_0;
-				*(__m128i*)(tmp + (i * 2) * NB_ELTS_V8 + 4 * 1) = xmm_Si_1;
-				xmm_Dim1_0 = xmm_Di_0;
-				xmm_Dim1_1 = xmm_Di_1;
-			}
-		}
-		if(((height)&1) == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(i) -= GRK_Dc(i - 1);
-		}
-		i = 0;
-		if(i + 1 < dn)
-		{
-			__m128i xmm_Si_0 = *((const __m128i*)(tmp + 4 * 0));
-			__m128i xmm_Si_1 = *((const __m128i*)(tmp + 4 * 1));
-			const __m128i xmm_two = _mm_set1_epi32(2);
-			for(; i + 1 < dn; i++)
-			{
-				__m128i xmm_Sip1_0 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Sip1_1 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				xmm_Di_0 = _mm_add_epi32(
-					xmm_Di_0,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Si_0, xmm_Sip1_0), xmm_two), 2));
-				xmm_Di_1 = _mm_add_epi32(
-					xmm_Di_1,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Si_1, xmm_Sip1_1), xmm_two), 2));
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0) = xmm_Di_0;
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1) = xmm_Di_1;
-				xmm_Si_0 = xmm_Sip1_0;
-				xmm_Si_1 = xmm_Sip1_1;
-			}
-		}
-		if(((height)&1) == 0)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i) + 2) >> 2;
-		}
-	}
-#else
-	if(even)
-	{
-		if(height > 1)
-		{
-			uint32_t i;
-			uint32_t c;
-			for(i = 0; i + 1 < sn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) -= (GRK_Sc(i) + GRK_Sc(i + 1)) >> 1;
-			}
-			if(((height) % 2) == 0)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) -= GRK_Sc(i);
-			}
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) += (GRK_Dc(0) + GRK_Dc(0) + 2) >> 2;
-			for(i = 1; i < dn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i) + 2) >> 2;
-			}
-			if(((height) % 2) == 1)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i - 1) + 2) >> 2;
-			}
-		}
-	}
-	else
-	{
-		uint32_t c;
-		if(height == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) *= 2;
-		}
-		else
-		{
-			uint32_t i;
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) -= GRK_Dc(0);
-			for(i = 1; i < sn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) -= (GRK_Dc(i) + GRK_Dc(i - 1)) >> 1;
-			}
-			if(((height) % 2) == 1)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) -= GRK_Dc(i - 1);
-			}
-			for(i = 0; i + 1 < dn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i + 1) + 2) >> 2;
-			}
-			if(((height) % 2) == 0)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i) + 2) >> 2;
-			}
-		}
-	}
-#endif
-
-	if(cols == NB_ELTS_V8)
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, NB_ELTS_V8);
-	else
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, cols);
+	fetch_cols_vertical_pass<int32_t>(arrayIn, tmpIn, height, stride_width, numCols, cols);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_mcols_53)(tmpIn, height, even);
+	deinterleave_v_cols(tmpIn, arrayIn, dn, sn, stride_width, even ? 0 : 1, numCols, cols);
 }
 
 /** Process one line for the horizontal pass of the 5x3 forward transform */
@@ -854,12 +688,13 @@ void dwt53::encode_and_deinterleave_h_one_row(int32_t* rowIn, int32_t* tmpIn, ui
 }
 
 /* Forward 9-7 transform, for the vertical pass, processing cols columns */
-/* where cols <= NB_ELTS_V8 */
+/* where cols <= PLL_COLS_FWD */
 void dwt97::encode_and_deinterleave_v(float* arrayIn, float* tmpIn, uint32_t height, bool even,
 									  uint32_t stride_width, uint32_t cols)
 {
 	float* GRK_RESTRICT array = (float* GRK_RESTRICT)arrayIn;
 	float* GRK_RESTRICT tmp = (float* GRK_RESTRICT)tmpIn;
+	const uint32_t numCols = PLL_COLS_FWD;
 	const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
 	const uint32_t dn = height - sn;
 	uint32_t a, b;
@@ -867,7 +702,7 @@ void dwt97::encode_and_deinterleave_v(float* arrayIn, float* tmpIn, uint32_t hei
 	if(height == 1)
 		return;
 
-	fetch_cols_vertical_pass(arrayIn, tmpIn, height, stride_width, cols);
+	fetch_cols_vertical_pass(arrayIn, tmpIn, height, stride_width, numCols, cols);
 	if(even)
 	{
 		a = 0;
@@ -878,21 +713,18 @@ void dwt97::encode_and_deinterleave_v(float* arrayIn, float* tmpIn, uint32_t hei
 		a = 1;
 		b = 0;
 	}
-	grk_v8dwt_encode_step2(tmp + a * NB_ELTS_V8, tmp + (b + 1) * NB_ELTS_V8, dn,
-						   std::min<uint32_t>(dn, sn - b), alpha);
-	grk_v8dwt_encode_step2(tmp + b * NB_ELTS_V8, tmp + (a + 1) * NB_ELTS_V8, sn,
-						   std::min<uint32_t>(sn, dn - a), beta);
-	grk_v8dwt_encode_step2(tmp + a * NB_ELTS_V8, tmp + (b + 1) * NB_ELTS_V8, dn,
-						   std::min<uint32_t>(dn, sn - b), gamma);
-	grk_v8dwt_encode_step2(tmp + b * NB_ELTS_V8, tmp + (a + 1) * NB_ELTS_V8, sn,
-						   std::min<uint32_t>(sn, dn - a), delta);
-	grk_v8dwt_encode_step1(tmp + b * NB_ELTS_V8, (uint32_t)dn, grk_K);
-	grk_v8dwt_encode_step1(tmp + a * NB_ELTS_V8, (uint32_t)sn, grk_invK);
-
-	if(cols == NB_ELTS_V8)
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, NB_ELTS_V8);
-	else
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, cols);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step2_97)
+	(tmp + a * numCols, tmp + (b + 1) * numCols, dn, std::min<uint32_t>(dn, sn - b), alpha);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step2_97)
+	(tmp + b * numCols, tmp + (a + 1) * numCols, sn, std::min<uint32_t>(sn, dn - a), beta);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step2_97)
+	(tmp + a * numCols, tmp + (b + 1) * numCols, dn, std::min<uint32_t>(dn, sn - b), gamma);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step2_97)
+	(tmp + b * numCols, tmp + (a + 1) * numCols, sn, std::min<uint32_t>(sn, dn - a), delta);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step1_97)(tmp + b * numCols, dn, grk_K);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_step1_97)(tmp + a * numCols, sn, grk_invK);
+
+	deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, numCols, cols);
 }
 
 /** Process one line for the horizontal pass of the 9x7 forward transform */
@@ -910,3 +742,4 @@ void dwt97::encode_and_deinterleave_h_one_row(float* rowIn, float* tmpIn, uint32
 }
 
 } // namespace grk
+#endif
@@ -41,8 +41,6 @@ class dwt97
 	void encode_and_deinterleave_h_one_row(float* rowIn, float* tmpIn, uint32_t width, bool even);
 
   private:
-	void grk_v8dwt_encode_step1(float* fw, uint32_t end, const float cst);
-	void grk_v8dwt_encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float cst);
 	void encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float c);
 
 	void encode_step1_combined(float* fw, uint32_t iters_c1, uint32_t iters_c2, const float c1,
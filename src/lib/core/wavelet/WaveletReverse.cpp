@@ -227,6 +227,106 @@ namespace HWY_NAMESPACE
 		hwy_decompress_v_final_memcpy_53(buf, total_height, dest, strideDest);
 	}
 
+	/**
+	 * 9/7 lifting buffers are interleaved sequences of elements, where each element
+	 * holds NUM_ELTS floats : one from each of NUM_ELTS rows (horizontal pass)
+	 * or columns (vertical pass). Elements are processed in chunks of at most
+	 * NUM_ELTS lanes, so a 16 float element is a single AVX-512 vector,
+	 * two AVX2 vectors or four SSE vectors.
+	 */
+	template<size_t NUM_ELTS>
+	static void hwy_decompress_step1_97_impl(float* data, const uint32_t len, const float c)
+	{
+		const CappedTag<float, NUM_ELTS> df;
+		const auto vc = Set(df, c);
+		for(uint32_t i = 0; i < len; ++i, data += 2 * NUM_ELTS)
+		{
+			for(size_t k = 0; k < NUM_ELTS; k += Lanes(df))
+				Store(Mul(Load(df, data + k), vc), df, data + k);
+		}
+	}
+	template<size_t NUM_ELTS>
+	static void hwy_decompress_step2_97_impl(const float* dataPrev, float* data,
+											 const uint32_t len, const uint32_t lenMax,
+											 const float c)
+	{
+		const CappedTag<float, NUM_ELTS> df;
+		auto vc = Set(df, c);
+		uint32_t imax = (std::min<uint32_t>)(len, lenMax);
+		for(uint32_t i = 0; i < imax; ++i)
+		{
+			for(size_t k = 0; k < NUM_ELTS; k += Lanes(df))
+			{
+				auto prev = Load(df, dataPrev + k);
+				auto next = Load(df, data + k);
+				auto dest = data - NUM_ELTS + k;
+				Store(Add(Load(df, dest), Mul(Add(prev, next), vc)), df, dest);
+			}
+			dataPrev = data;
+			data += 2 * NUM_ELTS;
+		}
+		if(lenMax < len)
+		{
+			assert(lenMax + 1 == len);
+			vc = Add(vc, vc);
+			for(size_t k = 0; k < NUM_ELTS; k += Lanes(df))
+			{
+				auto dest = data - NUM_ELTS + k;
+				Store(Add(Load(df, dest), Mul(Load(df, dataPrev + k), vc)), df, dest);
+			}
+		}
+	}
+	static void hwy_decompress_step1_97(float* data, const uint32_t len, const float c,
+										const uint32_t numElts)
+	{
+		if(numElts == 16)
+			hwy_decompress_step1_97_impl<16>(data, len, c);
+		else
+			hwy_decompress_step1_97_impl<4>(data, len, c);
+	}
+	static void hwy_decompress_step2_97(const float* dataPrev, float* data, const uint32_t len,
+										const uint32_t lenMax, const float c,
+										const uint32_t numElts)
+	{
+		if(numElts == 16)
+			hwy_decompress_step2_97_impl<16>(dataPrev, data, len, lenMax, c);
+		else
+			hwy_decompress_step2_97_impl<4>(dataPrev, data, len, lenMax, c);
+	}
+	/**
+	 * Interleave 16 rows of one band into horizontal lifting buffer
+	 * with 16 float elements
+	 */
+	static void hwy_interleave_h_97(float* bi, const float* band, const uint32_t stride,
+									const uint32_t x0, const uint32_t x1)
+	{
+		const CappedTag<float, 16> df;
+		const RebindToSigned<decltype(df)> di;
+		const size_t N = Lanes(df);
+		const auto offsets = Mul(Iota(di, 0), Set(di, (int32_t)stride));
+		for(uint32_t i = x0; i < x1; ++i, bi += 32)
+		{
+			for(size_t k = 0; k < 16; k += N)
+				Store(GatherIndex(df, band + i + k * stride, offsets), df, bi + k);
+		}
+	}
+	/**
+	 * Interleave 16 columns of one band into vertical lifting buffer
+	 * with 16 float elements
+	 */
+	static void hwy_interleave_v_97(float* bi, const float* band, const uint32_t stride,
+									const uint32_t y0, const uint32_t y1)
+	{
+		const CappedTag<float, 16> df;
+		const size_t N = Lanes(df);
+		band += (size_t)y0 * stride;
+		for(uint32_t i = y0; i < y1; ++i, bi += 32, band += stride)
+		{
+			for(size_t k = 0; k < 16; k += N)
+				Store(LoadU(df, band + k), df, bi + k);
+		}
+	}
+
 } // namespace HWY_NAMESPACE
 } // namespace grk
 HWY_AFTER_NAMESPACE();
@@ -237,6 +337,10 @@ namespace grk
 HWY_EXPORT(hwy_num_lanes);
 HWY_EXPORT(hwy_decompress_v_parity_even_mcols_53);
 HWY_EXPORT(hwy_decompress_v_parity_odd_mcols_53);
+HWY_EXPORT(hwy_decompress_step1_97);
+HWY_EXPORT(hwy_decompress_step2_97);
+HWY_EXPORT(hwy_interleave_h_97);
+HWY_EXPORT(hwy_interleave_v_97);
 /* <summary>                             */
 /* Determine maximum computed resolution level for inverse wavelet transform */
 /* </summary>                            */
@@ -270,196 +374,58 @@ static const float dwt_delta = -0.443506852f; /*  -3633 */
 static const float K = 1.230174105f; /*  10078 */
 static const float twice_invK = 1.625732422f;
 
-// #undef __SSE__
-
-#ifdef __SSE__
-void WaveletReverse::decompress_step1_sse_97(Params97 d, const __m128 c)
+static void decompress_step1_97(const Params97& d, const float c, const uint32_t numElts)
 {
-	// process 4 floats at a time
-	auto mmData = (__m128*)d.data;
-	uint32_t i;
-	for(i = 0; i + 3 < d.len; i += 4, mmData += 8)
-	{
-		mmData[0] = _mm_mul_ps(mmData[0], c);
-		mmData[2] = _mm_mul_ps(mmData[2], c);
-		mmData[4] = _mm_mul_ps(mmData[4], c);
-		mmData[6] = _mm_mul_ps(mmData[6], c);
-	}
-	for(; i < d.len; ++i, mmData += 2)
-		mmData[0] = _mm_mul_ps(mmData[0], c);
+	HWY_DYNAMIC_DISPATCH(hwy_decompress_step1_97)(d.data, d.len, c, numElts);
 }
-#endif
-
-void WaveletReverse::decompress_step1_97(const Params97& d, const float c)
+static void decompress_step2_97(const Params97& d, const float c, const uint32_t numElts)
 {
-#ifdef __SSE__
-	decompress_step1_sse_97(d, _mm_set1_ps(c));
-#else
-	float* GRK_RESTRICT fw = (float*)d.data;
-
-	for(uint32_t i = 0; i < d.len; ++i, fw += 8)
-	{
-		fw[0] *= c;
-		fw[1] *= c;
-		fw[2] *= c;
-		fw[3] *= c;
-		;
-	}
-#endif
-}
-
-#ifdef __SSE__
-static void decompress_step2_sse_97(const Params97& d, __m128 c)
-{
-	__m128* GRK_RESTRICT vec_data = (__m128*)d.data;
-
-	uint32_t imax = (std::min<uint32_t>)(d.len, d.lenMax);
-
-	// initial tmp1 value is only necessary when
-	// absolute start of line is at 0
-	auto tmp1 = ((__m128*)d.dataPrev)[0];
-	uint32_t i = 0;
-	for(; i + 3 < imax; i += 4)
-	{
-		auto tmp2 = vec_data[-1];
-		auto tmp3 = vec_data[0];
-		auto tmp4 = vec_data[1];
-		auto tmp5 = vec_data[2];
-		auto tmp6 = vec_data[3];
-		auto tmp7 = vec_data[4];
-		auto tmp8 = vec_data[5];
-		auto tmp9 = vec_data[6];
-		vec_data[-1] = _mm_add_ps(tmp2, _mm_mul_ps(_mm_add_ps(tmp1, tmp3), c));
-		vec_data[1] = _mm_add_ps(tmp4, _mm_mul_ps(_mm_add_ps(tmp3, tmp5), c));
-		vec_data[3] = _mm_add_ps(tmp6, _mm_mul_ps(_mm_add_ps(tmp5, tmp7), c));
-		vec_data[5] = _mm_add_ps(tmp8, _mm_mul_ps(_mm_add_ps(tmp7, tmp9), c));
-		tmp1 = tmp9;
-		vec_data += 8;
-	}
-
-	for(; i < imax; ++i)
-	{
-		auto tmp2 = vec_data[-1];
-		auto tmp3 = vec_data[0];
-		vec_data[-1] = _mm_add_ps(tmp2, _mm_mul_ps(_mm_add_ps(tmp1, tmp3), c));
-		tmp1 = tmp3;
-		vec_data += 2;
-	}
-	if(d.lenMax < d.len)
-	{
-		assert(d.lenMax + 1 == d.len);
-		c = _mm_add_ps(c, c);
-		c = _mm_mul_ps(c, vec_data[-2]);
-		vec_data[-1] = _mm_add_ps(vec_data[-1], c);
-	}
-}
-#endif
-
-static void decompress_step2_97(const Params97& d, float c)
-{
-#ifdef __SSE__
-	decompress_step2_sse_97(d, _mm_set1_ps(c));
-#else
-
-	float* dataPrev = (float*)d.dataPrev;
-	float* data = (float*)d.data;
-
-	uint32_t imax = (std::min<uint32_t>)(d.len, d.lenMax);
-	for(uint32_t i = 0; i < imax; ++i)
-	{
-		float tmp1_1 = dataPrev[0];
-		float tmp1_2 = dataPrev[1];
-		float tmp1_3 = dataPrev[2];
-		float tmp1_4 = dataPrev[3];
-		float tmp2_1 = data[-4];
-		float tmp2_2 = data[-3];
-		float tmp2_3 = data[-2];
-		float tmp2_4 = data[-1];
-		float tmp3_1 = data[0];
-		float tmp3_2 = data[1];
-		float tmp3_3 = data[2];
-		float tmp3_4 = data[3];
-		data[-4] = tmp2_1 + ((tmp1_1 + tmp3_1) * c);
-		data[-3] = tmp2_2 + ((tmp1_2 + tmp3_2) * c);
-		data[-2] = tmp2_3 + ((tmp1_3 + tmp3_3) * c);
-		data[-1] = tmp2_4 + ((tmp1_4 + tmp3_4) * c);
-		dataPrev = data;
-		data += 8;
-	}
-	if(d.lenMax < d.len)
-	{
-		assert(d.lenMax + 1 == d.len);
-		c += c;
-		data[-4] = data[-4] + dataPrev[0] * c;
-		data[-3] = data[-3] + dataPrev[1] * c;
-		data[-2] = data[-2] + dataPrev[2] * c;
-		data[-1] = data[-1] + dataPrev[3] * c;
-	}
-#endif
+	HWY_DYNAMIC_DISPATCH(hwy_decompress_step2_97)(d.dataPrev, d.data, d.len, d.lenMax, c, numElts);
 }
 /* <summary>                             */
 /* Inverse 9-7 wavelet transform in 1-D. */
 /* </summary>                            */
-void WaveletReverse::decompress_step_97(dwt_data<vec4f>* GRK_RESTRICT dwt)
+template<typename T>
+void WaveletReverse::decompress_step_97(dwt_data<T>* GRK_RESTRICT dwt)
 {
 	if((!dwt->parity && dwt->dn_full == 0 && dwt->sn_full <= 1) ||
 	   (dwt->parity && dwt->sn_full == 0 && dwt->dn_full >= 1))
 		return;
 
-	decompress_step1_97(makeParams97(dwt, true, true), K);
-	decompress_step1_97(makeParams97(dwt, false, true), twice_invK);
-	decompress_step2_97(makeParams97(dwt, true, false), dwt_delta);
-	decompress_step2_97(makeParams97(dwt, false, false), dwt_gamma);
-	decompress_step2_97(makeParams97(dwt, true, false), dwt_beta);
-	decompress_step2_97(makeParams97(dwt, false, false), dwt_alpha);
+	const uint32_t numElts = T::NUM_ELTS;
+	decompress_step1_97(makeParams97(dwt, true, true), K, numElts);
+	decompress_step1_97(makeParams97(dwt, false, true), twice_invK, numElts);
+	decompress_step2_97(makeParams97(dwt, true, false), dwt_delta, numElts);
+	decompress_step2_97(makeParams97(dwt, false, false), dwt_gamma, numElts);
+	decompress_step2_97(makeParams97(dwt, true, false), dwt_beta, numElts);
+	decompress_step2_97(makeParams97(dwt, false, false), dwt_alpha, numElts);
 }
-void WaveletReverse::interleave_h_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
+void WaveletReverse::interleave_h_97(dwt_data<vec16f>* GRK_RESTRICT dwt,
 									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 									 uint32_t remaining_height)
 {
 	float* GRK_RESTRICT bi = (float*)(dwt->mem + dwt->parity);
 	uint32_t x0 = dwt->win_l.x0;
 	uint32_t x1 = dwt->win_l.x1;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
+	const uint32_t numElts = vec16f::NUM_ELTS;
 	for(uint32_t k = 0; k < 2; ++k)
 	{
 		auto band = (k == 0) ? winL.buf_ : winH.buf_;
 		uint32_t stride = (k == 0) ? winL.stride_ : winH.stride_;
-		if(remaining_height >= vec4f_elts && ((size_t)band & 0x0f) == 0 &&
-		   ((size_t)bi & 0x0f) == 0 && (stride & 0x0f) == 0)
+		if(remaining_height >= numElts)
 		{
 			/* Fast code path */
-			for(uint32_t i = x0; i < x1; ++i, bi += vec4f_elts * 2)
-			{
-				uint32_t j = i;
-				bi[0] = band[j];
-				j += stride;
-				bi[1] = band[j];
-				j += stride;
-				bi[2] = band[j];
-				j += stride;
-				bi[3] = band[j];
-			}
+			HWY_DYNAMIC_DISPATCH(hwy_interleave_h_97)(bi, band, stride, x0, x1);
 		}
 		else
 		{
 			/* Slow code path */
-			for(uint32_t i = x0; i < x1; ++i, bi += vec4f_elts * 2)
+			auto b = bi;
+			for(uint32_t i = x0; i < x1; ++i, b += numElts * 2)
 			{
 				uint32_t j = i;
-				bi[0] = band[j];
-				j += stride;
-				if(remaining_height == 1)
-					continue;
-				bi[1] = band[j];
-				j += stride;
-				if(remaining_height == 2)
-					continue;
-				bi[2] = band[j];
-				j += stride;
-				if(remaining_height == 3)
-					continue;
-				bi[3] = band[j];
+				for(uint32_t r = 0; r < remaining_height; ++r, j += stride)
+					b[r] = band[j];
 			}
 		}
 		bi = (float*)(dwt->mem + 1 - dwt->parity);
@@ -467,53 +433,35 @@ void WaveletReverse::interleave_h_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
 		x1 = dwt->win_h.x1;
 	}
 }
-void WaveletReverse::decompress_h_strip_97(dwt_data<vec4f>* GRK_RESTRICT horiz,
+void WaveletReverse::decompress_h_strip_97(dwt_data<vec16f>* GRK_RESTRICT horiz,
 										   const uint32_t resHeight, grk_buf2d_simple<float> winL,
 										   grk_buf2d_simple<float> winH,
 										   grk_buf2d_simple<float> winDest)
 {
 	float* GRK_RESTRICT dest = winDest.buf_;
 	const uint32_t strideDest = winDest.stride_;
-	uint32_t j;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
-	for(j = 0; j < (resHeight & (uint32_t)(~(vec4f_elts - 1))); j += vec4f_elts)
+	const uint32_t numElts = vec16f::NUM_ELTS;
+	const uint32_t totalWidth = horiz->sn_full + horiz->dn_full;
+	for(uint32_t j = 0; j < resHeight; j += numElts)
 	{
-		interleave_h_97(horiz, winL, winH, resHeight - j);
+		uint32_t numRows = std::min<uint32_t>(numElts, resHeight - j);
+		interleave_h_97(horiz, winL, winH, numRows);
 		decompress_step_97(horiz);
-		for(uint32_t k = 0; k < horiz->sn_full + horiz->dn_full; k++)
+		for(uint32_t r = 0; r < numRows; ++r)
 		{
-			dest[k] = horiz->mem[k].val[0];
-			dest[k + (size_t)strideDest] = horiz->mem[k].val[1];
-			dest[k + (size_t)strideDest * 2] = horiz->mem[k].val[2];
-			dest[k + (size_t)strideDest * 3] = horiz->mem[k].val[3];
-		}
-		winL.buf_ += winL.stride_ << 2;
-		winH.buf_ += winH.stride_ << 2;
-		dest += strideDest << 2;
-	}
-	if(j < resHeight)
-	{
-		interleave_h_97(horiz, winL, winH, resHeight - j);
-		decompress_step_97(horiz);
-		for(uint32_t k = 0; k < horiz->sn_full + horiz->dn_full; k++)
-		{
-			switch(resHeight - j)
-			{
-				case 3:
-					dest[k + (strideDest << 1)] = horiz->mem[k].val[2];
-				/* FALLTHRU */
-				case 2:
-					dest[k + strideDest] = horiz->mem[k].val[1];
-				/* FALLTHRU */
-				case 1:
-					dest[k] = horiz->mem[k].val[0];
-			}
+			auto destRow = dest + (size_t)r * strideDest;
+			for(uint32_t k = 0; k < totalWidth; k++)
+				destRow[k] = horiz->mem[k].val[r];
 		}
+		winL.buf_ += (size_t)winL.stride_ * numElts;
+		winH.buf_ += (size_t)winH.stride_ * numElts;
+		dest += (size_t)strideDest * numElts;
 	}
 }
 bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-									 dwt_data<vec4f>& GRK_RESTRICT horiz, const uint32_t resHeight,
-									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
+									 dwt_data<vec16f>& GRK_RESTRICT horiz,
+									 const uint32_t resHeight, grk_buf2d_simple<float> winL,
+									 grk_buf2d_simple<float> winH,
 									 grk_buf2d_simple<float> winDest)
 {
 	if(resHeight == 0)
@@ -524,10 +472,12 @@ bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t da
 	}
 	else
 	{
-		uint32_t numTasks = numThreads;
-		if(resHeight < numTasks)
-			numTasks = resHeight;
-		uint32_t incrPerJob = resHeight / numTasks;
+		// strips are a multiple of the element height, so only the final strip
+		// leaves lanes unused
+		const uint32_t numElts = vec16f::NUM_ELTS;
+		uint32_t incrPerJob =
+			ceildiv<uint32_t>(ceildiv<uint32_t>(resHeight, numThreads), numElts) * numElts;
+		uint32_t numTasks = ceildiv<uint32_t>(resHeight, incrPerJob);
 		auto imageComponentFlow = scheduler_->getImageComponentFlow(compno_);
 		if(!imageComponentFlow)
 		{
@@ -539,10 +489,11 @@ bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t da
 		{
 			auto indexMin = j * incrPerJob;
 			auto indexMax = (j < (numTasks - 1U) ? (j + 1U) * incrPerJob : resHeight) - indexMin;
-			auto myhoriz = new dwt_data<vec4f>(horiz);
+			auto myhoriz = new dwt_data<vec16f>(horiz);
 			if(!myhoriz->alloc(dataLength))
 			{
 				Logger::logger_.error("Out of memory");
+				delete myhoriz;
 				return false;
 			}
 			resFlow->waveletHoriz_->nextTask().work([this, myhoriz, indexMax, winL, winH, winDest] {
@@ -556,10 +507,20 @@ bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t da
 	}
 	return true;
 }
-void WaveletReverse::interleave_v_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
+void WaveletReverse::interleave_v_97(dwt_data<vec16f>* GRK_RESTRICT dwt,
 									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 									 uint32_t nb_elts_read)
 {
+	if(nb_elts_read == vec16f::NUM_ELTS)
+	{
+		HWY_DYNAMIC_DISPATCH(hwy_interleave_v_97)
+		((float*)(dwt->mem + dwt->parity), winL.buf_, winL.stride_, dwt->win_l.x0,
+		 dwt->win_l.x1);
+		HWY_DYNAMIC_DISPATCH(hwy_interleave_v_97)
+		((float*)(dwt->mem + 1 - dwt->parity), winH.buf_, winH.stride_, dwt->win_h.x0,
+		 dwt->win_h.x1);
+		return;
+	}
 	auto bi = dwt->mem + dwt->parity;
 	auto band = winL.buf_ + dwt->win_l.x0 * winL.stride_;
 	for(uint32_t i = dwt->win_l.x0; i < dwt->win_l.x1; ++i, bi += 2)
@@ -575,31 +536,31 @@ void WaveletReverse::interleave_v_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
 		band += winH.stride_;
 	}
 }
-void WaveletReverse::decompress_v_strip_97(dwt_data<vec4f>* GRK_RESTRICT vert,
+void WaveletReverse::decompress_v_strip_97(dwt_data<vec16f>* GRK_RESTRICT vert,
 										   const uint32_t resWidth, const uint32_t resHeight,
 										   grk_buf2d_simple<float> winL,
 										   grk_buf2d_simple<float> winH,
 										   grk_buf2d_simple<float> winDest)
 {
 	uint32_t j;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
-	for(j = 0; j < (resWidth & (uint32_t) ~(vec4f_elts - 1)); j += vec4f_elts)
+	const uint32_t numElts = vec16f::NUM_ELTS;
+	for(j = 0; j < (resWidth & ~(numElts - 1)); j += numElts)
 	{
-		interleave_v_97(vert, winL, winH, vec4f_elts);
+		interleave_v_97(vert, winL, winH, numElts);
 		decompress_step_97(vert);
 		auto destPtr = winDest.buf_;
 		for(uint32_t k = 0; k < resHeight; ++k)
 		{
-			memcpy(destPtr, vert->mem + k, sizeof(vec4f));
+			memcpy(destPtr, vert->mem + k, sizeof(vec16f));
 			destPtr += winDest.stride_;
 		}
-		winL.buf_ += vec4f_elts;
-		winH.buf_ += vec4f_elts;
-		winDest.buf_ += vec4f_elts;
+		winL.buf_ += numElts;
+		winH.buf_ += numElts;
+		winDest.buf_ += numElts;
 	}
 	if(j < resWidth)
 	{
-		j = resWidth & (vec4f_elts - 1);
+		j = resWidth & (numElts - 1);
 		interleave_v_97(vert, winL, winH, j);
 		decompress_step_97(vert);
 		auto destPtr = winDest.buf_;
@@ -611,7 +572,7 @@ void WaveletReverse::decompress_v_strip_97(dwt_data<vec4f>* GRK_RESTRICT vert,
 	}
 }
 bool WaveletReverse::decompress_v_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-									 dwt_data<vec4f>& GRK_RESTRICT vert, const uint32_t resWidth,
+									 dwt_data<vec16f>& GRK_RESTRICT vert, const uint32_t resWidth,
 									 const uint32_t resHeight, grk_buf2d_simple<float> winL,
 									 grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest)
 {
@@ -623,10 +584,12 @@ bool WaveletReverse::decompress_v_97(uint8_t res, uint32_t numThreads, size_t da
 	}
 	else
 	{
-		auto numTasks = numThreads;
-		if(resWidth < numTasks)
-			numTasks = resWidth;
-		auto incrPerJob = resWidth / numTasks;
+		// column strips are a multiple of the element width, so only the final
+		// strip leaves lanes unused
+		const uint32_t numElts = vec16f::NUM_ELTS;
+		uint32_t incrPerJob =
+			ceildiv<uint32_t>(ceildiv<uint32_t>(resWidth, numThreads), numElts) * numElts;
+		uint32_t numTasks = ceildiv<uint32_t>(resWidth, incrPerJob);
 		auto imageComponentFlow = scheduler_->getImageComponentFlow(compno_);
 		if(!imageComponentFlow)
 		{
@@ -638,7 +601,7 @@ bool WaveletReverse::decompress_v_97(uint8_t res, uint32_t numThreads, size_t da
 		{
 			auto indexMin = j * incrPerJob;
 			auto indexMax = (j < (numTasks - 1U) ? (j + 1U) * incrPerJob : resWidth) - indexMin;
-			auto myvert = new dwt_data<vec4f>(vert);
+			auto myvert = new dwt_data<vec16f>(vert);
 			if(!myvert->alloc(dataLength))
 			{
 				Logger::logger_.error("Out of memory");
@@ -1328,11 +1291,11 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 #define S_(buf, i) \
 	((i) < -win_l_x0 ? get_S(buf, -win_l_x0) : ((i) >= sn ? get_S(buf, sn - 1) : get_S(buf, i)))
 #define D_(buf, i) \
-	((i) < -win_h_x0 ? get_D(buf, -win_h_x0) : ((i) >= dn ? get_D(buf, dn - 1) : get_D(buf, i)))
+	((i) < -win_l_x0 ? get_D(buf, -win_l_x0) : ((i) >= dn ? get_D(buf, dn - 1) : get_D(buf, i)))
 
 // parity == 1
 #define SS_(buf, i) \
-	((i) < -win_h_x0 ? get_S(buf, -win_h_x0) : ((i) >= dn ? get_S(buf, dn - 1) : get_S(buf, i)))
+	((i) < -win_l_x0 ? get_S(buf, -win_l_x0) : ((i) >= dn ? get_S(buf, dn - 1) : get_S(buf, i)))
 #define DD_(buf, i) \
 	((i) < -win_l_x0 ? get_D(buf, -win_l_x0) : ((i) >= sn ? get_D(buf, sn - 1) : get_D(buf, i)))
 
@@ -1346,11 +1309,10 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 		int64_t sn = (int64_t)dwt->sn_full - (int64_t)dwt->win_l.x0;
 		int64_t sn_full = dwt->sn_full;
 		assert(dwt->win_h.x0 <= dwt->dn_full);
-		int64_t dn = (int64_t)dwt->dn_full - (int64_t)dwt->win_h.x0;
+		// low and high pass samples are both indexed relative to win_l.x0
+		int64_t dn = (int64_t)dwt->dn_full - (int64_t)dwt->win_l.x0;
 		int64_t dn_full = dwt->dn_full;
 
-		adjust_bounds(dwt, sn_full, dn_full, &sn, &dn);
-
 		assert(dwt->win_l.x1 <= sn_full && dwt->win_h.x1 <= dn_full);
 
 		auto buf = dwt->mem;
@@ -1385,8 +1347,8 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 						/* Right-most case */
 						S(buf, i) -= (D_(buf, i - 1) + D_(buf, i) + 2) >> 2;
 				}
-				i = 0;
-				i_max = win_h_x1 - win_h_x0;
+				i = win_h_x0 - win_l_x0;
+				i_max = win_h_x1 - win_l_x0;
 				if(i < i_max)
 				{
 					if(i_max >= sn)
@@ -1394,7 +1356,7 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 					for(; i < i_max; i++)
 						/* No bound checking */
 						D(buf, i) += (S(buf, i) + S(buf, i + 1)) >> 1;
-					for(; i < win_h_x1 - win_h_x0; i++)
+					for(; i < win_h_x1 - win_l_x0; i++)
 						/* Right-most case */
 						D(buf, i) += (S_(buf, i) + S_(buf, i + 1)) >> 1;
 				}
@@ -1411,7 +1373,7 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 			{
 				for(i = 0; i < win_l_x1 - win_l_x0; i++)
 					D(buf, i) -= (SS_(buf, i) + SS_(buf, i + 1) + 2) >> 2;
-				for(i = 0; i < win_h_x1 - win_h_x0; i++)
+				for(i = win_h_x0 - win_l_x0; i < win_h_x1 - win_l_x0; i++)
 					S(buf, i) += (DD_(buf, i) + DD_(buf, i - 1)) >> 1;
 			}
 		}
@@ -1433,11 +1395,11 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 #define S_sgnd_off_(buf, i, off) \
 	(((i) < (-win_l_x0) ? get_S_off(buf, -win_l_x0, off) : S_off_(buf, i, off)))
 #define D_sgnd_off_(buf, i, off) \
-	(((i) < (-win_h_x0) ? get_D_off(buf, -win_h_x0, off) : D_off_(buf, i, off)))
+	(((i) < (-win_l_x0) ? get_D_off(buf, -win_l_x0, off) : D_off_(buf, i, off)))
 
 // case == 1
 #define SS_sgnd_off_(buf, i, off)                       \
-	((i) < (-win_h_x0) ? get_S_off(buf, -win_h_x0, off) \
+	((i) < (-win_l_x0) ? get_S_off(buf, -win_l_x0, off) \
 					   : ((i) >= dn ? get_S_off(buf, dn - 1, off) : get_S_off(buf, i, off)))
 #define DD_sgnd_off_(buf, i, off)                       \
 	((i) < (-win_l_x0) ? get_D_off(buf, -win_l_x0, off) \
@@ -1454,11 +1416,10 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 		int64_t win_h_x1 = dwt->win_h.x1;
 		int64_t sn = (int64_t)dwt->sn_full - (int64_t)dwt->win_l.x0;
 		int64_t sn_full = dwt->sn_full;
-		int64_t dn = (int64_t)dwt->dn_full - (int64_t)dwt->win_h.x0;
+		// low and high pass samples are both indexed relative to win_l.x0
+		int64_t dn = (int64_t)dwt->dn_full - (int64_t)dwt->win_l.x0;
 		int64_t dn_full = dwt->dn_full;
 
-		adjust_bounds(dwt, sn_full, dn_full, &sn, &dn);
-
 		assert(dwt->win_l.x1 <= sn_full && dwt->win_h.x1 <= dn_full);
 
 		auto buf = dwt->mem;
@@ -1533,9 +1494,9 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 				}
 
 				// 2. high pass
-				i = 0;
+				i = win_h_x0 - win_l_x0;
 				assert(win_h_x1 >= win_h_x0);
-				i_max = win_h_x1 - win_h_x0;
+				i_max = win_h_x1 - win_l_x0;
 				if(i < i_max)
 				{
 					if(i_max >= sn)
@@ -1571,7 +1532,7 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 							D_off(buf, i, off) +=
 								(S_off(buf, i, off) + S_off(buf, i + 1, off)) >> 1;
 					}
-					for(; i < win_h_x1 - win_h_x0; i++)
+					for(; i < win_h_x1 - win_l_x0; i++)
 					{
 						/* Right-most case */
 						for(uint32_t off = 0; off < VERT_PASS_WIDTH; off++)
@@ -1603,7 +1564,7 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 				assert((uint64_t)(dwt->memH + (win_h_x1 - win_h_x0) * VERT_PASS_WIDTH) -
 						   (uint64_t)dwt->allocatedMem <
 					   dwt->lenBytes_);
-				for(i = 0; i < win_h_x1 - win_h_x0; i++)
+				for(i = win_h_x0 - win_l_x0; i < win_h_x1 - win_l_x0; i++)
 				{
 					for(uint32_t off = 0; off < VERT_PASS_WIDTH; off++)
 						S_off(buf, i, off) +=
@@ -1614,20 +1575,6 @@ class Partial53 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 	}
 
   private:
-	void adjust_bounds(dwt_data<T>* dwt, [[maybe_unused]] int64_t sn_full,
-					   [[maybe_unused]] int64_t dn_full, int64_t* sn, int64_t* dn)
-	{
-		if((uint64_t)dwt->memH < (uint64_t)dwt->memL && *sn == *dn)
-		{
-			assert(dn_full == sn_full - 1);
-			(*dn)--;
-		}
-		if((uint64_t)dwt->memL < (uint64_t)dwt->memH && *sn == *dn)
-		{
-			assert(sn_full == dn_full - 1);
-			(*sn)--;
-		}
-	}
 #ifdef GRK_DEBUG_SPARSE
 	inline T get_S(T* const buf, int64_t i)
 	{
@@ -1671,7 +1618,8 @@ class Partial97 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
 // Notes:
 // 1. line buffer 0 offset == dwt->win_l.x0
 // 2. dwt->memL and dwt->memH are only set for partial decode
-Params97 WaveletReverse::makeParams97(dwt_data<vec4f>* dwt, bool isBandL, bool step1)
+template<typename T>
+Params97 WaveletReverse::makeParams97(dwt_data<T>* dwt, bool isBandL, bool step1)
 {
 	Params97 rc;
 	// band_0 specifies absolute start of line buffer
@@ -1686,19 +1634,20 @@ Params97 WaveletReverse::makeParams97(dwt_data<vec4f>* dwt, bool isBandL, bool s
 		lenMax = 0;
 	assert(lenMax >= band_0);
 	lenMax -= band_0;
-	rc.data = memPartial ? memPartial : dwt->mem;
+	auto data = memPartial ? memPartial : dwt->mem;
 
 	assert(!memPartial || (dwt->win_l.x1 <= dwt->sn_full && dwt->win_h.x1 <= dwt->dn_full));
 	assert(band_1 >= band_0);
 
-	rc.data += parityOffset + band_0 - dwt->win_l.x0;
+	data += parityOffset + band_0 - dwt->win_l.x0;
 	rc.len = (uint32_t)(band_1 - band_0);
 	if(!step1)
 	{
-		rc.data += 1;
-		rc.dataPrev = parityOffset ? rc.data - 2 : rc.data;
+		data += 1;
+		rc.dataPrev = (float*)(parityOffset ? data - 2 : data);
 		rc.lenMax = (uint32_t)lenMax;
 	}
+	rc.data = (float*)data;
 	if(memPartial)
 	{
 		assert((uint64_t)rc.data >= (uint64_t)dwt->allocatedMem);
@@ -27,6 +27,8 @@ namespace grk
 {
 
 typedef vec<float, 4> vec4f;
+// lifting element for whole tile 9/7 transform : wide enough for a single AVX-512 vector
+typedef vec<float, 16> vec16f;
 
 template<typename T, typename S>
 struct TaskInfo
@@ -130,8 +132,8 @@ struct dwt_data
 struct Params97
 {
 	Params97(void) : dataPrev(nullptr), data(nullptr), len(0), lenMax(0) {}
-	vec4f* dataPrev;
-	vec4f* data;
+	float* dataPrev;
+	float* data;
 	uint32_t len;
 	uint32_t lenMax;
 };
@@ -144,32 +146,30 @@ class WaveletReverse
 	~WaveletReverse(void);
 	bool decompress(void);
 
-	static void decompress_step_97(dwt_data<vec4f>* GRK_RESTRICT dwt);
+	template<typename T>
+	static void decompress_step_97(dwt_data<T>* GRK_RESTRICT dwt);
 
   private:
 	template<typename T, uint32_t FILTER_WIDTH, uint32_t VERT_PASS_WIDTH, typename D>
 	bool decompress_partial_tile(ISparseCanvas* sa, std::vector<TaskInfo<T, dwt_data<T>>*>& tasks);
-	static void decompress_step1_97(const Params97& d, const float c);
-#ifdef __SSE__
-	static void decompress_step1_sse_97(Params97 d, const __m128 c);
-#endif
-	static Params97 makeParams97(dwt_data<vec4f>* dwt, bool isBandL, bool step1);
-	void interleave_h_97(dwt_data<vec4f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
+	template<typename T>
+	static Params97 makeParams97(dwt_data<T>* dwt, bool isBandL, bool step1);
+	void interleave_h_97(dwt_data<vec16f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, uint32_t remaining_height);
-	void decompress_h_strip_97(dwt_data<vec4f>* GRK_RESTRICT horiz, const uint32_t resHeight,
+	void decompress_h_strip_97(dwt_data<vec16f>* GRK_RESTRICT horiz, const uint32_t resHeight,
 							   grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 							   grk_buf2d_simple<float> winDest);
 	bool decompress_h_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-						 dwt_data<vec4f>& GRK_RESTRICT horiz, const uint32_t resHeight,
+						 dwt_data<vec16f>& GRK_RESTRICT horiz, const uint32_t resHeight,
 						 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 						 grk_buf2d_simple<float> winDest);
-	void interleave_v_97(dwt_data<vec4f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
+	void interleave_v_97(dwt_data<vec16f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, uint32_t nb_elts_read);
-	void decompress_v_strip_97(dwt_data<vec4f>* GRK_RESTRICT vert, const uint32_t resWidth,
+	void decompress_v_strip_97(dwt_data<vec16f>* GRK_RESTRICT vert, const uint32_t resWidth,
 							   const uint32_t resHeight, grk_buf2d_simple<float> winL,
 							   grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest);
 	bool decompress_v_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-						 dwt_data<vec4f>& GRK_RESTRICT vert, const uint32_t resWidth,
+						 dwt_data<vec16f>& GRK_RESTRICT vert, const uint32_t resWidth,
 						 const uint32_t resHeight, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest);
 	bool decompress_tile_97(void);
@@ -215,8 +215,8 @@ class WaveletReverse
 	dwt_data<int32_t> horiz_;
 	dwt_data<int32_t> vert_;
 
-	dwt_data<vec4f> horizF_;
-	dwt_data<vec4f> vertF_;
+	dwt_data<vec16f> horizF_;
+	dwt_data<vec16f> vertF_;
 
 	std::vector<TaskInfo<vec4f, dwt_data<vec4f>>*> tasksF_;
 	std::vector<TaskInfo<int32_t, dwt_data<int32_t>>*> tasks_;